@@ -295,6 +295,12 @@ def differentiate(output, inputs=None, head=None, ad_attrs=None, new_pld_array=N
             - adjoint_summands (dict{tvm.tensor.Tensor: dict{tvm.tensor.Tensor: tvm.tensor.Tensor}}):
               Single summands of the adjoints.
 
+            - attrs (dict{str: object}):
+              When `ad_attrs` sets `remat_memory_budget` (bytes), the rematerialization plan: the names of the
+              kept (`remat_kept`) and recomputed (`remat_recomputed`) intermediates, the bytes kept
+              (`remat_kept_bytes`) against the bytes when keeping all of them (`remat_keep_all_bytes`), and the
+              estimated cost of the recomputation (`remat_recompute_cost`).
+
     Raises:
         ValueError: If the shape of `head` is invalid.
 
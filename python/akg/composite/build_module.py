@@ -901,6 +901,40 @@ def build(kernel_desc, attrs=None, poly=True, use_repo=True):
         desc_d = kernel_desc
     return _build(desc_s, desc_d, attrs, poly, use_repo)
 
+def build_candidates(kernel_desc, candidates, attrs=None):
+    """
+    build tuning candidates of a cuda kernel, the lowering before the polyhedral pass is shared by all of them
+    Args:
+       kernel_desc : str or dict of compute description
+       candidates  : list of dict, the tiling and mapping attrs of each candidate, e.g. dim, bind_block, bind_thread
+       attrs       : dict of build attributes shared by all candidates
+
+    Returns:
+       list of Module.
+    """
+    if isinstance(kernel_desc, str):
+        desc_s = kernel_desc
+        desc_d = json.loads(kernel_desc)
+    else:
+        assert isinstance(kernel_desc, dict)
+        desc_s = json.dumps(kernel_desc)
+        desc_d = kernel_desc
+    if desc_d['process'] != 'cuda' or 'parallel_fusion' in desc_d or 'buffer_stitch' in desc_d:
+        raise ValueError("Only single cuda kernels can share the lowering among candidates")
+    attrs = dict() if attrs is None else dict(attrs)
+    if "enable_atomic_add" not in attrs.keys():
+        attrs["enable_atomic_add"] = should_enable_atomic_add(desc_d)
+    attrs = _update_attrs_gpu(desc_d, attrs, True)
+    dump_ir = os.getenv(get_dump_ir_flag()) == "on"
+    with tvm.build_config(dump_pass_ir=dump_ir):
+        prefix = tvm.get_global_func("composite_lower_prefix")(desc_s, attrs)
+        cfg = _api_internal._GetCurrentBuildConfig()
+        mods = []
+        for candidate in candidates:
+            rst = _api_internal._BuildFromPrefix(prefix, candidate, cfg)
+            mods.append(_api_internal._BuildToModule(rst, "cuda"))
+    return mods
+
 def get_tiling_space(kernel_desc, level=1, attr=None):
     """
     get tiling space of composite kernel
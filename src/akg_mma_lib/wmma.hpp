@@ -672,6 +672,133 @@ __device__ inline void fragment_div(__frag_base<T, size> &c, const __frag_base<T
   }
 }
 
+template <class T, int size>
+__device__ inline void fragment_max(__frag_base<T, size> &c, const __frag_base<T, size> &a, const __frag_base<T, size> &b) {
+  #pragma unroll
+  for (unsigned i = 0; i < c.num_elements; i++) {
+    c.x[i] = a.x[i] > b.x[i] ? a.x[i] : b.x[i];
+  }
+}
+
+template <class T, int size>
+__device__ inline void fragment_min(__frag_base<T, size> &c, const __frag_base<T, size> &a, const __frag_base<T, size> &b) {
+  #pragma unroll
+  for (unsigned i = 0; i < c.num_elements; i++) {
+    c.x[i] = a.x[i] < b.x[i] ? a.x[i] : b.x[i];
+  }
+}
+
+template <class T, int size>
+__device__ inline void fragment_max(__frag_base<T, size> &c, const __frag_base<T, size> &a, const T b) {
+  #pragma unroll
+  for (unsigned i = 0; i < c.num_elements; i++) {
+    c.x[i] = a.x[i] > b ? a.x[i] : b;
+  }
+}
+
+template <class T, int size>
+__device__ inline void fragment_min(__frag_base<T, size> &c, const __frag_base<T, size> &a, const T b) {
+  #pragma unroll
+  for (unsigned i = 0; i < c.num_elements; i++) {
+    c.x[i] = a.x[i] < b ? a.x[i] : b;
+  }
+}
+
+/*
+ * Element index mapping of the accumulator fragments
+ * get_element_coord gives the (row, col) inside the tile of the element f.x[i] held by the calling lane,
+ * the same placement store_matrix_sync writes it to.
+ */
+template <int k>
+__device__ inline void get_element_coord(const fragment<nvcuda::wmma::accumulator, 16, 16, k, half, void> &f,
+                                         const unsigned i, unsigned &row, unsigned &col) {
+  const unsigned lane_id = get_lane_id();
+  row = (lane_id & 0x7) + ((lane_id >> 4) << 3);
+  col = (((lane_id & 0xf) >> 3) << 2) + (i & 0x3) + ((i & 0x4) << 1);
+}
+
+template <int k>
+__device__ inline void get_element_coord(const fragment<nvcuda::wmma::accumulator, 16, 16, k, float, void> &f,
+                                         const unsigned i, unsigned &row, unsigned &col) {
+  const unsigned lane_id = get_lane_id();
+  row = (lane_id & 0x5) + ((lane_id >> 4) << 3) + (i & 0x2);
+  col = (lane_id & 0x2) + ((lane_id & 0x8) >> 1) + (i & 0x1) + ((i & 0x4) << 1);
+}
+
+__device__ inline void get_element_coord(const fragment<nvcuda::wmma::accumulator, 32, 32, 4, float, void> &f,
+                                         const unsigned i, unsigned &row, unsigned &col) {
+  const unsigned lane_id = get_lane_id();
+  row = (lane_id & 0x1) + (lane_id & 0x18) + (i & 0x2) + ((i & 0x10) >> 2);
+  col = (lane_id & 0x2) + ((lane_id & 0x4) << 1) + (i & 0x1) + ((i & 0x4) << 2) + ((i & 0x8) >> 1);
+}
+
+/*
+ * Epilogues with a vector broadcast over the accumulator tile, applied in registers before the store.
+ * v points to the vector element of the first row (col_vector) or the first column (row_vector) of the tile:
+ *   row_vector: c[row][col] = OP(a[row][col], v[col]), e.g. the bias add of a dense layer
+ *   col_vector: c[row][col] = OP(a[row][col], v[row])
+ */
+#define FRAGMENT_VECTOR_OP(NAME, OP)                                                                         \
+  template <int m, int n, int k, class T, class S>                                                           \
+  __device__ inline void fragment_##NAME##_row_vector(fragment<nvcuda::wmma::accumulator, m, n, k, T> &c,    \
+                                                      const fragment<nvcuda::wmma::accumulator, m, n, k, T> &a, \
+                                                      const S *const v) {                                    \
+    _Pragma("unroll") for (unsigned i = 0; i < c.num_elements; i++) {                                        \
+      unsigned row, col;                                                                                     \
+      get_element_coord(a, i, row, col);                                                                     \
+      c.x[i] = OP(a.x[i], cast<T>(v[col]));                                                                  \
+    }                                                                                                        \
+  }                                                                                                          \
+  template <int m, int n, int k, class T, class S>                                                           \
+  __device__ inline void fragment_##NAME##_col_vector(fragment<nvcuda::wmma::accumulator, m, n, k, T> &c,    \
+                                                      const fragment<nvcuda::wmma::accumulator, m, n, k, T> &a, \
+                                                      const S *const v) {                                    \
+    _Pragma("unroll") for (unsigned i = 0; i < c.num_elements; i++) {                                        \
+      unsigned row, col;                                                                                     \
+      get_element_coord(a, i, row, col);                                                                     \
+      c.x[i] = OP(a.x[i], cast<T>(v[row]));                                                                  \
+    }                                                                                                        \
+  }
+
+#define FRAGMENT_ADD(A, B) ((A) + (B))
+#define FRAGMENT_SUB(A, B) ((A) - (B))
+#define FRAGMENT_MUL(A, B) ((A) * (B))
+#define FRAGMENT_DIV(A, B) ((A) / (B))
+#define FRAGMENT_MAX(A, B) ((A) > (B) ? (A) : (B))
+#define FRAGMENT_MIN(A, B) ((A) < (B) ? (A) : (B))
+
+FRAGMENT_VECTOR_OP(add, FRAGMENT_ADD);
+FRAGMENT_VECTOR_OP(sub, FRAGMENT_SUB);
+FRAGMENT_VECTOR_OP(mul, FRAGMENT_MUL);
+FRAGMENT_VECTOR_OP(div, FRAGMENT_DIV);
+FRAGMENT_VECTOR_OP(max, FRAGMENT_MAX);
+FRAGMENT_VECTOR_OP(min, FRAGMENT_MIN);
+
+#undef FRAGMENT_ADD
+#undef FRAGMENT_SUB
+#undef FRAGMENT_MUL
+#undef FRAGMENT_DIV
+#undef FRAGMENT_MAX
+#undef FRAGMENT_MIN
+
+/*
+ * Unary epilogues, e.g. the tanh of GELU, computed in fp32 whatever the accumulator type
+ */
+#define FRAGMENT_UNARY_OP(NAME, FUNC)                                                               \
+  template <class T, int size>                                                                      \
+  __device__ inline void fragment_##NAME(__frag_base<T, size> &c, const __frag_base<T, size> &a) { \
+    _Pragma("unroll") for (unsigned i = 0; i < c.num_elements; i++) {                               \
+      c.x[i] = cast<T>(FUNC(cast<float>(a.x[i])));                                                  \
+    }                                                                                               \
+  }
+
+FRAGMENT_UNARY_OP(tanh, tanhf);
+FRAGMENT_UNARY_OP(exp, expf);
+FRAGMENT_UNARY_OP(log, logf);
+FRAGMENT_UNARY_OP(sqrt, sqrtf);
+FRAGMENT_UNARY_OP(rsqrt, rsqrtf);
+FRAGMENT_UNARY_OP(fabs, fabsf);
+
 }  // namespace wmma
 }  // namespace akg
 
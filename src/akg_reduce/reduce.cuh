@@ -92,6 +92,56 @@ __device__ __forceinline__ void AkgAtomicReturn(const T shared_result, // Reduct
   atomic_op.Compute(&output[0], shared_result);
 }
 
+/**
+ * @brief Load through a volatile pointer, so that the value is read from L2 instead of a stale L1 line.
+ *        Types without volatile copy, such as half, are read byte by byte.
+ */
+template <typename T>
+__device__ __forceinline__ T AkgVolatileLoad(const T *addr) {
+  T value;
+  const volatile unsigned char *src = reinterpret_cast<const volatile unsigned char *>(addr);
+  unsigned char *dst = reinterpret_cast<unsigned char *>(&value);
+  for (int i = 0; i < static_cast<int>(sizeof(T)); ++i) {
+    dst[i] = src[i];
+  }
+  return value;
+}
+
+/**
+ * @brief Deterministic return function, from shared memory to global memory.
+ *        Every block stores its partial result in a workspace slot, and the last block to arrive
+ *        folds the slots in block order, so the output does not depend on the finishing order.
+ *        The output is overwritten, so it needs no clean before the launch. The workspace and the
+ *        arrival counters are shared by the launches of the kernel, which must not overlap.
+ * @tparam T                  Dtype: half, float, double, int, signed char, bool;
+ * @tparam ReduceOp           Operators for reduce: SumOp, MaxOp, MinOp, AndOp, OrOp;
+ */
+template <typename T, typename ReduceOp>
+__device__ __forceinline__ void AkgDeterministicReturn(const T shared_result,  // Reduction result on the shared memory
+                                                       T *output,              // Global output address
+                                                       const ReduceOp op,      // The operator
+                                                       T *partials,            // Workspace, num_parts slots per output
+                                                       unsigned int *arrived,  // Arrival counters, one per output
+                                                       const int elem_id,      // Index of the output element
+                                                       const int part_id,      // Index of this block among the parts
+                                                       const int num_parts     // Number of blocks of one output
+) {
+  T *slots = partials + elem_id * num_parts;
+  slots[part_id] = shared_result;
+  __threadfence();
+  // the counter wraps back to zero on the last block, ready for the next launch
+  if (atomicInc(&arrived[elem_id], static_cast<unsigned int>(num_parts - 1)) !=
+      static_cast<unsigned int>(num_parts - 1)) {
+    return;
+  }
+  __threadfence();
+  T result = AkgVolatileLoad(&slots[0]);
+  for (int i = 1; i < num_parts; ++i) {
+    result = op(result, AkgVolatileLoad(&slots[i]));
+  }
+  output[0] = result;
+}
+
 }  // namespace akg_reduce
 
 #endif  // AKG_REDUCE_H
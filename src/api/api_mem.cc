@@ -61,5 +61,22 @@ TVM_REGISTER_API("gpu.info.mem.reg").set_body([](const TVMArgs args, TVMRetValue
   *ret = air::GpuMemoryInfo(node);
 });
 
+TVM_REGISTER_API("gpu.info.compute").set_body([](const TVMArgs args, TVMRetValue *ret) {
+  std::string device_type = akg::common::GetStringEnv("AKG_DEVICE_TYPE");
+  device_type = device_type.empty() ? "v100" : device_type;
+  if (device_type != "v100") {
+    // no compute info of this device, the callers fall back to their defaults
+    *ret = air::GpuComputeInfo();
+    return;
+  }
+  auto node = air::make_node<air::GpuComputeInfoNode>();
+  node->num_sm = 80;
+  node->max_blocks_per_sm = 32;
+  node->max_threads_per_sm = 2048;
+  node->max_regs_per_sm = 64 * 1024;
+  node->max_shared_bytes_per_sm = 96 * 1024;
+  *ret = air::GpuComputeInfo(node);
+});
+
 }  // namespace ir
 }  // namespace akg
@@ -102,6 +102,12 @@ REGISTER_PASS(StmtPatternRewrite);
 REGISTER_PASS(SubstituteDivVar);
 REGISTER_PASS(UnrollNonConstantExtent)
 REGISTER_PASS(ValueNumbering);
+REGISTER_PASS(GlobalValueNumbering);
+REGISTER_PASS(StrengthReduceDivMod);
+REGISTER_PASS(PackSharedMemory);
+REGISTER_PASS(SplitKGemm);
+REGISTER_PASS(CountBarriers);
+REGISTER_PASS(PlanGpuUnroll);
 REGISTER_PASS(TensorAccessRewrite);
 REGISTER_PASS(SwizzleGPU);
 REGISTER_PASS(AlignLastAxisLoopExtent);
@@ -31,6 +31,7 @@
 #include "schedule_pass.h"
 #include "codegen/pass_mgr.h"
 #include "composite/util.h"
+#include "pass/rewrite_simplify_cce.h"
 
 namespace akg {
 AttrMap g_attrs;
@@ -453,14 +454,98 @@ void DumpIr(const std::string &name, const BuildConfig &config, bool lower_list)
       CreateDir(dump_poly_dir);
     }
   }
+  common::IrDumpWriter::BeginKernel(config->dump_pass_ir ? PassMgr::GetDir() : "");
 }
 
+namespace {
+// Phase 1-3 of the gpu lowering, after the polyhedral pass
+Stmt LowerGpuPostPoly(Stmt stmt, const Schedule &sch, const Map<Tensor, Buffer> &binds_0, const Target &target_platform,
+                      bool polyhedral, bool simple_mode, const BuildConfig &config) {
+  // Phase 1
+  stmt = NEXT_PASS(ReconstructLayout, stmt);
+  stmt = NEXT_PASS(RemoveFakeOp, stmt);
+  stmt = NEXT_PASS(RewriteForTensorCore, stmt, sch, binds_0);
+  stmt = NEXT_PASS(StorageFlatten, stmt, binds_0, 64, config->instrument_bound_checkers);
+  stmt = NEXT_PASS(CanonicalSimplify, stmt);
+  if (polyhedral && g_attrs.GetInt(kGemmSplitKPlan, 1) > 1) {
+    Stmt split_stmt = NEXT_PASS(SplitKGemm, stmt, binds_0, g_attrs.GetInt(kGemmSplitKPlan, 1));
+    // the transfer buffer does not prefetch the K chunks of a split kernel
+    if (!split_stmt.same_as(stmt)) {
+      g_attrs.Set(kEnableTransferBuffer, air::make_const(Int(32), false));
+    }
+    stmt = split_stmt;
+  }
+
+  // Phase 2
+  if (!simple_mode) {
+    stmt = NEXT_PASS(LoopPartition, stmt, config->partition_const_loop);
+  }
+  if (config->disable_vectorize) {
+    stmt = NEXT_PASS(SkipVectorize, stmt);
+  } else {
+    stmt = NEXT_PASS(VectorizeLoop, stmt);
+  }
+  stmt = NEXT_PASS(InjectVirtualThread, stmt);
+  if (polyhedral) {
+    stmt = NEXT_PASS(InjectTransferBufferScope, stmt);
+  }
+  stmt = NEXT_PASS(InjectDoubleBuffer, stmt, config->double_buffer_split_loop,
+                   g_attrs.GetBool(kEnableDoubleBuffer, false));
+  stmt = NEXT_PASS(StorageRewrite, stmt);
+
+  if (target_platform->device_type == kDLGPU && polyhedral) {
+    if (g_attrs.GetBool(kEnableSwizzleGPU, true)) {
+      stmt = NEXT_PASS(SwizzleGPU, stmt, g_attrs);
+    }
+  }
+
+  if (target_platform->device_type == kDLGPU && polyhedral && g_attrs.GetBool(kEnableUnrollPlan, true)) {
+    stmt = NEXT_PASS(PlanGpuUnroll, stmt, g_attrs.GetInt(kUnrollRegisterCap, 0));
+  }
+  stmt = NEXT_PASS(UnrollLoop, stmt, config->auto_unroll_max_step, config->auto_unroll_max_depth,
+                   config->auto_unroll_max_extent, config->unroll_explicit);
+
+  // Phase 3
+  stmt = NEXT_PASS(Simplify, stmt);
+  stmt = NEXT_PASS(RemoveNoOp, stmt);
+  if (config->instrument_bound_checkers) {
+    stmt = NEXT_PASS(InstrumentBoundCheckers, stmt);
+  }
+  if (!config->disable_select_rewriting) {
+    stmt = NEXT_PASS(RewriteUnsafeSelect, stmt);
+  }
+  if (BuildConfig::Current()->detect_global_barrier) {
+    stmt = NEXT_PASS(ThreadSyncStmt, stmt, "global");
+  }
+  if (!g_attrs.GetBool(kEnablePolySch, false)) {
+    stmt = NEXT_PASS(ThreadSyncStmt, stmt, "shared");
+  }
+  stmt = NEXT_PASS(ThreadSyncStmt, stmt, "warp");
+  stmt = NEXT_PASS(InferFragmentStmt, stmt);
+  stmt = NEXT_PASS(LowerThreadAllreduceStmt, stmt, target_platform->thread_warp_size);
+  if (target_platform->device_type == kDLGPU && g_attrs.GetBool(kEnablePackSharedMemory, true)) {
+    stmt = NEXT_PASS(PackSharedMemory, stmt);
+  }
+  if (target_platform->device_type == kDLGPU && g_attrs.GetBool(kEnableStrengthReduceDivMod, true)) {
+    stmt = NEXT_PASS(StrengthReduceDivMod, stmt);
+  }
+  if (target_platform->device_type == kDLGPU && g_attrs.GetBool(kEnableGlobalValueNumbering, true)) {
+    stmt = NEXT_PASS(GlobalValueNumbering, stmt);
+  }
+  if (target_platform->device_type == kDLGPU && config->dump_pass_ir) {
+    LOG(DEBUG) << "Barriers of " << g_attrs.GetStr(kKernelName, "") << ": " << ir::CountBarriers(stmt);
+  }
+
+  return stmt;
+}
+}  // namespace
+
 NodeRef LowerStmt(Schedule sch, const Array<NodeRef> &in_args, const Array<NodeRef> &shape_vars,
                   const std::string &name, const Map<Tensor, Buffer> &in_binds,
                   const Map<std::string, NodeRef> &in_attrs, bool simple_mode, bool polyhedral, bool tuning,
                   const std::string &target, const BuildConfig &config, Array<NodeRef> *args,
                   Array<NodeRef> *arg_list_0, Map<Tensor, Buffer> *binds, Map<Tensor, Buffer> *binds_0,
-                  std::vector<size_t> *split_index, bool lower_list) {
+                  std::vector<size_t> *split_index, bool lower_list, LoweredPrefix *prefix) {
   CHECK(sch.defined()) << "sch is not defined.";
   CHECK(!name.empty()) << "name is empty.";
   CHECK(find_if(name.begin(), name.end(), [](char c) { return !std::isalnum(c) && c != '_'; }) == name.end())
@@ -486,7 +571,21 @@ NodeRef LowerStmt(Schedule sch, const Array<NodeRef> &in_args, const Array<NodeR
   // Phase 0
   Target target_platform = Target::Create(target);
   if (polyhedral && g_attrs.GetBool(kEnableAutoInline, true)) {
-    akg::schedule::AutoInline(sch, target_platform, g_attrs.GetBool(kEnableCSE, false));
+    std::string inline_report = akg::schedule::AutoInline(sch, target_platform, g_attrs.GetBool(kEnableCSE, false),
+                                                          g_attrs.GetBool(kEnableInlineCostModel, false));
+    if (config->dump_pass_ir && !inline_report.empty()) {
+      constexpr auto kInlineReport = "auto_inline_decisions.txt";
+      if (common::IrDumpWriter::Enabled()) {
+        common::IrDumpWriter::GetInstance().Push(kInlineReport,
+                                                 [inline_report](std::ostream &os) { os << inline_report; });
+      } else {
+        std::string file_name = PassMgr::GetDir() + "/" + kInlineReport;
+        std::ofstream of(file_name);
+        CHECK(of.is_open()) << "Failed to open " << file_name << " to dump inline decisions.";
+        of << inline_report;
+        of.close();
+      }
+    }
   }
   if (target_platform->device_type == kDLGPU && polyhedral && g_attrs.GetBool(kEnableAutoFuse, true)) {
     akg::schedule::AutoFuse(sch, g_attrs.GetStr(kAutoFuseSplit, ""), *split_index);
@@ -522,6 +621,10 @@ NodeRef LowerStmt(Schedule sch, const Array<NodeRef> &in_args, const Array<NodeR
         *binds_0 = air::Downcast<Map<Tensor, Buffer>>(fuse_axis_res[2]);
       }
       PassMgr::SetArgs(*arg_list_0);
+      if (prefix != nullptr) {
+        *prefix = LoweredPrefixNode::make(stmt, new_sch, *arg_list_0, *binds_0, g_attrs, name, target);
+        return stmt;
+      }
 
       int level = g_attrs.GetInt(kHelpTiling, -1);
       if (tuning || level > help_tiling_level["None"]) {
@@ -541,61 +644,7 @@ NodeRef LowerStmt(Schedule sch, const Array<NodeRef> &in_args, const Array<NodeR
     } else {
       g_attrs.Set(kEnablePolySch, air::make_const(Int(32), false));
     }
-    // Phase 1
-    stmt = NEXT_PASS(ReconstructLayout, stmt);
-    stmt = NEXT_PASS(RemoveFakeOp, stmt);
-    stmt = NEXT_PASS(RewriteForTensorCore, stmt, new_sch, *binds_0);
-    stmt = NEXT_PASS(StorageFlatten, stmt, *binds_0, 64, config->instrument_bound_checkers);
-    stmt = NEXT_PASS(CanonicalSimplify, stmt);
-
-    // Phase 2
-    if (!simple_mode) {
-      stmt = NEXT_PASS(LoopPartition, stmt, config->partition_const_loop);
-    }
-    if (config->disable_vectorize) {
-      stmt = NEXT_PASS(SkipVectorize, stmt);
-    } else {
-      stmt = NEXT_PASS(VectorizeLoop, stmt);
-    }
-    stmt = NEXT_PASS(InjectVirtualThread, stmt);
-    if (polyhedral) {
-      stmt = NEXT_PASS(InjectTransferBufferScope, stmt);
-    }
-    stmt = NEXT_PASS(InjectDoubleBuffer, stmt, config->double_buffer_split_loop,
-                     g_attrs.GetBool(kEnableDoubleBuffer, false));
-    stmt = NEXT_PASS(StorageRewrite, stmt);
-
-    if (target_platform->device_type == kDLGPU && polyhedral) {
-      if (g_attrs.GetBool(kEnableSwizzleGPU, true)) {
-        stmt = NEXT_PASS(SwizzleGPU, stmt, g_attrs);
-      }
-    }
-
-    stmt = NEXT_PASS(UnrollLoop, stmt, config->auto_unroll_max_step, config->auto_unroll_max_depth,
-                     config->auto_unroll_max_extent, config->unroll_explicit);
-
-    // Phase 3
-    stmt = NEXT_PASS(Simplify, stmt);
-    stmt = NEXT_PASS(RemoveNoOp, stmt);
-    if (config->instrument_bound_checkers) {
-      stmt = NEXT_PASS(InstrumentBoundCheckers, stmt);
-    }
-    if (!config->disable_select_rewriting) {
-      stmt = NEXT_PASS(RewriteUnsafeSelect, stmt);
-    }
-    if (BuildConfig::Current()->detect_global_barrier) {
-      stmt = NEXT_PASS(ThreadSyncStmt, stmt, "global");
-    }
-    if (!g_attrs.GetBool(kEnablePolySch, false)) {
-      stmt = NEXT_PASS(ThreadSyncStmt, stmt, "shared");
-    }
-    stmt = NEXT_PASS(ThreadSyncStmt, stmt, "warp");
-    stmt = NEXT_PASS(InferFragmentStmt, stmt);
-    stmt = NEXT_PASS(LowerThreadAllreduceStmt, stmt, target_platform->thread_warp_size);
-
-    if (simple_mode) {
-      return stmt;
-    }
+    stmt = LowerGpuPostPoly(stmt, new_sch, *binds_0, target_platform, polyhedral, simple_mode, config);
   }
   return stmt;
 }
@@ -614,6 +663,9 @@ NodeRef Lower(Schedule sch, const Array<NodeRef> &in_args, const Array<NodeRef>
   Map<Tensor, Buffer> binds;
   Map<Tensor, Buffer> binds_0;
   std::vector<size_t> split_index;
+  common::IrDumpKernelScope dump_scope;
+  // share simplification results among all passes that lower this kernel
+  ir::SimplifyCCEScope simplify_scope(config->dump_pass_ir);
   NodeRef tmp = LowerStmt(sch, in_args, shape_vars, name, in_binds, in_attrs, simple_mode, polyhedral, tuning, target,
                           config, &args, &arg_list_0, &binds, &binds_0, &split_index);
 #ifdef USE_AKG_COMPILE_STUB
@@ -735,6 +787,72 @@ BuildRst BuildToFunc(const Schedule &inputs, const Array<NodeRef> &in_args, cons
   return BuildRstNode::make(rst, name);
 }
 
+LoweredPrefix LoweredPrefixNode::make(const Stmt &stmt, const Schedule &sch, const Array<NodeRef> &arg_list_0,
+                                      const Map<Tensor, Buffer> &binds_0, const Map<std::string, NodeRef> &attrs,
+                                      const std::string &name, const std::string &target) {
+  NodePtr<LoweredPrefixNode> node = make_node<LoweredPrefixNode>();
+
+  node->stmt = stmt;
+  node->sch = sch;
+  node->arg_list_0 = arg_list_0;
+  node->binds_0 = binds_0;
+  node->attrs = attrs;
+  node->name = name;
+  node->target = target;
+  node->schedule_cache = std::make_shared<ir::poly::ComputedScheduleCache>();
+
+  return LoweredPrefix(node);
+}
+
+TVM_REGISTER_NODE_TYPE(LoweredPrefixNode);
+
+LoweredPrefix LowerToPrefix(const Schedule &sch, const Array<NodeRef> &in_args, const Array<NodeRef> &shape_vars,
+                            const std::string &name, const Map<Tensor, Buffer> &in_binds,
+                            const Map<std::string, NodeRef> &in_attrs, const std::string &target,
+                            const BuildConfig &config) {
+  Array<NodeRef> args;
+  Array<NodeRef> arg_list_0;
+  Map<Tensor, Buffer> binds;
+  Map<Tensor, Buffer> binds_0;
+  std::vector<size_t> split_index;
+  LoweredPrefix prefix;
+  common::IrDumpKernelScope dump_scope;
+  ir::SimplifyCCEScope simplify_scope(config->dump_pass_ir);
+  static_cast<void>(LowerStmt(sch, in_args, shape_vars, name, in_binds, in_attrs, false, true, false, target, config,
+                              &args, &arg_list_0, &binds, &binds_0, &split_index, false, &prefix));
+  CHECK(prefix.defined()) << "Only the polyhedral lowering for gpu can be shared among candidates, target: " << target;
+  return prefix;
+}
+
+BuildRst BuildFromPrefix(const LoweredPrefix &prefix, const Map<std::string, NodeRef> &candidate_attrs,
+                         const BuildConfig &config) {
+  CHECK(prefix.defined()) << "prefix is not defined.";
+  // the prefix is never modified, so any number of candidates can be built from it
+  g_attrs = prefix->attrs;
+  if (candidate_attrs.defined()) {
+    for (const auto &kv : candidate_attrs) {
+      g_attrs.Set(kv.first, kv.second);
+    }
+  }
+  PassMgr::ClearPassId();
+  common::IrDumpKernelScope dump_scope;
+  DumpIr(prefix->name + "_0", config, false);
+  PassMgr::SetArgs(prefix->arg_list_0);
+
+  ir::SimplifyCCEScope simplify_scope(config->dump_pass_ir);
+  // the candidates of a prefix reuse the schedules of identical constraints
+  ir::poly::ComputedScheduleCacheScope schedule_cache_scope(prefix->schedule_cache.get());
+  Target target_platform = Target::Create(prefix->target);
+  Array<NodeRef> poly_res =
+    NEXT_PASS(AutoPoly, prefix->stmt, prefix->binds_0, prefix->target, g_attrs, false, false, prefix->sch);
+  CHECK_EQ(poly_res.size(), 2);
+  Stmt stmt = air::Downcast<Stmt>(poly_res[0]);
+  g_attrs.Set(kEnablePolySch, air::make_const(Int(32), true));
+  stmt = LowerGpuPostPoly(stmt, prefix->sch, prefix->binds_0, target_platform, true, false, config);
+  NodeRef lowered_func = LowerFunc(stmt, prefix->name, config, prefix->arg_list_0);
+  return BuildRstNode::make(lowered_func, prefix->name);
+}
+
 namespace {
 void CreateCode(const std::string &code, const std::string &kernel_name, const std::string &target_name) {
   std::string file_path;
@@ -845,6 +963,9 @@ TVM_REGISTER_API("_BuildToModule").set_body([](const TVMArgs &args, TVMRetValue
   }
 });
 
+TVM_REGISTER_API("_LowerToPrefix").set_body_typed(LowerToPrefix);
+TVM_REGISTER_API("_BuildFromPrefix").set_body_typed(BuildFromPrefix);
+
 TVM_REGISTER_API("_Lower").set_body([](const TVMArgs &args, TVMRetValue *ret) {
   if (args.size() == 11) {
     NodeRef lowered_func =
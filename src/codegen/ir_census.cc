@@ -0,0 +1,72 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "codegen/ir_census.h"
+
+#include <tvm/ir_visitor.h>
+
+namespace akg {
+using air::NodeRef;
+using air::ir::AttrStmt;
+using air::ir::Call;
+using air::ir::IRVisitor;
+using air::ir::StringImm;
+
+class IRCensusCollector : public IRVisitor {
+ public:
+  explicit IRCensusCollector(IRCensus &census) : census_(census) {}
+
+  void Visit(const NodeRef &node) final {
+    if (node.defined()) {
+      ++census_.node_kinds_[node->type_index()];
+    }
+    IRVisitor::Visit(node);
+  }
+
+  void Visit_(const AttrStmt *op) final {
+    census_.attr_keys_.insert(op->attr_key);
+    if (op->attr_key == air::ir::attr::storage_scope || op->attr_key == air::ir::attr::realize_scope) {
+      if (auto scope = op->value.as<StringImm>()) {
+        census_.storage_scopes_.insert(scope->value);
+      }
+    }
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const Call *op) final {
+    census_.call_names_.insert(op->name);
+    IRVisitor::Visit_(op);
+  }
+
+ private:
+  IRCensus &census_;
+};
+
+IRCensus IRCensus::Collect(const Stmt &stmt) {
+  IRCensus census;
+  IRCensusCollector(census).Visit(stmt);
+  return census;
+}
+
+bool IRCensus::HasStorageScope(const std::string &prefix) const {
+  for (const auto &scope : storage_scopes_) {
+    if (scope.compare(0, prefix.size(), prefix) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace akg
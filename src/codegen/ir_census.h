@@ -0,0 +1,59 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CODEGEN_IR_CENSUS_H_
+#define CODEGEN_IR_CENSUS_H_
+#include <tvm/ir.h>
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace akg {
+using air::Stmt;
+
+/*!
+ * \brief Summary of a statement collected in one traversal: how many nodes of each kind it has, and which attr keys,
+ *  call names and storage scopes appear in it. PassMgr uses it to skip passes whose trigger features are absent.
+ */
+class IRCensus {
+ public:
+  static IRCensus Collect(const Stmt &stmt);
+
+  size_t Count(uint32_t type_index) const {
+    auto it = node_kinds_.find(type_index);
+    return it == node_kinds_.end() ? 0 : it->second;
+  }
+  template <typename T>
+  size_t Count() const {
+    return Count(T::RuntimeTypeIndex());
+  }
+
+  bool HasAttr(const std::string &attr_key) const { return attr_keys_.count(attr_key) > 0; }
+  bool HasCall(const std::string &name) const { return call_names_.count(name) > 0; }
+  // match by prefix, e.g. "wmma." matches all fragment scopes
+  bool HasStorageScope(const std::string &prefix) const;
+
+ private:
+  friend class IRCensusCollector;
+  std::unordered_map<uint32_t, size_t> node_kinds_;
+  std::unordered_set<std::string> attr_keys_;
+  std::unordered_set<std::string> call_names_;
+  std::unordered_set<std::string> storage_scopes_;
+};
+}  // namespace akg
+
+#endif  // CODEGEN_IR_CENSUS_H_
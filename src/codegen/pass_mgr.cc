@@ -16,12 +16,62 @@
 
 #include "codegen/pass_mgr.h"
 
+#include <unordered_map>
 #include <unordered_set>
 #include <chrono>
 
 #include "common/common_util.h"
 
 namespace akg {
+using PassTrigger = std::function<bool(const IRCensus &census, const TVMArgs &args)>;
+
+/*
+ * Passes listed here leave the statement unchanged unless it has one of their trigger features,
+ * so they are skipped when the census of the input statement shows none of them.
+ */
+static const std::unordered_map<std::string, PassTrigger> &PassTriggers() {
+  using air::ir::attr::pragma_tensor_core;
+  using air::ir::attr::thread_extent;
+  using air::ir::attr::virtual_thread;
+  static const std::unordered_map<std::string, PassTrigger> triggers = {
+    {"RewriteForTensorCore",
+     [](const IRCensus &census, const TVMArgs &) { return census.HasAttr(pragma_tensor_core); }},
+    {"SwizzleGPU",
+     [](const IRCensus &census, const TVMArgs &) {
+       return census.HasAttr(thread_extent) && census.Count<air::ir::For>() > 0;
+     }},
+    {"InjectVirtualThread", [](const IRCensus &census, const TVMArgs &) { return census.HasAttr(virtual_thread); }},
+    {"InferFragmentStmt", [](const IRCensus &census, const TVMArgs &) { return census.HasStorageScope("wmma."); }},
+    {"LowerThreadAllreduceStmt",
+     [](const IRCensus &census, const TVMArgs &) { return census.HasCall(air::ir::intrinsic::tvm_thread_allreduce); }},
+    {"ThreadSyncStmt",
+     [](const IRCensus &census, const TVMArgs &args) {
+       // global barriers depend on accesses of global buffers, which every kernel has
+       std::string scope = args[1];
+       return scope == "global" || census.HasStorageScope(scope);
+     }},
+  };
+  return triggers;
+}
+
+bool PassMgr::ShouldSkip() const {
+  auto it = PassTriggers().find(sub_name_);
+  if (it == PassTriggers().end() || args_values_.size() < 2) {
+    return false;
+  }
+  TVMArgs args(args_values_.data(), args_types_.data(), args_values_.size() - 1);
+  if (args[0].type_code() != kObjectHandle || !args[0].IsObjectRef<Stmt>()) {
+    return false;
+  }
+  Stmt stmt = args[0];
+  // passes that return their input keep the census valid, a mutated statement is a new node
+  if (!tl_census_stmt_.same_as(stmt)) {
+    tl_census_ = IRCensus::Collect(stmt);
+    tl_census_stmt_ = stmt;
+  }
+  return !it->second(tl_census_, args);
+}
+
 void PassMgr::InitializeSubName() {
   auto pos = pass_name_.find_last_of('.');
   sub_name_ = pos == std::string::npos ? pass_name_ : pass_name_.substr(pos + 1);
@@ -33,13 +83,26 @@ TVMRetValue PassMgr::Run() const {
 
   TVMRetValue res;
 
+  if (ShouldSkip()) {
+    skipped_ = true;
+    res = TVMArgs(args_values_.data(), args_types_.data(), args_values_.size() - 1)[0];
+    if (enable_timer_) {
+      PassTimer *pass_timer = PassTimer::GetInstance();
+      if (pass_timer != nullptr) {
+        pass_timer->AddSkippedItem(sub_name_);
+      }
+    }
+    tl_pass_id_++;
+    return res;
+  }
+
   auto start_time = std::chrono::steady_clock::now();
   packed_func->CallPacked(TVMArgs(args_values_.data(), args_types_.data(), args_values_.size() - 1), &res);
   CHECK(res.type_code() != kNull) << "PassMgr " << tl_pass_id_ << "_" << sub_name_ << " result illegal.";
 
   if (enable_timer_) {
     auto end_time = std::chrono::steady_clock::now();
-    int64_t elapsed = std::chrono::duration_cast<std::chrono::seconds>(end_time - start_time).count();
+    int64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time).count();
     PassTimer *pass_timer = PassTimer::GetInstance();
     if (pass_timer == nullptr) {
       LOG(INFO) << "Failed to initialize PassTimer.";
@@ -62,6 +125,11 @@ std::string PassMgr::GetDumpIrFilePath() const {
 }
 
 void PassMgr::DumpIr(std::function<void(std::ostream &os)> print) const {
+  if (common::IrDumpWriter::Enabled()) {
+    auto path = GetDumpIrFilePath();
+    common::IrDumpWriter::GetInstance().Push(path.substr(path.find_last_of('/') + 1), std::move(print));
+    return;
+  }
   auto file_name = GetDumpIrFilePath().append(".cc");
   std::ofstream of(file_name);
   CHECK(of.is_open()) << "Failed to open " << file_name << " to dump ir.";
@@ -100,4 +168,6 @@ thread_local int PassMgr::tl_pass_id_ = -1;
 thread_local air::BuildConfig PassMgr::tl_config_ = air::BuildConfig::Current();
 thread_local std::string PassMgr::tl_dump_ir_dir_ = "ir/";
 thread_local air::Array<NodeRef> PassMgr::tl_args_;
+thread_local NodeRef PassMgr::tl_census_stmt_;
+thread_local IRCensus PassMgr::tl_census_;
 }  // namespace akg
@@ -17,6 +17,7 @@
 #ifndef CODEGEN_PASS_MGR_H_
 #define CODEGEN_PASS_MGR_H_
 #include <tvm/ir_pass.h>
+#include <tvm/node/serialization.h>
 #include <tvm/runtime/packed_func.h>
 #include <tvm/runtime/registry.h>
 #include <fstream>
@@ -25,8 +26,11 @@
 #include <memory>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
+#include "codegen/ir_census.h"
+#include "common/ir_dump_writer.h"
 #include "codegen/util.h"
 
 namespace akg {
@@ -54,6 +58,19 @@ inline void DumpRealContent(const Array<LoweredFunc> &func_list, std::ostream &b
   }
 }
 
+// nodes are dumped in the json form of SaveJSON, other results as text
+template <typename T>
+typename std::enable_if<std::is_base_of<air::runtime::ObjectRef, T>::value>::type DumpJsonContent(
+  const T &content, std::ostream &buf) {
+  buf << air::SaveJSON(content);
+}
+
+template <typename T>
+typename std::enable_if<!std::is_base_of<air::runtime::ObjectRef, T>::value>::type DumpJsonContent(
+  const T &content, std::ostream &buf) {
+  DumpRealContent<T>(content, buf);
+}
+
 class PassMgr {
  public:
   template <typename... Args>
@@ -78,7 +95,20 @@ class PassMgr {
     auto res = Run().operator T();
 
     if (tl_config_->dump_pass_ir) {
-      DumpIr(std::bind(DumpRealContent<T>, res, std::placeholders::_1));
+      // the archive writer prints in its own thread, so the result is captured by value
+      bool json = common::IrDumpWriter::JsonFormat();
+      bool skipped = skipped_;
+      std::string sub_name = sub_name_;
+      DumpIr([res, json, skipped, sub_name](std::ostream &os) {
+        if (skipped) {
+          os << "// " << sub_name << " skipped: no trigger feature in ir\n";
+        }
+        if (json) {
+          DumpJsonContent<T>(res, os);
+        } else {
+          DumpRealContent<T>(res, os);
+        }
+      });
     }
     TryDumpC(res);
     return res;
@@ -94,12 +124,16 @@ class PassMgr {
   TVMRetValue Run() const;
   void DumpIr(std::function<void(std::ostream &os)> print) const;
   bool ShouldDumpC() const;
+  bool ShouldSkip() const;
   std::string GetDumpIrFilePath() const;
 
   thread_local static int tl_pass_id_;
   thread_local static air::BuildConfig tl_config_;
   thread_local static std::string tl_dump_ir_dir_;
   thread_local static air::Array<NodeRef> tl_args_;
+  // census of the last statement a pass with trigger features was asked to run on
+  thread_local static NodeRef tl_census_stmt_;
+  thread_local static IRCensus tl_census_;
 
   std::string pass_name_;
   std::string sub_name_;
@@ -107,6 +141,7 @@ class PassMgr {
   std::vector<int> args_types_;
 
   bool enable_timer_ = false;
+  mutable bool skipped_ = false;
 
   template <typename T>
   void TryDumpC(const T &node) const {
@@ -133,12 +133,12 @@ std::string AttrMap::GetStr(const std::string &attr_name, const std::string &dft
   return dft_value;
 }
 
-void PassTimer::AddItem(const std::string &pass_name, int64_t elapsed_seconds) {
+void PassTimer::AddItem(const std::string &pass_name, int64_t elapsed_us) {
   auto iter = pass_time_.find(pass_name);
   if (iter != pass_time_.end()) {
-    iter->second += elapsed_seconds;
+    iter->second += elapsed_us;
   } else {
-    pass_time_[pass_name] = elapsed_seconds;
+    pass_time_[pass_name] = elapsed_us;
   }
 }
 
@@ -162,7 +162,13 @@ std::string PassTimer::ToString() const {
   }
 
   for (auto iter : timers) {
-    buf << "\n" << iter.first << " - " << iter.second << " s";
+    buf << "\n" << iter.first << " - " << iter.second << " us";
+  }
+  if (!pass_skipped_.empty()) {
+    buf << "\nSkippedPassName - Count";
+    for (const auto &iter : pass_skipped_) {
+      buf << "\n" << iter.first << " - " << iter.second;
+    }
   }
   return buf.str();
 }
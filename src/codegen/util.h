@@ -77,6 +77,7 @@ constexpr auto kEleminateOutmostForCond = "eleminate_outmost_for_cond";
 constexpr auto kDisableHalfToFloatSumOpt = "disable_half_to_float_sum_opt";
 constexpr auto kAkgTargetHostName = "stackvm";
 constexpr auto kEnableAutoInline = "enable_auto_inline";
+constexpr auto kEnableInlineCostModel = "enable_inline_cost_model";
 constexpr auto kEnableAutoFuse = "enable_auto_fuse";
 constexpr auto kAutoFuseSplit = "auto_fuse_split";
 constexpr auto kEnableCSE = "enable_common_subexpr_elim";
@@ -105,6 +106,13 @@ constexpr auto kEnablePolySch = "enable_poly_sch";
 constexpr auto kEnableFuseAxis = "enable_fuse_axis";
 constexpr auto kEnableAtomicAdd = "enable_atomic_add";
 constexpr auto kEnableSwizzleGPU = "enable_swizzle_gpu";
+constexpr auto kEnableGlobalValueNumbering = "enable_global_value_numbering";
+constexpr auto kEnableStrengthReduceDivMod = "enable_strength_reduce_div_mod";
+constexpr auto kEnablePackSharedMemory = "enable_pack_shared_memory";
+constexpr auto kGemmSplitK = "gemm_split_k";
+constexpr auto kGemmSplitKPlan = "gemm_split_k_plan";
+constexpr auto kEnableUnrollPlan = "enable_unroll_plan";
+constexpr auto kUnrollRegisterCap = "unroll_register_cap";
 
 static std::unordered_map<std::string, int> help_tiling_level = {
   {"None", 0},
@@ -132,9 +140,15 @@ class PassTimer {
  public:
   ~PassTimer() = default;
 
-  void AddItem(const std::string &pass_name, int64_t elapsed_seconds);
-  void Clear() { pass_time_.clear(); }
+  void AddItem(const std::string &pass_name, int64_t elapsed_us);
+  void AddSkippedItem(const std::string &pass_name) { ++pass_skipped_[pass_name]; }
+  void Clear() {
+    pass_time_.clear();
+    pass_skipped_.clear();
+  }
   std::string ToString() const;
+  // accumulated time of every pass in microseconds
+  const std::unordered_map<std::string, int64_t> &GetPassTime() const { return pass_time_; }
 
   static PassTimer *GetInstance() {
     static PassTimer pass_timer;
@@ -145,6 +159,8 @@ class PassTimer {
   PassTimer() { Clear(); }
 
   std::unordered_map<std::string, int64_t> pass_time_;
+  // number of times a pass was skipped because its trigger features were absent
+  std::unordered_map<std::string, int64_t> pass_skipped_;
 };
 
 std::ostream &operator<<(std::ostream &os, const PassTimer &time);
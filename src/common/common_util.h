@@ -89,6 +89,9 @@ inline std::string GetGlobalName(std::string input) {
 // Restrictions of GPU shared memory
 constexpr size_t SHARED_MEMORY_SIZE{49152};
 constexpr size_t ADVANCED_SHARED_MEMORY_SIZE{61440};
+constexpr size_t SHARED_MEMORY_ALIGN_BYTES{16};
+
+inline size_t AlignUp(size_t bytes, size_t align) { return (bytes + align - 1) / align * align; }
 
 }  // namespace common
 }  // namespace akg
@@ -0,0 +1,230 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/ir_dump_writer.h"
+
+#include <dmlc/logging.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <utility>
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace akg {
+namespace common {
+namespace {
+constexpr auto kArchiveFlag = "MS_AKG_DUMP_IR_ARCHIVE";
+constexpr size_t kMaxQueueSize = 64;
+#ifdef USE_ZLIB
+constexpr auto kArchiveName = "pass_ir.log.gz";
+#else
+constexpr auto kArchiveName = "pass_ir.log";
+#endif
+}  // namespace
+
+IrDumpWriter &IrDumpWriter::GetInstance() {
+  static IrDumpWriter writer;
+  return writer;
+}
+
+IrDumpWriter::~IrDumpWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  not_empty_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+  Close();
+}
+
+void IrDumpWriter::BeginKernel(const std::string &dump_dir) {
+  tl_archive_.clear();
+  tl_json_format_ = false;
+  const char *flag = std::getenv(kArchiveFlag);
+  if (dump_dir.empty() || flag == nullptr || std::string(flag).empty() || std::string(flag) == "off") {
+    return;
+  }
+  std::string config(flag);
+  size_t ring_size = 0;
+  auto pos = config.find(':');
+  if (pos != std::string::npos) {
+    ring_size = static_cast<size_t>(std::max(std::atoi(config.substr(pos + 1).c_str()), 0));
+    config = config.substr(0, pos);
+  }
+  CHECK(config == "on" || config == "text" || config == "json")
+    << "Unknown format " << config << " in " << kArchiveFlag << ", expect text or json";
+  tl_json_format_ = config == "json";
+  tl_archive_ = dump_dir + "/" + kArchiveName;
+
+  Record record;
+  record.archive = tl_archive_;
+  record.ring_size = ring_size;
+  record.begin_kernel = true;
+  GetInstance().Enqueue(std::move(record));
+}
+
+void IrDumpWriter::EndKernel() {
+  if (!Enabled()) {
+    return;
+  }
+  Record record;
+  record.archive = tl_archive_;
+  record.end_kernel = true;
+  auto &writer = GetInstance();
+  writer.WaitWritten(writer.Enqueue(std::move(record)));
+  tl_archive_.clear();
+  tl_json_format_ = false;
+}
+
+void IrDumpWriter::Push(const std::string &name, Printer print) {
+  CHECK(Enabled()) << "No ir dump archive is started by this thread";
+  Record record;
+  record.archive = tl_archive_;
+  record.name = name;
+  record.print = std::move(print);
+  Enqueue(std::move(record));
+}
+
+uint64_t IrDumpWriter::Enqueue(Record record) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!worker_.joinable()) {
+    worker_ = std::thread(&IrDumpWriter::Run, this);
+  }
+  not_full_.wait(lock, [this] { return queue_.size() < kMaxQueueSize; });
+  queue_.push_back(std::move(record));
+  uint64_t seq = ++enqueued_;
+  lock.unlock();
+  not_empty_.notify_one();
+  return seq;
+}
+
+void IrDumpWriter::WaitWritten(uint64_t seq) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  written_cv_.wait(lock, [this, seq] { return written_ >= seq; });
+}
+
+void IrDumpWriter::Run() {
+  while (true) {
+    Record record;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      not_empty_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      record = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    not_full_.notify_one();
+    Write(record);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++written_;
+    }
+    written_cv_.notify_all();
+  }
+}
+
+void IrDumpWriter::Write(const Record &record) {
+  if (record.begin_kernel) {
+    // a kernel compiled again starts a new archive, as the files of its dumps are overwritten
+    if (open_archive_ == record.archive) {
+      Close();
+    }
+    static_cast<void>(std::remove(record.archive.c_str()));
+    archives_.erase(std::remove(archives_.begin(), archives_.end(), record.archive), archives_.end());
+    archives_.push_back(record.archive);
+    while (record.ring_size > 0 && archives_.size() > record.ring_size) {
+      if (open_archive_ == archives_.front()) {
+        Close();
+      }
+      static_cast<void>(std::remove(archives_.front().c_str()));
+      archives_.pop_front();
+    }
+    return;
+  }
+  if (record.end_kernel) {
+    // closing flushes the compressed stream, the archive is reopened in append mode by a later dump
+    if (open_archive_ == record.archive) {
+      Close();
+    }
+    return;
+  }
+
+  std::ostringstream content;
+  try {
+    record.print(content);
+  } catch (const std::exception &e) {
+    LOG(WARNING) << "Failed to print ir dump " << record.name << ": " << e.what();
+    return;
+  }
+  if (open_archive_ != record.archive) {
+    Close();
+    Open(record.archive);
+  }
+  if (file_ == nullptr) {
+    return;
+  }
+  std::ostringstream header;
+  header << "==== " << record.name << " " << content.str().size() << "\n";
+  for (const auto &data : {header.str(), content.str()}) {
+#ifdef USE_ZLIB
+    bool ok = gzwrite(static_cast<gzFile>(file_), data.data(), static_cast<unsigned>(data.size())) ==
+              static_cast<int>(data.size());
+#else
+    bool ok = std::fwrite(data.data(), 1, data.size(), static_cast<std::FILE *>(file_)) == data.size();
+#endif
+    if (!ok) {
+      LOG(WARNING) << "Failed to write ir dump " << record.name << " to " << record.archive;
+      return;
+    }
+  }
+}
+
+void IrDumpWriter::Open(const std::string &archive) {
+#ifdef USE_ZLIB
+  file_ = gzopen(archive.c_str(), "ab");
+#else
+  file_ = std::fopen(archive.c_str(), "ab");
+#endif
+  if (file_ == nullptr) {
+    LOG(WARNING) << "Failed to open ir dump archive " << archive;
+    return;
+  }
+  open_archive_ = archive;
+}
+
+void IrDumpWriter::Close() {
+  if (file_ != nullptr) {
+#ifdef USE_ZLIB
+    static_cast<void>(gzclose(static_cast<gzFile>(file_)));
+#else
+    static_cast<void>(std::fclose(static_cast<std::FILE *>(file_)));
+#endif
+  }
+  file_ = nullptr;
+  open_archive_.clear();
+}
+
+thread_local std::string IrDumpWriter::tl_archive_;
+thread_local bool IrDumpWriter::tl_json_format_ = false;
+}  // namespace common
+}  // namespace akg
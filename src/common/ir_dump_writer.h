@@ -0,0 +1,113 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef COMMON_IR_DUMP_WRITER_H_
+#define COMMON_IR_DUMP_WRITER_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace akg {
+namespace common {
+/*
+ * Writes the ir dumps of the kernels in a background thread instead of a file per dump. The dumps of a
+ * kernel are appended as records to a single archive, gzip compressed when zlib is available:
+ *   ==== <name> <size>\n
+ *   <size bytes of content>
+ * Dumps are printed by the writer thread, so they must only hold immutable nodes or copies of their data.
+ * In ring mode only the archives of the last kernels are kept.
+ */
+class IrDumpWriter {
+ public:
+  using Printer = std::function<void(std::ostream &os)>;
+
+  ~IrDumpWriter();
+
+  static IrDumpWriter &GetInstance();
+
+  /*
+   * Starts the archive of the kernel compiled by this thread in its dump dir, as configured by the
+   * MS_AKG_DUMP_IR_ARCHIVE environment variable: "<format>[:<ring size>]", the format being "text" (or "on")
+   * or "json". The dumps are written as files when it is not set, and not archived for an empty dump dir.
+   */
+  static void BeginKernel(const std::string &dump_dir);
+  /*
+   * Ends the archive of the kernel compiled by this thread: waits until its queued dumps are written and
+   * closes the archive, so that it is complete on disk when the kernel is done, even after an error.
+   */
+  static void EndKernel();
+  static bool Enabled() { return !tl_archive_.empty(); }
+  // ir nodes are dumped with SaveJSON, which LoadJSON reads back
+  static bool JsonFormat() { return tl_json_format_; }
+
+  // Queues a dump of the current kernel, blocking while the queue is full.
+  void Push(const std::string &name, Printer print);
+
+ private:
+  struct Record {
+    std::string archive;
+    std::string name;
+    Printer print;
+    // number of archives to keep on a new kernel, 0 for all of them
+    size_t ring_size{0};
+    bool begin_kernel{false};
+    bool end_kernel{false};
+  };
+
+  IrDumpWriter() = default;
+  // Returns the sequence number of the record, for WaitWritten.
+  uint64_t Enqueue(Record record);
+  void WaitWritten(uint64_t seq);
+  void Run();
+  void Write(const Record &record);
+  void Open(const std::string &archive);
+  void Close();
+
+  thread_local static std::string tl_archive_;
+  thread_local static bool tl_json_format_;
+
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::condition_variable written_cv_;
+  std::deque<Record> queue_;
+  uint64_t enqueued_{0};
+  uint64_t written_{0};
+  bool stop_{false};
+  std::thread worker_;
+
+  // owned by the writer thread
+  std::string open_archive_;
+  void *file_{nullptr};
+  std::deque<std::string> archives_;
+};
+
+// Ends the ir dump archive of the kernel when the lowering of the kernel is left, errors included.
+class IrDumpKernelScope {
+ public:
+  IrDumpKernelScope() = default;
+  ~IrDumpKernelScope() { IrDumpWriter::EndKernel(); }
+};
+}  // namespace common
+}  // namespace akg
+
+#endif  // COMMON_IR_DUMP_WRITER_H_
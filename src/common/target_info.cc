@@ -31,6 +31,17 @@ TVM_STATIC_IR_FUNCTOR(IRPrinter, vtable)
 
 TVM_REGISTER_NODE_TYPE(GpuMemoryInfoNode);
 
+TVM_STATIC_IR_FUNCTOR(IRPrinter, vtable)
+.set_dispatch<GpuComputeInfoNode>([](const ObjectRef& node, IRPrinter *p) {
+    auto* op = static_cast<const GpuComputeInfoNode*>(node.get());
+    p->stream << "compute-info("
+              << "num_sm=" << op->num_sm << ", max_blocks_per_sm=" << op->max_blocks_per_sm
+              << ", max_threads_per_sm=" << op->max_threads_per_sm << ", max_regs_per_sm=" << op->max_regs_per_sm
+              << ", max_shared_bytes_per_sm=" << op->max_shared_bytes_per_sm << ")";
+});
+
+TVM_REGISTER_NODE_TYPE(GpuComputeInfoNode);
+
 GpuMemoryInfo GetGpuMemoryInfo(const std::string& scope) {
   std::string fname = "gpu.info.mem." + scope;
   const runtime::PackedFunc* f = runtime::Registry::Get(fname);
@@ -41,4 +52,13 @@ GpuMemoryInfo GetGpuMemoryInfo(const std::string& scope) {
   }
 }
 
+GpuComputeInfo GetGpuComputeInfo() {
+  const runtime::PackedFunc* f = runtime::Registry::Get("gpu.info.compute");
+  if (f == nullptr) {
+    return GpuComputeInfo();
+  } else {
+    return (*f)();
+  }
+}
+
 }  // namespace air
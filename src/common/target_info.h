@@ -51,5 +51,42 @@ TVM_DEFINE_NODE_REF(GpuMemoryInfo, GpuMemoryInfoNode);
  */
 TVM_DLL GpuMemoryInfo GetGpuMemoryInfo(const std::string& scope);
 
+/*!
+ * \brief Compute resource information of gpu device.
+ *  Use GpuComputeInfoNode as its container type
+ */
+struct GpuComputeInfoNode : public Node {
+  /*! \brief Number of streaming multiprocessors on the device */
+  int num_sm;
+  /*! \brief Maximum number of resident blocks per multiprocessor */
+  int max_blocks_per_sm;
+  /*! \brief Maximum number of resident threads per multiprocessor */
+  int max_threads_per_sm;
+  /*! \brief Number of 32-bit registers per multiprocessor */
+  int max_regs_per_sm;
+  /*! \brief Maximum number of bytes of shared memory per multiprocessor */
+  int max_shared_bytes_per_sm;
+
+  void VisitAttrs(AttrVisitor* v) {
+    v->Visit("num_sm", &num_sm);
+    v->Visit("max_blocks_per_sm", &max_blocks_per_sm);
+    v->Visit("max_threads_per_sm", &max_threads_per_sm);
+    v->Visit("max_regs_per_sm", &max_regs_per_sm);
+    v->Visit("max_shared_bytes_per_sm", &max_shared_bytes_per_sm);
+  }
+
+  static constexpr const char* _type_key = "GpuComputeInfo";
+  TVM_DECLARE_NODE_TYPE_INFO(GpuComputeInfoNode, Node);
+};
+
+/*! \brief Defines compute info */
+TVM_DEFINE_NODE_REF(GpuComputeInfo, GpuComputeInfoNode);
+
+/*!
+ * \brief get compute resource info of current gpu device
+ * \return info The compute info.
+ */
+TVM_DLL GpuComputeInfo GetGpuComputeInfo();
+
 }  // namespace air
 #endif  // AKG_TARGET_INFO_H_
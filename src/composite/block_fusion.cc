@@ -17,10 +17,13 @@
 #include <functional>
 #include <memory>
 #include <set>
+#include <sstream>
+#include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "common/target_info.h"
 #include "composite/block_fusion.h"
 #include "composite/sync_process.h"
 
@@ -34,8 +37,10 @@ constexpr auto kThreadIdxX = "threadIdx.x";
 constexpr auto kThreadExtent = "thread_extent";
 constexpr auto kPipelineTotalSMem = "pipeline_total_shared_memory";
 constexpr auto kTotalSMem = "total_shared_memory";
+constexpr auto kBlockFusionPlan = "block_fusion_plan";
 constexpr int kBlockIdxLen = 9;
 constexpr int kThreadIdxLen = 10;
+constexpr int kWarpSize = 32;
 }  // namespace
 
 struct FuncInfo {
@@ -283,6 +288,63 @@ class BlockIndexRewrite final : public IRMutator {
   int offset_;
 };
 
+// Per-thread work of a segment: its stores weighted by the constant trip counts of the enclosing loops.
+class WorkEstimator : public IRVisitor {
+ public:
+  int64_t Run(const Stmt &stmt) {
+    Visit(stmt);
+    return std::max<int64_t>(work_, 1);
+  }
+
+  void Visit_(const For *op) override {
+    int64_t extent = op->extent.as<IntImm>() ? op->extent.as<IntImm>()->value : 1;
+    int64_t trip = trip_;
+    trip_ *= std::max<int64_t>(extent, 1);
+    IRVisitor::Visit_(op);
+    trip_ = trip;
+  }
+
+  void Visit_(const Store *op) override {
+    work_ += trip_;
+    IRVisitor::Visit_(op);
+  }
+
+ private:
+  int64_t trip_{1};
+  int64_t work_{0};
+};
+
+// Threads of a segment that neither synchronize nor share data can be folded into an intra-block loop.
+class ThreadFoldChecker : public IRVisitor {
+ public:
+  bool Run(const Stmt &stmt) {
+    auto res = EvaluateVisitor().Run(stmt);
+    if (res.first || res.second) {
+      return false;
+    }
+    Visit(stmt);
+    return foldable_;
+  }
+
+  void Visit_(const AttrStmt *op) override {
+    if (op->attr_key == "storage_scope" && op->value.as<StringImm>()->value == "shared") {
+      foldable_ = false;
+    }
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const Call *op) override {
+    if (op->is_intrinsic(air::ir::intrinsic::tvm_storage_sync) || op->name.find("shfl") != std::string::npos ||
+        op->name.find("warp") != std::string::npos || op->name.find("akg_reduce") != std::string::npos) {
+      foldable_ = false;
+    }
+    IRVisitor::Visit_(op);
+  }
+
+ private:
+  bool foldable_{true};
+};
+
 void RemoveDimInfo(std::vector<FuncInfo> &funcs) {
   for (auto &func : funcs) {
     func.stmt = RemoveDimAttr().Mutate(func.stmt);
@@ -666,7 +728,9 @@ class LowerBlockFusionGpu : public LowerStmtsFusion {
       std::bind(RemoveDimInfo, std::placeholders::_1),
       // 4. Update offset of blockIdx.x and caculate maximum.
       std::bind(&LowerBlockFusionGpu::ProcessBlockAndThread, this, std::placeholders::_1),
-      // 5. Merge ir with IfThenElse
+      // 5. Choose the common thread extent by the modeled makespan.
+      std::bind(&LowerBlockFusionGpu::BalanceThreadExtent, this, std::placeholders::_1),
+      // 6. Merge ir with IfThenElse
       std::bind(&LowerBlockFusionGpu::MergeIr, this, std::placeholders::_1),
     };
     stmt_transforms_ = {
@@ -686,6 +750,7 @@ class LowerBlockFusionGpu : public LowerStmtsFusion {
     max_block_num_ = 0;
     max_thread_num_ = 0;
     total_shared_memory_ = 0;
+    plan_.clear();
   }
 
   void ArrangeSharedMemory(std::vector<FuncInfo> &funcs) {
@@ -735,6 +800,104 @@ class LowerBlockFusionGpu : public LowerStmtsFusion {
     }
   }
 
+  /*
+   * Every block of the fused kernel pays the common thread extent T, so a wide segment slows down all the
+   * narrow ones. Segments wider than T whose threads do not cooperate are folded into an intra-block loop:
+   *   for (tx_iter, 0, ceil(t / T)) {
+   *     if (tx_iter * T + threadIdx.x < t) {
+   *       STMT(threadIdx.x -> tx_iter * T + threadIdx.x)
+   *     }
+   *   }
+   * The makespan of a candidate T is modeled as the larger of the block work spread over the resident blocks
+   * of the device and the longest block. The plain fusion at the maximum thread extent is kept unless another
+   * extent is strictly better.
+   */
+  void BalanceThreadExtent(std::vector<FuncInfo> &funcs) {
+    size_t num = funcs.size();
+    std::vector<int64_t> blocks(num), threads(num), work(num);
+    std::vector<bool> foldable(num);
+    int64_t min_extent = 1;
+    for (size_t i = 0; i < num; ++i) {
+      blocks[i] = funcs[i].block_ext.as<IntImm>()->value;
+      threads[i] = funcs[i].thread_ext.as<IntImm>()->value;
+      work[i] = WorkEstimator().Run(funcs[i].stmt);
+      foldable[i] = ThreadFoldChecker().Run(funcs[i].stmt);
+      if (!foldable[i]) {
+        min_extent = std::max(min_extent, threads[i]);
+      }
+    }
+
+    int64_t num_sm = 80;
+    int64_t max_blocks_per_sm = 32;
+    int64_t max_threads_per_sm = 2048;
+    air::GpuComputeInfo info = air::GetGpuComputeInfo();
+    if (info.defined()) {
+      num_sm = info->num_sm;
+      max_blocks_per_sm = info->max_blocks_per_sm;
+      max_threads_per_sm = info->max_threads_per_sm;
+    }
+    auto Makespan = [&](int64_t extent) -> double {
+      int64_t resident = std::max<int64_t>(std::min(max_blocks_per_sm, max_threads_per_sm / extent), 1) * num_sm;
+      double total = 0;
+      double longest = 0;
+      for (size_t i = 0; i < num; ++i) {
+        double block_work = static_cast<double>(work[i] * ((threads[i] + extent - 1) / extent));
+        total += block_work * blocks[i];
+        longest = std::max(longest, block_work);
+      }
+      return std::max(total / resident, longest);
+    };
+
+    // candidates are the thread extents of the segments and the multiples of a warp in between
+    int64_t max_extent = static_cast<int64_t>(max_thread_num_);
+    std::set<int64_t> candidates(threads.begin(), threads.end());
+    for (int64_t extent = kWarpSize; extent < max_extent; extent *= 2) {
+      candidates.insert(extent);
+    }
+    int64_t best_extent = max_extent;
+    double fused_cost = Makespan(max_extent);
+    double best_cost = fused_cost;
+    for (auto extent : candidates) {
+      if (extent < min_extent || extent >= max_extent) {
+        continue;
+      }
+      double cost = Makespan(extent);
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_extent = extent;
+      }
+    }
+
+    std::stringstream plan;
+    plan << (best_extent == max_extent ? "fused" : "retiled") << " threads " << best_extent << ", makespan "
+         << best_cost << " (fused at " << max_extent << ": " << fused_cost << ");";
+    for (size_t i = 0; i < num; ++i) {
+      int64_t folds = (threads[i] + best_extent - 1) / best_extent;
+      plan << " [" << i << "] blocks " << blocks[i] << " threads " << threads[i] << " work " << work[i];
+      if (folds > 1) {
+        plan << " folded x" << folds;
+        FoldThreads(funcs[i], best_extent, folds);
+      }
+    }
+    plan_ = plan.str();
+    max_thread_num_ = static_cast<size_t>(best_extent);
+    LOG(DEBUG) << "BlockFusion plan: " << plan_;
+  }
+
+  void FoldThreads(FuncInfo &func, int64_t extent, int64_t folds) {
+    Var iter("tx_iter", Int(32));
+    Expr new_thread = iter * static_cast<int>(extent) + thread_var_;
+    std::unordered_map<const Variable *, Expr> vmap;
+    vmap[thread_var_.get()] = new_thread;
+    Stmt body = Substitute(func.stmt, vmap);
+    int thread_num = func.thread_ext.as<IntImm>()->value;
+    if (thread_num % extent != 0) {
+      body = IfThenElse::make(new_thread < thread_num, body);
+    }
+    func.stmt = For::make(iter, 0, static_cast<int>(folds), ForType::Serial, DeviceAPI::None, body);
+    func.thread_ext = make_const(Int(32), extent);
+  }
+
   void MergeIr(std::vector<FuncInfo> &funcs) {
     //   a.update thread_overflow by comparing thread extent with final extent
     //   b.update thread condition
@@ -764,6 +927,10 @@ class LowerBlockFusionGpu : public LowerStmtsFusion {
     if (total_shared_memory_ > 0) {
       stmt = AttrStmt::make(make_zero(Int(32)), kTotalSMem, IntImm::make(Int(32), total_shared_memory_), stmt);
     }
+    // shows up in the merge dump
+    if (!plan_.empty()) {
+      stmt = AttrStmt::make(make_zero(Int(32)), kBlockFusionPlan, StringImm::make(plan_), stmt);
+    }
     stmt = AttrStmt::make(thread_iv, kThreadExtent, fusion_tx_ext, stmt);
     stmt = AttrStmt::make(block_iv, kThreadExtent, fusion_bx_ext, stmt);
   }
@@ -775,6 +942,7 @@ class LowerBlockFusionGpu : public LowerStmtsFusion {
   size_t max_thread_num_;
 
   int total_shared_memory_{0};
+  std::string plan_;
 };
 
 class LowerBlockFusionAscend : public LowerStmtsFusion {
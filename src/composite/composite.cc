@@ -21,6 +21,7 @@
 #include "composite/block_fusion.h"
 #include "composite/stitch_fusion.h"
 #include "composite/sync_process.h"
+#include "composite/shape_bucket.h"
 
 namespace akg {
 class Emitter : public IRVisitor {
@@ -253,10 +254,33 @@ NodeRef CompositeWithJsonToFunc(const std::string &json_str, Map<std::string, No
   return std::move(build_rst);
 }
 
+Module CompositeWithJsonBuckets(const picojson::value &v, const Map<std::string, NodeRef> &attrs, bool poly) {
+  BuildInfo info;
+  // the named dim is kept as a dim of the args, to be read at launch
+  info.opt.fold_dim = false;
+  ExtractBuildInfo(v, info);
+  auto bucket_info = GetShapeBucketInfo(info, attrs);
+  const auto *build_func = air::runtime::Registry::Get("akg_build_gpu_module");
+  CHECK(build_func != nullptr);
+  std::string sch = GetSchedule(info.tensors);
+  std::vector<Module> variants;
+  for (auto bound : bucket_info.bounds) {
+    Module variant = (*build_func)(info.tensors, info.args, sch, ShapeBucketKernelName(info.kernel_name, bound),
+                                   ShapeBucketAttrs(attrs, bound), poly, info.in_binds);
+    variants.push_back(variant);
+  }
+  return ShapeBucketModule(info.kernel_name, bucket_info, variants);
+}
+
 Module CompositeWithJsonGpu(const std::string &json_str, const Map<std::string, NodeRef> &attrs, bool poly) {
   picojson::value v = String2Json(json_str);
+  if (attrs.find(kShapeBuckets) != attrs.end()) {
+    return CompositeWithJsonBuckets(v, attrs, poly);
+  }
   BuildInfo info;
   ExtractBuildInfo(v, info);
+  CHECK(info.shape_vars.empty()) << "The named dims " << info.shape_vars << " of " << info.kernel_name
+                                 << " need the attr " << kShapeBuckets;
   const auto *build_func = air::runtime::Registry::Get("akg_build_gpu_module");
   CHECK(build_func != nullptr);
   std::string sch = GetSchedule(info.tensors);
@@ -302,6 +326,42 @@ NodeRef CompositeLower(const std::string &json_str, const Map<std::string, NodeR
                     config);
 }
 
+// Lowers the kernel of every shape bucket of a cuda graph, which needs no device.
+NodeRef CompositeLowerBuckets(const std::string &json_str, const Map<std::string, NodeRef> &attrs) {
+  CHECK(GetProcess(json_str) == "cuda") << "Only cuda kernels are compiled per shape bucket.";
+  picojson::value v = String2Json(json_str);
+  BuildInfo info;
+  info.opt.fold_dim = false;
+  ExtractBuildInfo(v, info);
+  auto bucket_info = GetShapeBucketInfo(info, attrs);
+  Array<Operation> ops;
+  std::for_each(info.tensors.begin(), info.tensors.end(), [&ops](const Tensor &t) { ops.push_back(t->op); });
+  auto config = GetConfig();
+  Array<NodeRef> shape_vars;
+  Map<std::string, NodeRef> lowered;
+  for (auto bound : bucket_info.bounds) {
+    Schedule sch = create_schedule(ops);
+    auto name = ShapeBucketKernelName(info.kernel_name, bound);
+    lowered.Set(name, akg::Lower(sch, info.args, shape_vars, name, info.in_binds, ShapeBucketAttrs(attrs, bound),
+                                 false, true, false, "cuda", config));
+  }
+  return lowered;
+}
+
+NodeRef CompositeLowerPrefix(const std::string &json_str, const Map<std::string, NodeRef> &attrs) {
+  CHECK(GetProcess(json_str) == "cuda") << "Only cuda kernels can share the lowered prefix among tuning candidates.";
+  picojson::value v = String2Json(json_str);
+  BuildInfo info;
+  ExtractBuildInfo(v, info);
+  std::string sch_name = GetSchedule(info.tensors);
+  const auto *sch_create = air::runtime::Registry::Get("select_cuda_scheduler");
+  CHECK(sch_create != nullptr);
+  Schedule sch = (*sch_create)(info.tensors, sch_name, true);
+  auto config = GetConfig();
+  Array<NodeRef> shape_vars;
+  return akg::LowerToPrefix(sch, info.args, shape_vars, info.kernel_name, info.in_binds, attrs, "cuda", config);
+}
+
 std::vector<std::string> GetNames(const Array<NodeRef> &io) {
   std::vector<std::string> names;
   for (const auto &arg : io) {
@@ -541,7 +601,7 @@ class CompositeJsonListGpu : public CompositeJsonList {
     buf_manager.BufferAllocReuse();
     GetRealOutputs();
     auto stitched_ir = StitchFusionGpu(stitch_irs, merge_name_, stitch_attr, buf_manager.stitch_buffer_map,
-                                       buf_manager.buf_within_op_map, buf_manager.allocate_revoke, real_outputs_);
+                                       buf_manager.buf_within_op_map, real_outputs_);
     return stitched_ir;
   }
 
@@ -864,4 +924,6 @@ TVM_REGISTER_GLOBAL("composite_with_json_to_func").set_body_typed(CompositeWithJ
 TVM_REGISTER_GLOBAL("composite_with_json").set_body_typed(CompositeWithJson);
 TVM_REGISTER_GLOBAL("composite_with_json_list").set_body_typed(CompositeWithJsonList);
 TVM_REGISTER_GLOBAL("composite_lower").set_body_typed(CompositeLower);
+TVM_REGISTER_GLOBAL("composite_lower_prefix").set_body_typed(CompositeLowerPrefix);
+TVM_REGISTER_GLOBAL("composite_lower_buckets").set_body_typed(CompositeLowerBuckets);
 }  // namespace akg
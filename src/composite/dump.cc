@@ -37,8 +37,7 @@ void DumpIRAttr(const std::string &kernel_name, const IrAttrInfo &attr, size_t i
 
 void DumpStitchInfo(const std::string &kernel_name, StitchAttrInfo &store_attr,
                     std::unordered_map<std::string, StitchBufferInfo> &stitch_buffer_map,
-                    std::unordered_map<std::string, StitchBufferInfo> &buf_within_op_map,
-                    std::vector<std::string> &allocate_revoke) {
+                    std::unordered_map<std::string, StitchBufferInfo> &buf_within_op_map) {
   if (getenv(GetDumpIRFlag().c_str()) == nullptr) return;
   std::ofstream of;
   of.open("stitch_info/" + kernel_name + "_stitch.log", std::ios::app);
@@ -81,10 +80,6 @@ void DumpStitchInfo(const std::string &kernel_name, StitchAttrInfo &store_attr,
     of << kv.first << std::endl;
     of << kv.second << std::endl;
   }
-  DumpHeader(of, "allocate_revoke");
-  for (const auto &a : allocate_revoke) {
-    of << a << std::endl;
-  }
   of.close();
 }
 
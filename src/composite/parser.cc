@@ -149,6 +149,7 @@ Stmt Parse(const picojson::value &input_json, BuildInfo &info) {
   parser.Parse();
   info.opt.input_funcs = parser.input_funcs_;
   info.opt.output_funcs = parser.output_funcs_;
+  info.shape_vars = parser.shape_vars_;
   info.opt.target = target;
   return MakeStmt(parser.op_descs_);
 }
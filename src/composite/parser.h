@@ -15,6 +15,8 @@
  */
 #ifndef COMPOSITE_PARSER_H_
 #define COMPOSITE_PARSER_H_
+#include <algorithm>
+#include <cctype>
 #include <string>
 #include <tuple>
 #include <unordered_map>
@@ -77,6 +79,7 @@ class OpDescsParser {
   std::vector<OpDesc> op_descs_;
   FuncRefList input_funcs_;
   FuncRefList output_funcs_;
+  Array<Var> shape_vars_;
 
  private:
   const picojson::array op_descs_json_;
@@ -99,6 +102,20 @@ class OpDescsParser {
     }
   }
 
+  // A named dim is a symbolic extent, the dims of the same name sharing it.
+  Var GetShapeVar(const std::string &name) {
+    for (const auto &var : shape_vars_) {
+      if (var->name_hint == name) {
+        return var;
+      }
+    }
+    CHECK(!name.empty() && std::all_of(name.begin(), name.end(), [](char c) { return std::isalnum(c) || c == '_'; }))
+      << "Invalid name of symbolic dim: " << name;
+    Var var(name, Int(32));
+    shape_vars_.push_back(var);
+    return var;
+  }
+
   void MakeTensors(const std::vector<TensorInfo> &tensor_info, Array<NodeRef> &tensors) {
     for (const auto &info : tensor_info) {
       if (info.has_value_) {
@@ -133,6 +150,10 @@ class OpDescsParser {
         CHECK(item.second.is<picojson::array>());
         const picojson::array &dims = item.second.get<picojson::array>();
         for (const auto &dim : dims) {
+          if (dim.is<std::string>()) {
+            info.shape_.push_back(GetShapeVar(dim.get<std::string>()));
+            continue;
+          }
           CHECK(dim.is<int64_t>());
           info.shape_.push_back(Expr(static_cast<int>(dim.get<int64_t>())));
         }
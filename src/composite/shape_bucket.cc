@@ -0,0 +1,146 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/packed_func.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "composite/shape_bucket.h"
+#include "tvm.h"
+
+namespace akg {
+namespace {
+constexpr auto kDynamicShapeBound = "dynamic_shape_bound";
+
+class ShapeBucketModuleNode : public air::runtime::ModuleNode {
+ public:
+  ShapeBucketModuleNode(const std::string &kernel_name, const ShapeBucketInfo &bucket_info,
+                        const std::vector<Module> &variants)
+      : kernel_name_(kernel_name), bucket_info_(bucket_info) {
+    CHECK_EQ(variants.size(), bucket_info.bounds.size());
+    for (size_t i = 0; i < variants.size(); ++i) {
+      auto name = ShapeBucketKernelName(kernel_name, bucket_info.bounds[i]);
+      Module variant = variants[i];
+      auto func = variant.GetFunction(name);
+      CHECK(func != nullptr) << "No kernel " << name << " in the module of its bucket";
+      funcs_.push_back(func);
+    }
+  }
+
+  const char *type_key() const final { return "shape_bucket"; }
+
+  PackedFunc GetFunction(const std::string &name, const ObjectPtr<Object> &sptr_to_self) final {
+    if (name != kernel_name_ && name != air::runtime::symbol::tvm_module_main) {
+      return PackedFunc();
+    }
+    // capture sptr_to_self to keep the modules of the buckets alive
+    return PackedFunc([this, sptr_to_self](air::runtime::TVMArgs args, air::runtime::TVMRetValue *rv) {
+      CHECK_GT(args.size(), static_cast<int>(bucket_info_.arg_idx)) << "Too few args for " << kernel_name_;
+      const DLTensor *arg = args[static_cast<int>(bucket_info_.arg_idx)];
+      CHECK_GT(arg->ndim, static_cast<int>(bucket_info_.dim));
+      int64_t extent = arg->shape[bucket_info_.dim];
+      // the launch dims are computed from the extent by the host code of the kernel of the bucket
+      funcs_[SelectShapeBucket(bucket_info_.bounds, extent)].CallPacked(args, rv);
+    });
+  }
+
+ private:
+  std::string kernel_name_;
+  ShapeBucketInfo bucket_info_;
+  std::vector<PackedFunc> funcs_;
+};
+}  // namespace
+
+ShapeBucketInfo GetShapeBucketInfo(const BuildInfo &info, const Map<std::string, NodeRef> &attrs) {
+  CHECK(attrs.find(kShapeBuckets) != attrs.end());
+  CHECK_EQ(info.shape_vars.size(), 1) << "Shape buckets need a single named dim in the shapes of "
+                                      << info.kernel_name << ", but got " << info.shape_vars;
+  ShapeBucketInfo bucket_info;
+  bucket_info.shape_var = info.shape_vars[0];
+  for (const auto &bound : Downcast<Array<Integer>>(attrs[kShapeBuckets])) {
+    CHECK_GT(bound->value, 0) << "Invalid upper bound of shape bucket: " << bound;
+    bucket_info.bounds.push_back(bound->value);
+  }
+  CHECK(!bucket_info.bounds.empty()) << "No shape bucket is given for " << info.kernel_name;
+  std::sort(bucket_info.bounds.begin(), bucket_info.bounds.end());
+  bucket_info.bounds.erase(std::unique(bucket_info.bounds.begin(), bucket_info.bounds.end()),
+                           bucket_info.bounds.end());
+
+  for (size_t i = 0; i < info.args.size(); ++i) {
+    auto tensor = info.args[i].as<TensorNode>();
+    if (tensor == nullptr) {
+      continue;
+    }
+    for (size_t j = 0; j < tensor->shape.size(); ++j) {
+      if (tensor->shape[j].same_as(bucket_info.shape_var)) {
+        bucket_info.arg_idx = i;
+        bucket_info.dim = j;
+        return bucket_info;
+      }
+    }
+  }
+  LOG(FATAL) << "The named dim " << bucket_info.shape_var << " is not a dim of any arg of " << info.kernel_name;
+  return bucket_info;
+}
+
+size_t SelectShapeBucket(const std::vector<int64_t> &bounds, int64_t extent) {
+  auto it = std::lower_bound(bounds.begin(), bounds.end(), extent);
+  CHECK(it != bounds.end()) << "Extent " << extent << " exceeds the largest shape bucket " << bounds.back();
+  return static_cast<size_t>(it - bounds.begin());
+}
+
+std::string ShapeBucketKernelName(const std::string &kernel_name, int64_t bound) {
+  return kernel_name + "_b" + std::to_string(bound);
+}
+
+Map<std::string, NodeRef> ShapeBucketAttrs(const Map<std::string, NodeRef> &attrs, int64_t bound) {
+  Map<std::string, NodeRef> bucket_attrs;
+  for (const auto &it : attrs) {
+    if (it.first != kShapeBuckets) {
+      bucket_attrs.Set(it.first, it.second);
+    }
+  }
+  bucket_attrs.Set(kDynamicShapeBound, Integer(static_cast<int>(bound)));
+  return bucket_attrs;
+}
+
+Module ShapeBucketModule(const std::string &kernel_name, const ShapeBucketInfo &bucket_info,
+                         const std::vector<Module> &variants) {
+  auto n = air::make_object<ShapeBucketModuleNode>(kernel_name, bucket_info, variants);
+  // Only the device modules are imported, so imported_modules[0] is still a cuda module for the callers that launch
+  // or dump the kernel through it. The host modules are kept alive by the packed funcs of the buckets.
+  for (const auto &variant : variants) {
+    for (const auto &dev : variant->imports()) {
+      n->Import(dev);
+    }
+  }
+  return Module(n);
+}
+
+namespace {
+// the bounds are ascending
+int SelectShapeBucketOf(const Array<Integer> &bounds, int64_t extent) {
+  std::vector<int64_t> values;
+  for (const auto &bound : bounds) {
+    values.push_back(bound->value);
+  }
+  return static_cast<int>(SelectShapeBucket(values, extent));
+}
+}  // namespace
+
+TVM_REGISTER_GLOBAL("select_shape_bucket").set_body_typed(SelectShapeBucketOf);
+}  // namespace akg
@@ -0,0 +1,49 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef AKG_SRC_COMPOSITE_SHAPE_BUCKET_H_
+#define AKG_SRC_COMPOSITE_SHAPE_BUCKET_H_
+#include <string>
+#include <vector>
+
+#include "composite/util.h"
+
+namespace akg {
+/*
+ * A cuda graph whose shapes hold a named dim, e.g. "shape": [8, "seq_len", 1024], can be compiled once per
+ * shape bucket instead of once per extent of the dim. The "shape_buckets" attr lists the upper bounds of the
+ * buckets: the kernel of a bucket keeps the dim symbolic, is tiled for the bound of the bucket and takes any
+ * extent up to it. A dispatcher module picks the kernel of the runtime extent at launch.
+ */
+constexpr auto kShapeBuckets = "shape_buckets";
+
+struct ShapeBucketInfo {
+  Var shape_var;                // the symbolic extent of the buckets
+  std::vector<int64_t> bounds;  // the upper bounds of the buckets, ascending
+  size_t arg_idx{0};            // the kernel arg whose shape holds the extent at launch
+  size_t dim{0};
+};
+
+ShapeBucketInfo GetShapeBucketInfo(const BuildInfo &info, const Map<std::string, NodeRef> &attrs);
+// Returns the smallest bucket that holds the extent.
+size_t SelectShapeBucket(const std::vector<int64_t> &bounds, int64_t extent);
+std::string ShapeBucketKernelName(const std::string &kernel_name, int64_t bound);
+// The attrs of the kernel of a bucket, which bound its shape params for poly
+Map<std::string, NodeRef> ShapeBucketAttrs(const Map<std::string, NodeRef> &attrs, int64_t bound);
+// The module of the kernel name, calling the module of the bucket of its extent, one per bucket.
+Module ShapeBucketModule(const std::string &kernel_name, const ShapeBucketInfo &bucket_info,
+                         const std::vector<Module> &variants);
+}  // namespace akg
+#endif  // AKG_SRC_COMPOSITE_SHAPE_BUCKET_H_
@@ -20,6 +20,109 @@
 #include <fstream>
 
 namespace akg {
+/*
+ * The live range of a stitch buffer is the span of stitched irs that access it. The irs are only separated
+ * by the barrier at their end, so two buffers can share bytes of the pool only when no ir accesses both of
+ * them: a buffer written by one ir may still be read by another thread of the same ir.
+ */
+class StitchLiveness : public IRVisitor {
+ public:
+  StitchLiveness(std::vector<StitchBufferInterval> &intervals,
+                 const std::unordered_map<std::string, std::string> &aliases)
+      : intervals_(intervals) {
+    for (size_t i = 0; i < intervals_.size(); ++i) {
+      index_[intervals_[i].name] = i;
+      auto it = aliases.find(intervals_[i].name);
+      if (it != aliases.end()) {
+        index_[it->second] = i;
+      }
+    }
+  }
+  ~StitchLiveness() override = default;
+
+  void Run(const std::vector<Stmt> &stitch_irs) {
+    for (const auto &ir : stitch_irs) {
+      Visit(ir);
+      ++ir_idx_;
+    }
+    // a buffer never touched by the irs is kept alive through the whole kernel
+    for (size_t i = 0; i < intervals_.size(); ++i) {
+      if (!seen_.count(i)) {
+        intervals_[i].start = 0;
+        intervals_[i].end = ir_idx_;
+      }
+    }
+  }
+
+ private:
+  void Visit_(const Store *op) final {
+    IRVisitor::Visit_(op);
+    Touch(op->buffer_var->name_hint);
+  }
+
+  void Visit_(const Load *op) final {
+    Touch(op->buffer_var->name_hint);
+    IRVisitor::Visit_(op);
+  }
+
+  void Touch(const std::string &name) {
+    auto it = index_.find(name);
+    if (it == index_.end()) return;
+    auto &interval = intervals_[it->second];
+    if (seen_.insert(it->second).second) {
+      interval.start = ir_idx_;
+      interval.end = ir_idx_;
+    } else {
+      interval.start = std::min(interval.start, ir_idx_);
+      interval.end = std::max(interval.end, ir_idx_);
+    }
+  }
+
+  std::vector<StitchBufferInterval> &intervals_;
+  std::unordered_map<std::string, size_t> index_;
+  std::unordered_set<size_t> seen_;
+  size_t ir_idx_{0};
+};
+
+void StitchBufferLiveness(const std::vector<Stmt> &stitch_irs, std::vector<StitchBufferInterval> &intervals,
+                          const std::unordered_map<std::string, std::string> &aliases) {
+  StitchLiveness(intervals, aliases).Run(stitch_irs);
+}
+
+uint64_t AssignStitchBufferOffsets(std::vector<StitchBufferInterval> &intervals, uint64_t align) {
+  CHECK_GT(align, 0);
+  auto align_up = [align](uint64_t x) { return (x + align - 1) / align * align; };
+  // place the largest buffers first, each at the lowest aligned offset free during its live range
+  std::vector<size_t> order(intervals.size());
+  for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+  std::sort(order.begin(), order.end(), [&intervals](size_t a, size_t b) {
+    if (intervals[a].size != intervals[b].size) return intervals[a].size > intervals[b].size;
+    return intervals[a].start < intervals[b].start;
+  });
+  std::vector<size_t> placed;
+  uint64_t total = 0;
+  for (auto idx : order) {
+    auto &cur = intervals[idx];
+    std::vector<size_t> conflicts;
+    for (auto p : placed) {
+      if (intervals[p].start <= cur.end && cur.start <= intervals[p].end) {
+        conflicts.push_back(p);
+      }
+    }
+    std::sort(conflicts.begin(), conflicts.end(),
+              [&intervals](size_t a, size_t b) { return intervals[a].offset < intervals[b].offset; });
+    uint64_t offset = 0;
+    for (auto c : conflicts) {
+      if (offset + cur.size <= intervals[c].offset) break;
+      offset = std::max(offset, align_up(intervals[c].offset + intervals[c].size));
+    }
+    cur.offset = offset;
+    total = std::max(total, offset + cur.size);
+    placed.push_back(idx);
+  }
+  return total;
+}
+
 Var GetReplaceVar(const Var &var, std::unordered_map<std::string, Var> &vars, const std::string &name,
                   const StitchBufferInfo &info) {
   Var replace;
@@ -37,11 +140,9 @@ class StitchMutate : public IRMutator {
  public:
   explicit StitchMutate(std::unordered_map<std::string, StitchBufferInfo> &stitch_buffer_map,
                         std::unordered_map<std::string, StitchBufferInfo> &buf_within_op_map,
-                        std::vector<std::string> &allocate_revoke, StitchAttrInfo &store_attr,
-                        const std::unordered_map<std::string, NodeRef> &real_outputs)
+                        StitchAttrInfo &store_attr, const std::unordered_map<std::string, NodeRef> &real_outputs)
       : stitch_buffer_map_(stitch_buffer_map),
         buf_within_op_map_(buf_within_op_map),
-        allocate_revoke_(allocate_revoke),
         store_attr_(store_attr),
         real_outputs_(real_outputs) {}
 
@@ -107,9 +208,20 @@ class StitchMutate : public IRMutator {
       }
       return this->Mutate(op->body);
     }
+    // the in-op copy of a pooled buffer lives in the pool
+    if (op->attr_key == air::ir::attr::storage_scope && op->node.as<Variable>() &&
+        IsPooledInOp(op->node.as<Variable>()->name_hint)) {
+      return this->Mutate(op->body);
+    }
     return IRMutator::Mutate_(op, s);
   }
 
+  bool IsPooledInOp(const std::string &name) {
+    auto it = stitch_buffer_map_.find(name);
+    return buf_within_op_map_.count(name) && it != stitch_buffer_map_.end() &&
+           it->second.type == StorageType::Shared && it->second.buf_name == STITCH_SHARED_POOL;
+  }
+
   Stmt Mutate_(const Allocate *op, const Stmt &s) final {
     const Variable *buf = op->buffer_var.get();
     std::string name = buf->name_hint;
@@ -118,14 +230,17 @@ class StitchMutate : public IRMutator {
         vars_[name] = op->buffer_var;
       }
     }
-    for (auto &var_revoke : allocate_revoke_) {
-      if (name == var_revoke) {
-        return this->Mutate(op->body);
-      }
+    if (IsPooledInOp(name)) {
+      return this->Mutate(op->body);
     }
     return IRMutator::Mutate_(op, s);
   }
 
+  static Expr AddOffset(const Expr &index, uint64_t offset) {
+    if (offset == 0) return index;
+    return index + make_const(index.type(), offset);
+  }
+
   bool IsOutput(const std::string &name) {
     for (auto &kv : real_outputs_) {
       if (name == kv.second.as<BufferNode>()->name) {
@@ -144,10 +259,15 @@ class StitchMutate : public IRMutator {
         bool new_buffer = !vars_.count(shared_name);
         Var shared = new_buffer ? Var(shared_name) : vars_[shared_name];
         vars_[shared_name] = shared;
-        stitch_buffer_map_[shared_name] = info;
         rm_block_ = true;
-        auto index = this->Mutate(op->index);
+        auto index = AddOffset(this->Mutate(op->index), info.offset);
         rm_block_ = false;
+        // buffers sharing a pool keep the size of the pool
+        auto it = stitch_buffer_map_.find(shared_name);
+        if (it != stitch_buffer_map_.end() && it->second.alloc_size > info.alloc_size) {
+          info = it->second;
+        }
+        stitch_buffer_map_[shared_name] = info;
         auto stmt = Store::make(shared, this->Mutate(op->value), index, op->predicate);
         if (new_buffer) new_allocate_.insert(stmt.as<Store>());
         return stmt;
@@ -170,7 +290,7 @@ class StitchMutate : public IRMutator {
         Var replace = GetReplaceVar(var, vars_, kv.first, info);
         if (info.type == StorageType::Shared) {
           rm_block_ = true;
-          index = this->Mutate(index);
+          index = AddOffset(this->Mutate(index), info.offset);
           rm_block_ = false;
           return Load::make(op->type, replace, index, op->predicate);
         }
@@ -204,7 +324,6 @@ class StitchMutate : public IRMutator {
   bool rm_block_{false};
   std::unordered_map<std::string, StitchBufferInfo> &stitch_buffer_map_;
   std::unordered_map<std::string, StitchBufferInfo> &buf_within_op_map_;
-  std::vector<std::string> &allocate_revoke_;
   StitchAttrInfo &store_attr_;
   std::unordered_map<std::string, Var> vars_;
   std::unordered_map<std::string, NodeRef> real_outputs_;
@@ -333,11 +452,10 @@ IrAttrInfo GetIRAttr(StitchOpType type, BufferStitchAttr &stitch_attr_info, std:
 Stmt StitchFusionGpu(std::vector<Stmt> &stitch_irs, const std::string &kernel_name, StitchAttrInfo &store_attr,
                      std::unordered_map<std::string, StitchBufferInfo> &stitch_buffer_map,
                      std::unordered_map<std::string, StitchBufferInfo> &buf_within_op_map,
-                     std::vector<std::string> &allocate_revoke,
                      const std::unordered_map<std::string, NodeRef> &real_outputs) {
-  DumpStitchInfo(kernel_name, store_attr, stitch_buffer_map, buf_within_op_map, allocate_revoke);
+  DumpStitchInfo(kernel_name, store_attr, stitch_buffer_map, buf_within_op_map);
   DumpStmt2File("stitch_info/" + kernel_name + "_before_stitch.cc", Block::make(stitch_irs));
-  auto func = StitchMutate(stitch_buffer_map, buf_within_op_map, allocate_revoke, store_attr, real_outputs);
+  auto func = StitchMutate(stitch_buffer_map, buf_within_op_map, store_attr, real_outputs);
   CHECK(stitch_irs.size() > 1);
   size_t i = 0;
   for (auto &ir : stitch_irs) {
@@ -26,13 +26,15 @@ struct StitchBufferInfo {
   StorageType type{StorageType::Unknown};
   std::string buf_name;
   uint64_t alloc_size = 0;
+  uint64_t offset = 0;
 };
 inline std::ostream &operator<<(std::ostream &os, const StitchBufferInfo &x) {
   os << "StitchBufferInfo: \n"
      << "name: " << x.name << "\n"
      << "type: " << static_cast<int>(x.type) << "\n"
      << "buf_name: " << x.buf_name << "\n"
-     << "alloc_size: " << x.alloc_size << "\n";
+     << "alloc_size: " << x.alloc_size << "\n"
+     << "offset: " << x.offset << "\n";
   return os;
 }
 
@@ -50,6 +52,23 @@ struct IrAttrInfo {
   Expr elemwise_size{0};
 };
 
+constexpr auto STITCH_SHARED_POOL = "stitch_shared_pool";
+constexpr uint64_t STITCH_ALIGN_BYTES = 32;
+
+// live range of a stitch buffer as the first and last stitched ir accessing it, and its offset in the shared pool.
+struct StitchBufferInterval {
+  std::string name;
+  uint64_t size{0};
+  size_t start{0};
+  size_t end{0};
+  uint64_t offset{0};
+};
+
+// aliases maps a buffer to its in-op copy, whose accesses keep the buffer alive as well
+void StitchBufferLiveness(const std::vector<Stmt> &stitch_irs, std::vector<StitchBufferInterval> &intervals,
+                          const std::unordered_map<std::string, std::string> &aliases = {});
+uint64_t AssignStitchBufferOffsets(std::vector<StitchBufferInterval> &intervals, uint64_t align);
+
 class StitchBufAlloc : public IRVisitor {
  public:
   StitchBufAlloc(const std::vector<Stmt> &stitch_irs, const Map<std::string, Array<NodeRef>> &alloc_map,
@@ -96,115 +115,124 @@ class StitchBufAlloc : public IRVisitor {
       stitch_buffer_map[ir_var] = info;
     }
 
-    for (const auto &it : alloc_map_) {
-      std::string name = it.first;
-      auto alloc_info = it.second[0].as<StringImm>()->value;
-      CHECK_GT(total_block_, 0);
-      uint64_t alloc_size_per_block = it.second[1].as<IntImm>()->value / total_block_;
-      // first, check whether variable is already in buf_within_op_map. If NOT, do allocation or reuse.
+    PlanSharedBuffers();
+  }
+
+  // Stitch buffers that are not promoted inside their ops share one pool. Their offsets come from colouring
+  // the live ranges over the stitched irs, and buffers go back to global memory until the pool fits. A reuse
+  // entry promoted inside its op takes its in-op copy into its slot, which drops the in-op allocation.
+  void PlanSharedBuffers() {
+    CHECK_GT(total_block_, 0);
+    auto bytes = static_cast<uint64_t>(data_type_.bytes());
+    uint64_t map_shared_size = 0;
+    std::vector<StitchBufferInterval> pool;
+    // the in-op copies taken into the pool and their bytes
+    std::unordered_map<std::string, std::string> in_op_names;
+    std::unordered_map<std::string, uint64_t> in_op_bytes;
+    uint64_t pooled_in_op_bytes = 0;
+    auto add_buffer = [this, bytes, &map_shared_size, &pool, &in_op_names, &in_op_bytes, &pooled_in_op_bytes](
+                        const std::string &name, int64_t size, bool is_alloc) {
       CHECK(outputs2args_.find(name) != outputs2args_.end());
       std::string ir_var = outputs2args_.at(name).as<BufferNode>()->name;
       std::string shared_name = ir_var + "_shared";
-      std::string ir_var_shared;
-      if (buf_within_op_map.find(shared_name) != buf_within_op_map.end()) {
-        ir_var_shared = shared_name;
-      } else {
-        allocated_share_size_ += alloc_size_per_block * data_type_.bytes();
-        ir_var_shared = ir_var + "_shared_stitch";
-      }
-
       StitchBufferInfo info;
       info.name = name;
       info.type = StorageType::Shared;
-      info.buf_name = ir_var_shared;
-      info.alloc_size = alloc_size_per_block;
+      info.alloc_size = static_cast<uint64_t>(size) / total_block_;
+      auto in_op = buf_within_op_map.find(shared_name);
+      if (is_alloc && in_op != buf_within_op_map.end()) {
+        info.buf_name = shared_name;
+        stitch_buffer_map[ir_var] = info;
+        return;
+      }
+      // footprint of the maps: every ALLOC entry gets its own buffer and reuse entries are folded into them
+      map_shared_size += is_alloc ? info.alloc_size * bytes : 0;
+      info.buf_name = STITCH_SHARED_POOL;
+      StitchBufferInterval interval;
+      interval.name = ir_var;
+      interval.size = info.alloc_size;
+      if (in_op != buf_within_op_map.end()) {
+        interval.size = std::max(interval.size, in_op->second.alloc_size);
+        in_op_names[ir_var] = shared_name;
+        in_op_bytes[ir_var] = shared_bytes_[shared_name];
+        pooled_in_op_bytes += shared_bytes_[shared_name];
+      }
       stitch_buffer_map[ir_var] = info;
-      buf_alloc_op_[ir_var] = info;
+      pool.push_back(interval);
+    };
+    for (const auto &it : alloc_map_) {
+      if (it.first == "EMPTY") continue;
+      add_buffer(it.first, it.second[1].as<IntImm>()->value, true);
     }
-
     for (const auto &it : reuse_map_) {
-      std::string name = it.first;
-      if (name == "EMPTY") {
-        break;
-      }
-      auto alloc_info = it.second[0].as<StringImm>()->value;
-      uint64_t alloc_size_per_block = it.second[1].as<IntImm>()->value / total_block_;
-      CHECK(outputs2args_.find(alloc_info) != outputs2args_.end());
-      CHECK(outputs2args_.find(name) != outputs2args_.end());
-      auto ir_var_reuse = outputs2args_.at(alloc_info).as<BufferNode>()->name;
-      auto ir_var = outputs2args_.at(name).as<BufferNode>()->name;
-      auto alloc_stitch_info = buf_alloc_op_[ir_var_reuse];
-      std::string shared_name = ir_var + "_shared";
-
-      bool can_reuse = true;
-      for (auto &kv : store_load_) {
-        if (shared_name != kv.first->buffer_var->name_hint) continue;
-        for (auto &item : kv.second) {
-          if (alloc_info == item->buffer_var->name_hint) can_reuse = false;
-        }
-      }
+      if (it.first == "EMPTY") continue;
+      add_buffer(it.first, it.second[1].as<IntImm>()->value, false);
+    }
+    if (pool.empty()) return;
 
-      if (can_reuse && buf_within_op_map.find(shared_name) != buf_within_op_map.end()) {
-        // add replaced buffer into stitch_buffer_map.
-        if (allocated_share_size_ >= alloc_size_per_block * data_type_.bytes()) {
-          StitchBufferInfo info;
-          info.name = name;
-          info.type = StorageType::Shared;
-          info.buf_name = alloc_stitch_info.buf_name;
-          info.alloc_size = alloc_size_per_block;
-          stitch_buffer_map[shared_name] = info;
-          // remember to reduce allocated_share_size_ due to reuse.
-          allocated_share_size_ -= alloc_size_per_block * data_type_.bytes();
-          allocate_revoke.push_back(shared_name);
+    StitchBufferLiveness(stitch_irs_, pool, in_op_names);
+    uint64_t align = std::max<uint64_t>(STITCH_ALIGN_BYTES / bytes, 1);
+    uint64_t pool_size = AssignStitchBufferOffsets(pool, align);
+    // the shared memory left for the pool, when the in-op copies of the pooled buffers are dropped
+    auto limit_of = [this, bytes](uint64_t dropped_bytes) -> uint64_t {
+      uint64_t used = allocated_share_size_ - dropped_bytes;
+      return MEM_LIMIT > used ? (MEM_LIMIT - used) / bytes : 0;
+    };
+    auto in_op_bytes_of = [&in_op_bytes](const std::string &name) -> uint64_t {
+      auto it = in_op_bytes.find(name);
+      return it == in_op_bytes.end() ? 0 : it->second;
+    };
+    uint64_t global_size = 0;
+    while (!pool.empty() && pool_size > limit_of(pooled_in_op_bytes)) {
+      // move out the smallest buffer that makes the pool fit, otherwise the one that shrinks it the most
+      size_t moveout = 0;
+      uint64_t moveout_rest = pool_size;
+      bool moveout_fits = false;
+      for (size_t i = 0; i < pool.size(); ++i) {
+        auto rest = pool;
+        rest.erase(rest.begin() + i);
+        uint64_t rest_size = AssignStitchBufferOffsets(rest, align);
+        // a buffer moved out keeps its in-op copy
+        bool fits = rest_size <= limit_of(pooled_in_op_bytes - in_op_bytes_of(pool[i].name));
+        bool better = fits ? (!moveout_fits || pool[i].size < pool[moveout].size)
+                           : (!moveout_fits && rest_size < moveout_rest);
+        if (better) {
+          moveout = i;
+          moveout_rest = rest_size;
+          moveout_fits = fits;
         }
       }
+      auto &info = stitch_buffer_map[pool[moveout].name];
+      info.type = StorageType::Global;
+      info.buf_name = pool[moveout].name + "_global";
+      global_size += pool[moveout].size * bytes;
+      pooled_in_op_bytes -= in_op_bytes_of(pool[moveout].name);
+      in_op_names.erase(pool[moveout].name);
+      pool.erase(pool.begin() + moveout);
+      pool_size = AssignStitchBufferOffsets(pool, align);
+    }
+    for (const auto &interval : pool) {
+      stitch_buffer_map[interval.name].offset = interval.offset;
+    }
+    // the accesses of the in-op copies go to the slot of their buffer
+    for (const auto &it : in_op_names) {
+      stitch_buffer_map[it.second] = stitch_buffer_map[it.first];
+    }
+    allocated_share_size_ -= pooled_in_op_bytes;
+    if (!pool.empty()) {
       StitchBufferInfo info;
-      info.name = name;
+      info.name = STITCH_SHARED_POOL;
       info.type = StorageType::Shared;
-      info.buf_name = alloc_stitch_info.buf_name;
-      info.alloc_size = alloc_size_per_block;
-      stitch_buffer_map[ir_var] = info;
-      buf_alloc_op_.erase(ir_var_reuse);
-    }
-
-    if (allocated_share_size_ >= MEM_LIMIT) {
-      std::vector<std::pair<std::string, StitchBufferInfo>> reuse_free_map(buf_alloc_op_.begin(), buf_alloc_op_.end());
-      std::sort(reuse_free_map.begin(), reuse_free_map.end(),
-                [=](std::pair<std::string, StitchBufferInfo> &a, std::pair<std::string, StitchBufferInfo> &b) -> bool {
-                  return (a.second.alloc_size > b.second.alloc_size);
-                });
-      auto overflow_size = allocated_share_size_ - MEM_LIMIT;
-      bool cover_overflow_size = false;
-      std::string moveout_var;
-      for (const auto &iv : reuse_free_map) {
-        if (iv.second.alloc_size * data_type_.bytes() >= overflow_size) {
-          moveout_var = iv.first;
-          cover_overflow_size = true;
-        } else {
-          break;
-        }
-      }
-
-      if (cover_overflow_size) {
-        auto moveout_info = stitch_buffer_map[moveout_var];
-        moveout_info.type = StorageType::Global;
-        moveout_info.buf_name = moveout_info.buf_name + "_global";
-        stitch_buffer_map[moveout_var] = moveout_info;
-      }
-      if (!cover_overflow_size) {
-        auto covered_size = 0;
-        for (const auto &iv : reuse_free_map) {
-          auto moveout_info = stitch_buffer_map[iv.first];
-          covered_size += iv.second.alloc_size;
-          moveout_info.type = StorageType::Global;
-          moveout_info.buf_name = moveout_info.buf_name + "_global";
-          stitch_buffer_map[iv.first].type = StorageType::Global;
-          if (static_cast<uint64_t>(covered_size) >= overflow_size) {
-            break;
-          }
-        }
-      }
+      info.buf_name = STITCH_SHARED_POOL;
+      info.alloc_size = pool_size;
+      stitch_buffer_map[STITCH_SHARED_POOL] = info;
+      allocated_share_size_ += pool_size * bytes;
     }
+    LOG(DEBUG) << "Stitch buffer plan: shared pool " << pool_size * bytes << " bytes for " << pool.size()
+               << " buffers (" << pooled_in_op_bytes << " bytes of in-op copies dropped), maps need "
+               << map_shared_size << " bytes (saved "
+               << static_cast<int64_t>(map_shared_size) - static_cast<int64_t>(pool_size * bytes) << "), "
+               << global_size << " bytes moved to global";
   }
 
   void Dump() {
@@ -225,7 +253,6 @@ class StitchBufAlloc : public IRVisitor {
  public:
   std::unordered_map<std::string, StitchBufferInfo> buf_within_op_map;
   std::unordered_map<std::string, StitchBufferInfo> stitch_buffer_map;
-  std::vector<std::string> allocate_revoke;
 
  private:
   void Visit_(const AttrStmt *op) final {
@@ -250,6 +277,7 @@ class StitchBufAlloc : public IRVisitor {
       CHECK_GE(op->constant_allocation_size(), 0) << "allocation size < 0";
       auto size = static_cast<uint64_t>(op->constant_allocation_size());
       allocated_share_size_ += size * op->type.bytes();
+      shared_bytes_[name] = size * op->type.bytes();
       StitchBufferInfo info;
       info.name = name;
       info.type = StorageType::Shared;
@@ -262,16 +290,6 @@ class StitchBufAlloc : public IRVisitor {
     IRVisitor::Visit(op->body);
   }
 
-  void Visit_(const Store *op) final {
-    collect_load_ = true;
-    IRVisitor::Visit(op->value);
-    store_load_[op] = loads_;
-    loads_.clear();
-    collect_load_ = false;
-  }
-
-  void Visit_(const Load *op) final { loads_.emplace_back(op); }
-
  private:
   std::vector<Stmt> stitch_irs_;
   Map<std::string, Array<NodeRef>> alloc_map_;
@@ -279,14 +297,11 @@ class StitchBufAlloc : public IRVisitor {
   Map<std::string, Array<NodeRef>> global_stitch_;
   std::unordered_map<std::string, NodeRef> outputs2args_;
   air::DataType data_type_;
-  std::unordered_map<std::string, StitchBufferInfo> buf_alloc_op_;
-  bool collect_load_{false};
-  std::vector<const Load *> loads_;
-  std::unordered_map<const Store *, std::vector<const Load *>> store_load_;
   int ir_idx_ = 0;
   int total_block_ = 0;
   int block_extent_ = 1;
   uint64_t allocated_share_size_ = 0;
+  std::unordered_map<std::string, uint64_t> shared_bytes_;
   bool gather_shared_ = false;
 };
 
@@ -374,7 +389,6 @@ IrAttrInfo GetIRAttr(StitchOpType type, BufferStitchAttr &stitch_attr_info, std:
 Stmt StitchFusionGpu(std::vector<Stmt> &stitch_irs, const std::string &kernel_name, StitchAttrInfo &store_attr,
                      std::unordered_map<std::string, StitchBufferInfo> &stitch_buffer_map,
                      std::unordered_map<std::string, StitchBufferInfo> &buf_within_op_map,
-                     std::vector<std::string> &allocate_revoke,
                      const std::unordered_map<std::string, NodeRef> &real_outputs);
 }  // namespace akg
 
@@ -19,8 +19,10 @@
 
 #include <string>
 #include <exception>
+#include <memory>
 
 #include "codegen/util.h"
+#include "poly/schedule_pass/computed_schedule_cache.h"
 
 namespace akg {
 extern AttrMap g_attrs;
@@ -46,12 +48,14 @@ class MemoryAllocationException : public std::exception {
   uint64_t alloc_bits_{0};
 };
 
+class LoweredPrefix;
+
 NodeRef LowerStmt(Schedule sch, const Array<NodeRef> &in_args, const Array<NodeRef> &shape_vars,
                   const std::string &name, const Map<Tensor, Buffer> &in_binds,
                   const Map<std::string, NodeRef> &in_attrs, bool simple_mode, bool polyhedral, bool tuning,
                   const std::string &target, const BuildConfig &config, Array<NodeRef> *args,
                   Array<NodeRef> *arg_list_0, Map<Tensor, Buffer> *binds, Map<Tensor, Buffer> *binds_0,
-                  std::vector<size_t> *split_index, bool lower_list = false);
+                  std::vector<size_t> *split_index, bool lower_list = false, LoweredPrefix *prefix = nullptr);
 
 NodeRef LowerFunc(Stmt &stmt, const std::string &name, const BuildConfig &config, const Array<NodeRef> &all_args);
 
@@ -96,6 +100,54 @@ class BuildRst : public NodeRef {
   TVM_DEFINE_NODE_REF_METHODS(BuildRst, NodeRef, BuildRstNode);
 };
 
+/*
+ * The gpu lowering result right before the polyhedral pass. Tuning candidates of one kernel only
+ * differ in tiling and mapping attrs, so they are all compiled from the same prefix.
+ */
+class LoweredPrefixNode : public Node {
+ public:
+  Stmt stmt;
+  Schedule sch;
+  Array<NodeRef> arg_list_0;
+  Map<Tensor, Buffer> binds_0;
+  Map<std::string, NodeRef> attrs;
+  std::string name;
+  std::string target;
+  // the schedules computed by the candidates built from this prefix, not visited
+  std::shared_ptr<ir::poly::ComputedScheduleCache> schedule_cache;
+
+  TVM_DLL static LoweredPrefix make(const Stmt &stmt, const Schedule &sch, const Array<NodeRef> &arg_list_0,
+                                    const Map<Tensor, Buffer> &binds_0, const Map<std::string, NodeRef> &attrs,
+                                    const std::string &name, const std::string &target);
+
+  void VisitAttrs(AttrVisitor *v) {
+    v->Visit("stmt", &stmt);
+    v->Visit("sch", &sch);
+    v->Visit("arg_list_0", &arg_list_0);
+    v->Visit("binds_0", &binds_0);
+    v->Visit("attrs", &attrs);
+    v->Visit("name", &name);
+    v->Visit("target", &target);
+  }
+
+  static constexpr const char *_type_key = "LoweredPrefix";
+  TVM_DECLARE_BASE_NODE_INFO(LoweredPrefixNode, Node);
+};
+
+class LoweredPrefix : public NodeRef {
+ public:
+  ~LoweredPrefix() = default;
+  TVM_DEFINE_NODE_REF_METHODS(LoweredPrefix, NodeRef, LoweredPrefixNode);
+};
+
+LoweredPrefix LowerToPrefix(const Schedule &sch, const Array<NodeRef> &in_args, const Array<NodeRef> &shape_vars,
+                            const std::string &name, const Map<Tensor, Buffer> &in_binds,
+                            const Map<std::string, NodeRef> &in_attrs, const std::string &target,
+                            const BuildConfig &config);
+
+BuildRst BuildFromPrefix(const LoweredPrefix &prefix, const Map<std::string, NodeRef> &candidate_attrs,
+                         const BuildConfig &config);
+
 // Keep LowerStage continuous!
 enum LowerStage : int16_t {
   BEGIN = 0,
@@ -191,6 +191,43 @@ Stmt UnrollNonConstantExtent(Stmt s);
 
 Stmt ValueNumbering(Stmt stmt);
 
+/*!
+ * \brief Number the integer index expressions of GPU kernels across statements, binding each one
+ *  at the outermost loop where it is invariant so that it is shared by all its occurrences.
+ */
+Stmt GlobalValueNumbering(const Stmt &stmt);
+
+/*!
+ * \brief Carry the quotient and remainder of divisions affine in a serial loop var across iterations
+ *  instead of recomputing them in every iteration. Loops marked with pragma_unroll are left to the unroller.
+ */
+Stmt StrengthReduceDivMod(const Stmt &stmt);
+
+/*!
+ * \brief Merge the constant shared memory allocations of each GPU kernel into one arena, letting buffers
+ *  with disjoint lifetimes share bytes.
+ */
+Stmt PackSharedMemory(const Stmt &stmt);
+
+/*!
+ * \brief Split the K loop of a tensor core GEMM kernel among split blocks on blockIdx.z, each adding its
+ *  partial result to the output with atomicAdd. The output is zeroed by a kernel launched before the GEMM.
+ */
+Stmt SplitKGemm(const Stmt &stmt, const Map<Tensor, Buffer> &extern_buffer, int split);
+
+/*!
+ * \brief Count the barriers written in the statement by scope ("shared", "warp" and "global"). Barriers inside
+ *  loops are counted once.
+ */
+Map<std::string, Integer> CountBarriers(const Stmt &stmt);
+
+/*!
+ * \brief Choose a full, partial or no unroll for the innermost serial loops of GPU kernels from an estimate of
+ *  the registers live in their bodies, marking each loop with pragma_unroll. A register_cap of 0 derives the
+ *  cap of each kernel from its block size and the device.
+ */
+Stmt PlanGpuUnroll(const Stmt &stmt, int register_cap);
+
 Stmt TensorAccessRewrite(const Stmt stmt);
 
 Stmt SwizzleGPU(const Stmt &stmt, const Map<std::string, NodeRef> &attrs);
@@ -23,7 +23,7 @@
 
 namespace akg {
 namespace schedule {
-TVM_DLL void AutoInline(air::Schedule sch, const air::Target &target, bool enable_cse);
+TVM_DLL std::string AutoInline(air::Schedule sch, const air::Target &target, bool enable_cse, bool enable_cost_model);
 
 TVM_DLL void AutoFuse(air::Schedule sch, const std::string &split_str, std::vector<size_t> &split_index);
 }  // namespace schedule
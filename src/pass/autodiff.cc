@@ -22,11 +22,13 @@
 namespace akg {
 namespace ir {
 DifferentiationResult DifferentiationResultNode::make(Array<Tensor> result, Map<Tensor, Tensor> adjoints,
-                                                      Map<Tensor, Map<Tensor, Tensor>> summands) {
+                                                      Map<Tensor, Map<Tensor, Tensor>> summands,
+                                                      Map<std::string, NodeRef> attrs) {
   auto n = make_node<DifferentiationResultNode>();
   n->result = std::move(result);
   n->adjoints = std::move(adjoints);
   n->adjoint_summands = std::move(summands);
+  n->attrs = std::move(attrs);
   return DifferentiationResult(n);
 }
 
@@ -364,6 +366,8 @@ DifferentiationResult Differentiate(const Tensor &output, const Array<Tensor> &i
     LOG(FATAL) << "output is a null pointer.";
     return DifferentiationResult();
   }
+  // share the results of SuperSimplify among all the adjoints of this differentiation
+  SuperSimplifyScope super_simplify_scope;
 
   Tensor head = head_or_null;
 
@@ -483,14 +487,28 @@ DifferentiationResult Differentiate(const Tensor &output, const Array<Tensor> &i
   }
 
   bool tensor_optimize_ = (in_attrs.GetInt("tensor_optimize", 0) != 0);
-  if (!tensor_optimize_) {
-    return DifferentiationResultNode::make(result, adjoints, summands);
-  } else {  // Running TIL optimization passes
+  if (tensor_optimize_) {  // Running TIL optimization passes
     Array<Tensor> optimized_result;
     ADOptimizePasses(result, optimized_result, attrs, new_pld_array);
-    // AD FINISHED... Returning to Poly
-    return DifferentiationResultNode::make(optimized_result, adjoints, summands);
+    result = optimized_result;
   }
+
+  // Keep the intermediates worth keeping within the memory budget, the others are recomputed
+  Map<std::string, NodeRef> result_attrs;
+  // the budget may exceed the range of an int
+  int64_t remat_memory_budget = 0;
+  if (in_attrs.count("remat_memory_budget") != 0) {
+    auto budget = Downcast<Expr>(in_attrs.at("remat_memory_budget")).as<IntImm>();
+    CHECK(budget != nullptr) << "remat_memory_budget must be an integer of bytes";
+    remat_memory_budget = budget->value;
+  }
+  if (remat_memory_budget > 0) {
+    Array<Tensor> planned_result;
+    ADPassPlanRematerialization(result, planned_result, remat_memory_budget, result_attrs);
+    result = planned_result;
+  }
+  // AD FINISHED... Returning to Poly
+  return DifferentiationResultNode::make(result, adjoints, summands, result_attrs);
 }
 
 TVM_REGISTER_API("akg.autodiff.Jacobian").set_body([](const TVMArgs args, TVMRetValue *ret) {
@@ -34,6 +34,8 @@ class DifferentiationResultNode : public Node {
   Map<Tensor, Tensor> adjoints;
   /*! \brief Single summands of the adjoints*/
   Map<Tensor, Map<Tensor, Tensor>> adjoint_summands;
+  /*! \brief Attributes reported by the differentiation, e.g. the rematerialization plan */
+  Map<std::string, NodeRef> attrs;
   /*! \brief constructor */
   DifferentiationResultNode() = default;
 
@@ -44,9 +46,11 @@ class DifferentiationResultNode : public Node {
     v->Visit("result", &result);
     v->Visit("adjoints", &adjoints);
     v->Visit("adjoint_summands", &adjoint_summands);
+    v->Visit("attrs", &attrs);
   }
   TVM_DLL static DifferentiationResult make(Array<Tensor> result, Map<Tensor, Tensor> adjoints,
-                                            Map<Tensor, Map<Tensor, Tensor>> adjoint_summands);
+                                            Map<Tensor, Map<Tensor, Tensor>> adjoint_summands,
+                                            Map<std::string, NodeRef> attrs = Map<std::string, NodeRef>());
 
   static constexpr const char *_type_key = "DifferentiationResult";
   TVM_DECLARE_NODE_TYPE_INFO(DifferentiationResultNode, Node);
@@ -1386,6 +1386,193 @@ void ADPassIsolateTensors(Array<Tensor> &input_tensors, Array<Tensor> &output_te
   return;
 }
 
+// Estimated cost to compute one element of an op, transcendental calls weigh more than arithmetic
+int64_t ADEstimateElementCost(const Operation &op) {
+  static const std::unordered_set<std::string> transcendental = {"exp", "log", "tanh", "sigmoid", "sqrt", "rsqrt",
+                                                                 "pow", "erf", "sin", "cos", "atan", "atan2"};
+  auto compute_op = op.as<ComputeOpNode>();
+  if (compute_op == nullptr) {
+    return 0;
+  }
+  int64_t cost = 0;
+  for (const auto &e : compute_op->body) {
+    PostOrderVisit(e, [&cost](const NodeRef &node) {
+      if (auto call = node.as<Call>()) {
+        if (call->call_type != Call::Halide) {
+          cost += transcendental.count(call->name) ? AD_REMAT_TRANSCENDENTAL_COST : 1;
+        }
+      } else if (node.as<Div>() || node.as<Mod>() || node.as<FloorDiv>() || node.as<FloorMod>()) {
+        cost += AD_REMAT_DIV_COST;
+      } else if (node.as<Add>() || node.as<Sub>() || node.as<Mul>() || node.as<Min>() || node.as<Max>() ||
+                 node.as<Select>() || node.as<Cast>()) {
+        cost += 1;
+      }
+    });
+  }
+  return cost;
+}
+
+int64_t ADTensorElements(const Tensor &tensor) {
+  int64_t elems = 1;
+  for (const auto &dim : tensor->shape) {
+    auto imm = dim.as<IntImm>();
+    if (imm == nullptr) {
+      return -1;
+    }
+    elems *= imm->value;
+  }
+  return elems;
+}
+
+// The tensor copied by an isolated tensor of IsolateTensor, undefined for other tensors
+Tensor ADIsolatedSource(const Tensor &tensor) {
+  auto compute_op = tensor->op.as<ComputeOpNode>();
+  const std::string suffix = "_no_inline";
+  const std::string &name = tensor->op->name;
+  if (compute_op == nullptr || compute_op->attrs.count("no_inline") == 0 || compute_op->body.size() != 1 ||
+      name.size() <= suffix.size() || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+    return Tensor();
+  }
+  auto call = compute_op->body[0].as<Call>();
+  if (call == nullptr || call->call_type != Call::Halide || call->value_index != 0 ||
+      call->args.size() != compute_op->axis.size()) {
+    return Tensor();
+  }
+  for (size_t i = 0; i < call->args.size(); ++i) {
+    if (!call->args[i].same_as(compute_op->axis[i]->var)) {
+      return Tensor();
+    }
+  }
+  return Downcast<Operation>(call->func).output(0);
+}
+
+void ADPassUnisolateTensors(Array<Tensor> &input_tensors, Array<Tensor> &output_tensors) {
+  std::unordered_map<Tensor, int> dfs_order;
+  for (auto it : input_tensors) {
+    CollectDFSOrder(it, dfs_order);
+  }
+  std::vector<Tensor> ordered(dfs_order.size());
+  for (const auto &it : dfs_order) {
+    ordered[it.second] = it.first;
+  }
+  // the consumers of an isolated tensor read the tensor it copies, producers are replaced before consumers
+  std::unordered_map<Operation, Operation> operation_replace_map;
+  for (const auto &tensor : ordered) {
+    bool is_output = std::find(input_tensors.begin(), input_tensors.end(), tensor) != input_tensors.end();
+    auto source = ADIsolatedSource(tensor);
+    if (source.defined() && !is_output) {
+      auto it = operation_replace_map.find(source->op);
+      operation_replace_map[tensor->op] = it == operation_replace_map.end() ? source->op : it->second;
+      continue;
+    }
+    auto new_op = ReplaceInputs(tensor->op, operation_replace_map);
+    if (!new_op.same_as(tensor->op)) {
+      operation_replace_map[tensor->op] = new_op;
+    }
+  }
+  for (auto it : input_tensors) {
+    auto replaced = operation_replace_map.find(it->op);
+    output_tensors.push_back(replaced == operation_replace_map.end() ? it : replaced->second.output(it->value_index));
+  }
+}
+
+void ADPassPlanRematerialization(Array<Tensor> &input_tensors, Array<Tensor> &output_tensors, int64_t budget,
+                                 Map<std::string, NodeRef> &remat_info) {
+  // the copies isolated by ADPassIsolateTensors are planned again like the other intermediates
+  Array<Tensor> graph;
+  ADPassUnisolateTensors(input_tensors, graph);
+  std::unordered_map<Tensor, std::unordered_set<Tensor>> reverse_dependencies;
+  CollectReverseDependencies(graph, reverse_dependencies);
+  std::unordered_map<Tensor, int> dfs_order;
+  for (auto it : graph) {
+    CollectDFSOrder(it, dfs_order);
+  }
+
+  // Injective intermediates are inlined, i.e. recomputed in every consumer, unless they are kept. The
+  // cost of one recomputation includes the inlined producers, which are themselves recomputed.
+  std::vector<Tensor> ordered(dfs_order.size());
+  for (const auto &it : dfs_order) {
+    ordered[it.second] = it.first;
+  }
+  std::unordered_map<Tensor, int64_t> inlined_cost;
+  int64_t materialized_bytes = 0;
+  struct Candidate {
+    Tensor tensor;
+    int64_t bytes;
+    int64_t saving;
+  };
+  std::vector<Candidate> candidates;
+  for (const auto &tensor : ordered) {
+    auto compute_op = tensor->op.as<ComputeOpNode>();
+    if (compute_op == nullptr) {
+      continue;
+    }
+    int64_t elems = ADTensorElements(tensor);
+    if (elems < 0) {
+      LOG(DEBUG) << "Rematerialization planning skipped: dynamic shape of " << tensor->op->name;
+      output_tensors = input_tensors;
+      return;
+    }
+    int64_t bytes = elems * tensor->dtype.bytes();
+    bool is_output = std::find(graph.begin(), graph.end(), tensor) != graph.end();
+    if (!compute_op->reduce_axis.empty() || compute_op->attrs.count("no_inline") || is_output) {
+      materialized_bytes += is_output ? 0 : bytes;
+      continue;
+    }
+    int64_t cost = ADEstimateElementCost(tensor->op);
+    for (const auto &input : tensor->op->InputTensors()) {
+      if (inlined_cost.count(input)) {
+        cost += inlined_cost[input];
+      }
+    }
+    inlined_cost[tensor] = cost;
+    int64_t uses = static_cast<int64_t>(reverse_dependencies[tensor].size());
+    if (uses >= AD_PASS_MIN_DEPENDANTS_TO_ISOLATE && cost > 0) {
+      candidates.push_back(Candidate{tensor, bytes, (uses - 1) * elems * cost});
+    }
+  }
+
+  // Keep the tensors that save the most recomputation per byte while they fit in the budget
+  std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+    return static_cast<double>(a.saving) * static_cast<double>(b.bytes) >
+           static_cast<double>(b.saving) * static_cast<double>(a.bytes);
+  });
+  std::unordered_set<Tensor> tensors_to_keep;
+  Array<Expr> kept_names;
+  Array<Expr> recomputed_names;
+  int64_t kept_bytes = 0;
+  int64_t all_bytes = materialized_bytes;
+  int64_t recompute_cost = 0;
+  for (const auto &c : candidates) {
+    all_bytes += c.bytes;
+    if (materialized_bytes + kept_bytes + c.bytes <= budget) {
+      kept_bytes += c.bytes;
+      (void)tensors_to_keep.emplace(c.tensor);
+      kept_names.push_back(StringImm::make(c.tensor->op->name));
+    } else {
+      recompute_cost += c.saving;
+      recomputed_names.push_back(StringImm::make(c.tensor->op->name));
+    }
+  }
+  if (materialized_bytes > budget) {
+    LOG(WARNING) << "Rematerialization budget " << budget << " bytes is below the " << materialized_bytes
+                 << " bytes of intermediates that cannot be recomputed";
+  }
+  remat_info.Set("remat_kept", kept_names);
+  remat_info.Set("remat_recomputed", recomputed_names);
+  remat_info.Set("remat_kept_bytes", make_const(Int(64), materialized_bytes + kept_bytes));
+  remat_info.Set("remat_keep_all_bytes", make_const(Int(64), all_bytes));
+  remat_info.Set("remat_recompute_cost", make_const(Int(64), recompute_cost));
+  LOG(DEBUG) << "Rematerialization keeps " << kept_names.size() << " and recomputes " << recomputed_names.size()
+             << " intermediates: " << (materialized_bytes + kept_bytes) << " of " << all_bytes << " bytes kept";
+
+  if (tensors_to_keep.empty()) {
+    output_tensors = graph;
+    return;
+  }
+  ReplaceAndIsolateArrayTensors(graph, output_tensors, tensors_to_keep);
+}
+
 bool IsReduceSum(const Tensor &root, std::vector<size_t> &reduction_axes) {
   const ComputeOpNode *comp_op{nullptr};
   const Reduce *reduce_op{nullptr};
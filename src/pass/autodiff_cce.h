@@ -25,6 +25,8 @@ namespace ir {
 constexpr int AD_GROUP_CONV_DEFAULT_cutK = 48;
 constexpr int AD_PASS_MIN_DEPENDANTS_TO_ISOLATE = 2;
 constexpr int AD_PASS_MIN_DISTANCE_TO_ISOLATE = 2;
+constexpr int64_t AD_REMAT_TRANSCENDENTAL_COST = 16;
+constexpr int64_t AD_REMAT_DIV_COST = 4;
 
 enum ADConvType { UNKNOWN = -1, NORMAL, GROUP, DEPTHWISE };
 
@@ -457,6 +459,34 @@ void ADPassMergeMultipleBroadcast(Array<Tensor> &input_tensors, Array<Tensor> &o
  */
 Tensor IsolateTensor(const Tensor &tensor);
 
+/*!
+ * \brief Undo the isolation of IsolateTensor: the consumers of an isolated copy read the copied tensor again. The
+ * isolated copies that are outputs are kept.
+ *
+ * \param input_tensors: the array containing input tensors.
+ *
+ * \param output_tensors (returned): The new tensors without isolated copies.
+ */
+void ADPassUnisolateTensors(Array<Tensor> &input_tensors, Array<Tensor> &output_tensors);
+
+/*!
+ * \brief Choose which intermediate tensors of the gradient graph are kept in memory and which are recomputed in
+ * their consumers. Intermediates with several consumers are kept, most recomputation saved per byte first, as long
+ * as all the kept intermediates, including the reductions that cannot be recomputed, fit in the budget.
+ * The copies isolated by ADPassIsolateTensors are planned again.
+ *
+ * \param input_tensors: the array containing input tensors.
+ *
+ * \param output_tensors (returned): The new tensors with the kept intermediates isolated.
+ *
+ * \param budget: the memory budget of the intermediates in bytes.
+ *
+ * \param remat_info (returned): the kept and recomputed tensors, the kept bytes, the bytes when every
+ * intermediate is kept, and the estimated cost of the recomputation.
+ */
+void ADPassPlanRematerialization(Array<Tensor> &input_tensors, Array<Tensor> &output_tensors, int64_t budget,
+                                 Map<std::string, NodeRef> &remat_info);
+
 /*!
  * \brief For all tensors from array input_tensors, automatically find the common nodes for at least two nodes and
  * isolate them to avoid the repetition in code-gen.
@@ -0,0 +1,43 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <tvm/ir.h>
+#include <tvm/ir_pass.h>
+#include <map>
+#include <string>
+#include "pass/utils.h"
+
+namespace akg {
+namespace ir {
+Map<std::string, Integer> CountBarriers(const Stmt &stmt) {
+  std::map<std::string, int> counts = {{"shared", 0}, {"warp", 0}, {"global", 0}};
+  PostOrderVisit(stmt, [&counts](const NodeRef &node) {
+    auto call = node.as<Call>();
+    if (call == nullptr || !call->is_intrinsic(air::ir::intrinsic::tvm_storage_sync) || call->args.empty()) {
+      return;
+    }
+    if (auto scope = call->args[0].as<StringImm>()) {
+      ++counts[scope->value];
+    }
+  });
+  Map<std::string, Integer> res;
+  for (const auto &kv : counts) {
+    res.Set(kv.first, Integer(kv.second));
+  }
+  return res;
+}
+}  // namespace ir
+}  // namespace akg
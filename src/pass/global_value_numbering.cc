@@ -0,0 +1,286 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <tvm/ir.h>
+#include <tvm/ir_mutator.h>
+#include <tvm/ir_pass.h>
+#include <tvm/ir_visitor.h>
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "pass/utils.h"
+
+namespace akg {
+namespace ir {
+namespace {
+/*
+ * A binder is a statement that defines a scalar variable for its body: For, LetStmt and the
+ * thread_extent/virtual_thread attrs. Every hoisted expression is bound by a LetStmt placed at the
+ * top of the body of the innermost binder that defines one of its variables, which dominates all
+ * the occurrences of that expression.
+ */
+struct Binder {
+  const Object *node;
+  const Variable *var;
+  int loop_depth;
+};
+
+struct IndexExprEntry {
+  Expr expr;
+  Var var;
+  size_t count{0};
+  bool invariant{false};
+  bool used{false};
+};
+
+struct ExprLess {
+  bool operator()(const Expr &a, const Expr &b) const { return Compare(a, b) < 0; }
+};
+
+/*
+ * Only pure scalar integer arithmetic is numbered: no memory access, no calls and no division by
+ * something that may be zero, so that evaluating it earlier than its original position is safe.
+ * Trivial expressions such as "i + 1" are left alone because binding them saves nothing.
+ */
+bool IsIndexCandidate(const Expr &e) {
+  if (!(e.type().is_int() || e.type().is_uint()) || e.type().lanes() != 1) {
+    return false;
+  }
+  if (e.as<Variable>() || is_const(e) || e.as<Cast>()) {
+    return false;
+  }
+  bool valid = true;
+  int num_ops = 0;
+  bool has_mul_div = false;
+  auto check_divisor = [&valid](const Expr &b) {
+    if (!is_const(b) || is_zero(b)) valid = false;
+  };
+  PostOrderVisit(e, [&](const NodeRef &node) {
+    if (node.as<Load>() || node.as<Call>() || node.as<Let>() || node.as<Ramp>() || node.as<Broadcast>() ||
+        node.as<Shuffle>() || node.as<Reduce>() || node.as<StringImm>() || node.as<FloatImm>()) {
+      valid = false;
+    } else if (auto op = node.as<Div>()) {
+      check_divisor(op->b);
+      has_mul_div = true;
+    } else if (auto op = node.as<Mod>()) {
+      check_divisor(op->b);
+      has_mul_div = true;
+    } else if (auto op = node.as<FloorDiv>()) {
+      check_divisor(op->b);
+      has_mul_div = true;
+    } else if (auto op = node.as<FloorMod>()) {
+      check_divisor(op->b);
+      has_mul_div = true;
+    } else if (node.as<Mul>()) {
+      has_mul_div = true;
+    } else if (node.as<Add>() || node.as<Sub>() || node.as<Min>() || node.as<Max>() || node.as<Select>()) {
+      ++num_ops;
+    }
+  });
+  return valid && (has_mul_div || num_ops >= 2);
+}
+
+class IndexExprNumbering : public IRMutator {
+ public:
+  Stmt Run(const Stmt &stmt) {
+    collect_ = true;
+    static_cast<void>(Mutate(stmt));
+    size_t num_candidates = 0;
+    for (auto &entry : entries_) {
+      if (IsSelected(entry)) {
+        entry.var = Variable::make(entry.expr.type(), "gvn_" + std::to_string(num_candidates++));
+      }
+    }
+    if (num_candidates == 0) {
+      return stmt;
+    }
+    collect_ = false;
+    Stmt res = Mutate(stmt);
+    size_t num_shared = 0;
+    size_t num_hoisted = 0;
+    for (const auto &entry : entries_) {
+      if (entry.used) {
+        num_shared += entry.count > 1 ? 1 : 0;
+        num_hoisted += entry.invariant ? 1 : 0;
+      }
+    }
+    LOG(DEBUG) << "GlobalValueNumbering: " << num_shared << " index expressions shared, " << num_hoisted
+               << " hoisted out of loops";
+    return res;
+  }
+
+  Stmt Mutate(Stmt stmt) override { return IRMutator::Mutate(stmt); }
+
+  Expr Mutate(Expr e) override {
+    if (kernel_root_ < 0) {
+      return IRMutator::Mutate(e);
+    }
+    // variables bound by a Let expr are not visible to the binders
+    if (e.as<Let>()) {
+      return e;
+    }
+    if (auto call = e.as<Call>()) {
+      // intrinsic arguments may have to keep their form, e.g. the offsets of tvm_access_ptr
+      if (call->call_type == Call::Intrinsic || call->call_type == Call::Extern) {
+        return e;
+      }
+    }
+    if (IsIndexCandidate(e)) {
+      size_t pos = Placement(e);
+      if (collect_) {
+        IndexExprEntry &entry = Lookup(pos, e, true);
+        ++entry.count;
+        entry.invariant = entry.invariant || binders_[pos].loop_depth < loop_depth_;
+      } else if (pos < max_placement_) {
+        IndexExprEntry *entry = &Lookup(pos, e, false);
+        if (entry != &dummy_ && IsSelected(*entry)) {
+          entry->used = true;
+          return entry->var;
+        }
+      }
+    }
+    return IRMutator::Mutate(e);
+  }
+
+  Stmt Mutate_(const For *op, const Stmt &s) final {
+    Expr min = Mutate(op->min);
+    Expr extent = Mutate(op->extent);
+    ++loop_depth_;
+    Stmt body = MutateBinderBody(s.get(), op->loop_var.get(), op->body);
+    --loop_depth_;
+    if (min.same_as(op->min) && extent.same_as(op->extent) && body.same_as(op->body)) {
+      return s;
+    }
+    return For::make(op->loop_var, min, extent, op->for_type, op->device_api, body);
+  }
+
+  Stmt Mutate_(const LetStmt *op, const Stmt &s) final {
+    Expr value = Mutate(op->value);
+    Stmt body = MutateBinderBody(s.get(), op->var.get(), op->body);
+    if (value.same_as(op->value) && body.same_as(op->body)) {
+      return s;
+    }
+    return LetStmt::make(op->var, value, body);
+  }
+
+  Stmt Mutate_(const AttrStmt *op, const Stmt &s) final {
+    Stmt body;
+    if (op->attr_key == air::ir::attr::thread_extent || op->attr_key == air::ir::attr::virtual_thread) {
+      auto iv = op->node.as<IterVarNode>();
+      CHECK(iv);
+      bool is_root = kernel_root_ < 0;
+      if (is_root) {
+        kernel_root_ = static_cast<int>(binders_.size());
+      }
+      body = MutateBinderBody(s.get(), iv->var.get(), op->body);
+      if (is_root) {
+        kernel_root_ = -1;
+      }
+    } else {
+      // attr values are consumed by later passes and code generation as they are
+      body = Mutate(op->body);
+    }
+    if (body.same_as(op->body)) {
+      return s;
+    }
+    return AttrStmt::make(op->node, op->attr_key, op->value, body);
+  }
+
+ private:
+  bool IsSelected(const IndexExprEntry &entry) const { return entry.count > 1 || entry.invariant; }
+
+  // the innermost binder that defines a variable of e, but never outside the kernel
+  size_t Placement(const Expr &e) const {
+    std::unordered_set<const Variable *> vars;
+    PostOrderVisit(e, [&vars](const NodeRef &node) {
+      if (auto var = node.as<Variable>()) {
+        vars.insert(var);
+      }
+    });
+    for (size_t i = binders_.size(); i > static_cast<size_t>(kernel_root_) + 1; --i) {
+      if (vars.count(binders_[i - 1].var) > 0) {
+        return i - 1;
+      }
+    }
+    return static_cast<size_t>(kernel_root_);
+  }
+
+  IndexExprEntry &Lookup(size_t pos, const Expr &e, bool create) {
+    auto &exprs = exprs_at_[binders_[pos].node];
+    auto it = exprs.find(e);
+    if (it != exprs.end()) {
+      return entries_[it->second];
+    }
+    if (!create) {
+      return dummy_;
+    }
+    exprs.emplace(e, entries_.size());
+    IndexExprEntry entry;
+    entry.expr = e;
+    entries_.push_back(entry);
+    return entries_.back();
+  }
+
+  Stmt MutateBinderBody(const Object *node, const Variable *var, const Stmt &body) {
+    binders_.push_back(Binder{node, var, loop_depth_});
+    Stmt res = Mutate(body);
+    if (!collect_) {
+      res = EmitLets(node, res);
+    }
+    binders_.pop_back();
+    return res;
+  }
+
+  // Bind the expressions placed at this binder. Their definitions reuse the expressions placed at the
+  // enclosing binders only, so the lets emitted here do not depend on each other.
+  Stmt EmitLets(const Object *node, Stmt body) {
+    auto it = exprs_at_.find(node);
+    if (it == exprs_at_.end()) {
+      return body;
+    }
+    std::vector<size_t> used;
+    for (const auto &kv : it->second) {
+      if (entries_[kv.second].used) {
+        used.push_back(kv.second);
+      }
+    }
+    size_t saved_max_placement = max_placement_;
+    max_placement_ = binders_.size() - 1;
+    for (auto idx = used.rbegin(); idx != used.rend(); ++idx) {
+      const IndexExprEntry &entry = entries_[*idx];
+      Expr value = IRMutator::Mutate(entry.expr);
+      body = LetStmt::make(entry.var, value, body);
+    }
+    max_placement_ = saved_max_placement;
+    return body;
+  }
+
+  bool collect_{true};
+  int kernel_root_{-1};
+  int loop_depth_{0};
+  size_t max_placement_{std::numeric_limits<size_t>::max()};
+  std::vector<Binder> binders_;
+  std::vector<IndexExprEntry> entries_;
+  std::unordered_map<const Object *, std::map<Expr, size_t, ExprLess>> exprs_at_;
+  IndexExprEntry dummy_;
+};
+}  // namespace
+
+Stmt GlobalValueNumbering(const Stmt &stmt) { return IndexExprNumbering().Run(stmt); }
+}  // namespace ir
+}  // namespace akg
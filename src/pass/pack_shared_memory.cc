@@ -0,0 +1,364 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <tvm/ir.h>
+#include <tvm/ir_mutator.h>
+#include <tvm/ir_pass.h>
+#include <tvm/ir_visitor.h>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "common/common_util.h"
+#include "pass/utils.h"
+
+namespace akg {
+namespace ir {
+namespace {
+struct SharedBuffer {
+  Var var;
+  Type type;
+  uint64_t bytes{0};
+  size_t start{0};
+  size_t end{0};
+  uint64_t offset{0};
+  bool touched{false};
+  bool packable{true};
+};
+
+using SharedBufferMap = std::unordered_map<const Variable *, SharedBuffer>;
+
+class SharedBufferCollector : public IRVisitor {
+ public:
+  explicit SharedBufferCollector(SharedBufferMap &buffers) : buffers_(buffers) {}
+  ~SharedBufferCollector() override = default;
+
+  void Visit_(const AttrStmt *op) final {
+    if (op->attr_key == air::ir::attr::storage_scope && op->value.as<StringImm>()) {
+      auto scope = op->value.as<StringImm>()->value;
+      if (scope == "shared") {
+        shared_vars_.insert(op->node.as<Variable>());
+      }
+      // tensor core kernels are promoted within the advanced budget
+      tensor_core = tensor_core || scope.find("wmma.") == 0;
+    }
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const Allocate *op) final {
+    int32_t size = op->constant_allocation_size();
+    if (shared_vars_.count(op->buffer_var.get()) && size > 0) {
+      SharedBuffer buf;
+      buf.var = op->buffer_var;
+      buf.type = op->type;
+      buf.bytes = static_cast<uint64_t>(size) * op->type.bytes() * op->type.lanes();
+      buffers_[op->buffer_var.get()] = buf;
+    }
+    IRVisitor::Visit_(op);
+  }
+
+  bool tensor_core{false};
+
+ private:
+  SharedBufferMap &buffers_;
+  std::unordered_set<const Variable *> shared_vars_;
+};
+
+// Record which shared buffers a top level statement touches. A buffer referenced other than through
+// Load, Store or tvm_access_ptr may be aliased, so it is not packed.
+class SharedAccessVisitor : public IRVisitor {
+ public:
+  SharedAccessVisitor(SharedBufferMap &buffers, size_t pos) : buffers_(buffers), pos_(pos) {}
+  ~SharedAccessVisitor() override = default;
+
+  void Visit_(const Load *op) final {
+    Touch(op->buffer_var.get());
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const Store *op) final {
+    Touch(op->buffer_var.get());
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const Call *op) final {
+    if (op->is_intrinsic(air::ir::intrinsic::tvm_access_ptr) && op->args.size() == 5 && op->args[1].as<Variable>()) {
+      Touch(op->args[1].as<Variable>());
+      for (size_t i = 0; i < op->args.size(); ++i) {
+        if (i != 1) Visit(op->args[i]);
+      }
+      return;
+    }
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const Variable *op) final { Escape(op); }
+
+  // attrs such as volatile_scope keep referring to the original buffer
+  void Visit_(const AttrStmt *op) final {
+    if (op->attr_key != air::ir::attr::storage_scope) {
+      Escape(op->node.as<Variable>());
+    }
+    IRVisitor::Visit_(op);
+  }
+
+  void Escape(const Variable *var) {
+    auto it = buffers_.find(var);
+    if (it != buffers_.end()) {
+      it->second.packable = false;
+    }
+  }
+
+ private:
+  void Touch(const Variable *var) {
+    auto it = buffers_.find(var);
+    if (it == buffers_.end()) return;
+    auto &buf = it->second;
+    buf.start = buf.touched ? std::min(buf.start, pos_) : pos_;
+    buf.end = buf.touched ? std::max(buf.end, pos_) : pos_;
+    buf.touched = true;
+  }
+
+  SharedBufferMap &buffers_;
+  size_t pos_;
+};
+
+class SharedBufferRewriter : public IRMutator {
+ public:
+  SharedBufferRewriter(const SharedBufferMap &packed, const Var &arena,
+                       const std::unordered_set<const Object *> &sync_points)
+      : packed_(packed), arena_(arena), sync_points_(sync_points) {}
+  ~SharedBufferRewriter() override = default;
+
+  Stmt Mutate(Stmt stmt) override {
+    bool need_sync = sync_points_.count(stmt.get()) > 0;
+    stmt = IRMutator::Mutate(stmt);
+    if (need_sync) {
+      Stmt sync = Evaluate::make(Call::make(Int(32), air::ir::intrinsic::tvm_storage_sync,
+                                            {StringImm::make("shared")}, Call::Intrinsic));
+      stmt = Block::make(sync, stmt);
+    }
+    return stmt;
+  }
+
+  Expr Mutate(Expr expr) override { return IRMutator::Mutate(expr); }
+
+  Stmt Mutate_(const AttrStmt *op, const Stmt &s) final {
+    if (op->attr_key == air::ir::attr::storage_scope && packed_.count(op->node.as<Variable>())) {
+      return Mutate(op->body);
+    }
+    return IRMutator::Mutate_(op, s);
+  }
+
+  Stmt Mutate_(const Allocate *op, const Stmt &s) final {
+    if (packed_.count(op->buffer_var.get())) {
+      return Mutate(op->body);
+    }
+    return IRMutator::Mutate_(op, s);
+  }
+
+  Expr Mutate_(const Load *op, const Expr &e) final {
+    auto it = packed_.find(op->buffer_var.get());
+    if (it == packed_.end()) {
+      return IRMutator::Mutate_(op, e);
+    }
+    Expr index = Mutate(op->index);
+    return Load::make(op->type, arena_, Shift(index, it->second.offset, op->type), Mutate(op->predicate));
+  }
+
+  Stmt Mutate_(const Store *op, const Stmt &s) final {
+    auto it = packed_.find(op->buffer_var.get());
+    if (it == packed_.end()) {
+      return IRMutator::Mutate_(op, s);
+    }
+    Expr index = Mutate(op->index);
+    return Store::make(arena_, Mutate(op->value), Shift(index, it->second.offset, op->value.type()),
+                       Mutate(op->predicate));
+  }
+
+  Expr Mutate_(const Call *op, const Expr &e) final {
+    if (op->is_intrinsic(air::ir::intrinsic::tvm_access_ptr) && op->args.size() == 5 && op->args[1].as<Variable>()) {
+      auto it = packed_.find(op->args[1].as<Variable>());
+      if (it != packed_.end()) {
+        Expr offset = Shift(Mutate(op->args[2]), it->second.offset, op->args[0].type());
+        return Call::make(op->type, op->name, {op->args[0], arena_, offset, Mutate(op->args[3]), op->args[4]},
+                          op->call_type);
+      }
+    }
+    return IRMutator::Mutate_(op, e);
+  }
+
+ private:
+  // indices count elements of the accessed type
+  static Expr Shift(const Expr &index, uint64_t offset_bytes, const Type &t) {
+    uint64_t elem_bytes = static_cast<uint64_t>(t.element_of().bytes());
+    CHECK(elem_bytes > 0 && offset_bytes % elem_bytes == 0);
+    if (offset_bytes == 0) return index;
+    return index + make_const(index.type(), static_cast<int64_t>(offset_bytes / elem_bytes));
+  }
+
+  const SharedBufferMap &packed_;
+  Var arena_;
+  const std::unordered_set<const Object *> &sync_points_;
+};
+
+bool IsSharedSync(const Stmt &stmt) {
+  auto op = stmt.as<Evaluate>();
+  if (op == nullptr) return false;
+  auto call = op->value.as<Call>();
+  return call && call->is_intrinsic(air::ir::intrinsic::tvm_storage_sync) && !call->args.empty() &&
+         call->args[0].as<StringImm>() && call->args[0].as<StringImm>()->value == "shared";
+}
+
+/*
+ * Merge the constant shared allocations of one kernel into a single arena. The kernel body is cut into
+ * the statements of its top level sequence, outside any loop or condition; a buffer is live from the
+ * first to the last of these statements touching it. Buffers whose live ranges do not overlap share
+ * bytes of the arena, and a barrier is placed before the statement where a buffer starts reusing the
+ * bytes of a dead one.
+ */
+class SharedMemoryPacker : public IRMutator {
+ public:
+  Stmt Mutate_(const AttrStmt *op, const Stmt &s) final {
+    if (op->attr_key == air::ir::attr::thread_extent) {
+      return PackKernel(op, s);
+    }
+    return IRMutator::Mutate_(op, s);
+  }
+
+  uint64_t saved_bytes{0};
+
+ private:
+  void CollectUnits(const Stmt &stmt, std::vector<Stmt> &units, SharedBufferMap &buffers) {
+    if (auto op = stmt.as<AttrStmt>()) {
+      SharedAccessVisitor visitor(buffers, units.size());
+      if (op->attr_key != air::ir::attr::storage_scope) {
+        visitor.Escape(op->node.as<Variable>());
+      }
+      visitor.Visit(op->value);
+      CollectUnits(op->body, units, buffers);
+    } else if (auto op = stmt.as<Allocate>()) {
+      CollectUnits(op->body, units, buffers);
+    } else if (auto op = stmt.as<LetStmt>()) {
+      SharedAccessVisitor(buffers, units.size()).Visit(op->value);
+      CollectUnits(op->body, units, buffers);
+    } else if (auto op = stmt.as<Block>()) {
+      CollectUnits(op->first, units, buffers);
+      CollectUnits(op->rest, units, buffers);
+    } else {
+      SharedAccessVisitor(buffers, units.size()).Visit(stmt);
+      units.push_back(stmt);
+    }
+  }
+
+  // The shared memory manager gives the branches of a sequence their own budgets when they can be packed, so a
+  // packed kernel has to fit the budget of a block. Kernels left unpacked are left to the checks of the codegen.
+  static void CheckSharedBytes(uint64_t bytes, bool tensor_core) {
+    uint64_t limit = tensor_core ? common::ADVANCED_SHARED_MEMORY_SIZE : common::SHARED_MEMORY_SIZE;
+    CHECK_LE(bytes, limit) << "The shared buffers of a kernel need " << bytes << " bytes after packing, more than "
+                           << limit << " bytes; try enable_pack_shared_memory=false.";
+  }
+
+  Stmt PackKernel(const AttrStmt *op, const Stmt &s) {
+    SharedBufferMap buffers;
+    SharedBufferCollector collector(buffers);
+    collector.Visit(s);
+    if (buffers.size() < 2) {
+      return s;
+    }
+    uint64_t kernel_bytes = 0;
+    for (const auto &kv : buffers) {
+      kernel_bytes += kv.second.bytes;
+    }
+    std::vector<Stmt> units;
+    CollectUnits(op->body, units, buffers);
+
+    SharedBufferMap packed;
+    std::vector<SharedBuffer *> order;
+    uint64_t total_bytes = 0;
+    for (auto &kv : buffers) {
+      if (kv.second.packable && kv.second.touched) {
+        order.push_back(&kv.second);
+        total_bytes += kv.second.bytes;
+      }
+    }
+    if (order.size() < 2) {
+      return s;
+    }
+
+    // place the largest buffers first, each at the lowest aligned offset free during its live range
+    std::sort(order.begin(), order.end(), [](const SharedBuffer *a, const SharedBuffer *b) {
+      if (a->bytes != b->bytes) return a->bytes > b->bytes;
+      return a->start < b->start;
+    });
+    const uint64_t align = common::SHARED_MEMORY_ALIGN_BYTES;
+    uint64_t arena_bytes = 0;
+    std::vector<SharedBuffer *> placed;
+    for (auto cur : order) {
+      std::vector<SharedBuffer *> conflicts;
+      for (auto p : placed) {
+        if (p->start <= cur->end && cur->start <= p->end) conflicts.push_back(p);
+      }
+      std::sort(conflicts.begin(), conflicts.end(),
+                [](const SharedBuffer *a, const SharedBuffer *b) { return a->offset < b->offset; });
+      uint64_t offset = 0;
+      for (auto c : conflicts) {
+        if (offset + cur->bytes <= c->offset) break;
+        offset = std::max<uint64_t>(offset, common::AlignUp(c->offset + c->bytes, align));
+      }
+      cur->offset = offset;
+      arena_bytes = std::max(arena_bytes, offset + cur->bytes);
+      placed.push_back(cur);
+    }
+    arena_bytes = common::AlignUp(arena_bytes, align);
+    if (arena_bytes >= total_bytes) {
+      return s;
+    }
+    CheckSharedBytes(kernel_bytes - total_bytes + arena_bytes, collector.tensor_core);
+
+    std::unordered_set<const Object *> sync_points;
+    for (auto b : placed) {
+      for (auto a : placed) {
+        bool reuse = a->end < b->start && a->offset < b->offset + b->bytes && b->offset < a->offset + a->bytes;
+        if (reuse && !(b->start > 0 && IsSharedSync(units[b->start - 1]))) {
+          sync_points.insert(units[b->start].get());
+        }
+      }
+      packed[b->var.get()] = *b;
+    }
+
+    Type arena_type = Float(32, static_cast<int>(align / 4));
+    Var arena("shared_arena", Handle());
+    Stmt body = SharedBufferRewriter(packed, arena, sync_points).Mutate(op->body);
+    body = Allocate::make(arena, arena_type, {make_const(Int(32), static_cast<int64_t>(arena_bytes / align))},
+                          const_true(), body);
+    body = AttrStmt::make(arena, air::ir::attr::storage_scope, StringImm::make("shared"), body);
+    saved_bytes += total_bytes - arena_bytes;
+    return AttrStmt::make(op->node, op->attr_key, op->value, body);
+  }
+};
+}  // namespace
+
+Stmt PackSharedMemory(const Stmt &stmt) {
+  SharedMemoryPacker packer;
+  Stmt res = packer.Mutate(stmt);
+  if (packer.saved_bytes > 0) {
+    LOG(DEBUG) << "PackSharedMemory: " << packer.saved_bytes << " bytes of shared memory saved";
+  }
+  return res;
+}
+}  // namespace ir
+}  // namespace akg
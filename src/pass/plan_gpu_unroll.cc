@@ -0,0 +1,331 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <tvm/ir.h>
+#include <tvm/ir_mutator.h>
+#include <tvm/ir_pass.h>
+#include <tvm/ir_visitor.h>
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <unordered_set>
+#include <vector>
+#include "common/target_info.h"
+#include "pass/utils.h"
+
+namespace akg {
+namespace ir {
+namespace {
+constexpr auto kPragmaUnroll = "pragma_unroll";
+// copies of the loop body allowed by unrolling, which bounds the code growth
+constexpr int kMaxUnrollSteps = 64;
+constexpr int kPartialFactors[] = {8, 4, 2};
+// registers taken by the thread ids, the loop vars, the indices and the pointers of a kernel
+constexpr int kReservedRegisters = 16;
+constexpr int kMinRegisterCap = 32;
+constexpr int kMaxRegistersPerThread = 255;
+
+int NumWords(const Type &t) { return std::max((t.bits() * t.lanes() + 31) / 32, 1); }
+
+/*
+ * Registers needed to evaluate an expression tree without spilling, as in Sethi-Ullman numbering: the
+ * children are evaluated in decreasing order of need while the results of the previous ones are held.
+ * Loads of local buffers are registers already and need none.
+ */
+class ExprRegisterNeed : public IRVisitor {
+ public:
+  explicit ExprRegisterNeed(const std::unordered_set<const Variable *> &local_bufs) : local_bufs_(local_bufs) {}
+  ~ExprRegisterNeed() override = default;
+
+  int Get(const Expr &e) {
+    need_ = 0;
+    Visit(e);
+    return need_;
+  }
+
+  void Visit_(const Load *op) final {
+    if (local_bufs_.count(op->buffer_var.get()) > 0) {
+      need_ = 0;
+      return;
+    }
+    need_ = std::max(Get(op->index), NumWords(op->type));
+  }
+
+  void Visit_(const Call *op) final { Combine(op->args, op->type); }
+  void Visit_(const Cast *op) final { Combine({op->value}, op->type); }
+  void Visit_(const Not *op) final { Combine({op->a}, op->type); }
+  void Visit_(const Select *op) final { Combine({op->condition, op->true_value, op->false_value}, op->type); }
+  void Visit_(const Let *op) final { Combine({op->value, op->body}, op->type); }
+  void Visit_(const Ramp *op) final { need_ = NumWords(op->type); }
+  void Visit_(const Broadcast *op) final { need_ = NumWords(op->type); }
+  void Visit_(const Variable *op) final { need_ = 0; }
+
+  void Visit_(const Add *op) final { Combine({op->a, op->b}, op->type); }
+  void Visit_(const Sub *op) final { Combine({op->a, op->b}, op->type); }
+  void Visit_(const Mul *op) final { Combine({op->a, op->b}, op->type); }
+  void Visit_(const Div *op) final { Combine({op->a, op->b}, op->type); }
+  void Visit_(const Mod *op) final { Combine({op->a, op->b}, op->type); }
+  void Visit_(const FloorDiv *op) final { Combine({op->a, op->b}, op->type); }
+  void Visit_(const FloorMod *op) final { Combine({op->a, op->b}, op->type); }
+  void Visit_(const Min *op) final { Combine({op->a, op->b}, op->type); }
+  void Visit_(const Max *op) final { Combine({op->a, op->b}, op->type); }
+  void Visit_(const EQ *op) final { Combine({op->a, op->b}, op->type); }
+  void Visit_(const NE *op) final { Combine({op->a, op->b}, op->type); }
+  void Visit_(const LT *op) final { Combine({op->a, op->b}, op->type); }
+  void Visit_(const LE *op) final { Combine({op->a, op->b}, op->type); }
+  void Visit_(const GT *op) final { Combine({op->a, op->b}, op->type); }
+  void Visit_(const GE *op) final { Combine({op->a, op->b}, op->type); }
+  void Visit_(const And *op) final { Combine({op->a, op->b}, op->type); }
+  void Visit_(const Or *op) final { Combine({op->a, op->b}, op->type); }
+
+ private:
+  void Combine(const Array<Expr> &children, const Type &t) {
+    std::vector<int> needs;
+    for (const auto &child : children) {
+      needs.push_back(Get(child));
+    }
+    std::sort(needs.begin(), needs.end(), std::greater<int>());
+    int need = 0;
+    for (size_t i = 0; i < needs.size(); ++i) {
+      if (needs[i] > 0) {
+        need = std::max(need, needs[i] + static_cast<int>(i));
+      }
+    }
+    need_ = std::max(need, NumWords(t));
+  }
+
+  const std::unordered_set<const Variable *> &local_bufs_;
+  int need_{0};
+};
+
+// what one iteration of a loop executes
+struct LoopBodyCost {
+  // statements, counting every copy of the unrolled inner loops
+  int steps{0};
+  // registers live besides the local buffers, the copies of an unrolled body being interleaved
+  int registers{0};
+  // the body holds a loop that is not unrolled
+  bool has_rolled_loop{false};
+};
+
+LoopBodyCost GetLoopBodyCost(const Stmt &body, const std::unordered_set<const Variable *> &local_bufs) {
+  LoopBodyCost cost;
+  ExprRegisterNeed need(local_bufs);
+  std::function<void(const Stmt &)> visit = [&](const Stmt &s) {
+    if (auto op = s.as<For>()) {
+      LoopBodyCost inner = GetLoopBodyCost(op->body, local_bufs);
+      int copies = 1;
+      if (op->for_type == ForType::Unrolled && op->extent.as<IntImm>()) {
+        copies = static_cast<int>(std::max(op->extent.as<IntImm>()->value, static_cast<int64_t>(1)));
+      } else {
+        cost.has_rolled_loop = true;
+      }
+      cost.steps += inner.steps * copies;
+      cost.registers = std::max(cost.registers, inner.registers * copies);
+      cost.has_rolled_loop = cost.has_rolled_loop || inner.has_rolled_loop;
+    } else if (auto op = s.as<Block>()) {
+      visit(op->first);
+      visit(op->rest);
+    } else if (auto op = s.as<IfThenElse>()) {
+      cost.registers = std::max(cost.registers, need.Get(op->condition));
+      visit(op->then_case);
+      if (op->else_case.defined()) visit(op->else_case);
+    } else if (auto op = s.as<LetStmt>()) {
+      int value_need = need.Get(op->value);
+      cost.registers = std::max(cost.registers, value_need);
+      LoopBodyCost inner = GetLoopBodyCost(op->body, local_bufs);
+      cost.steps += inner.steps + 1;
+      cost.registers = std::max(cost.registers, inner.registers + NumWords(op->value.type()));
+      cost.has_rolled_loop = cost.has_rolled_loop || inner.has_rolled_loop;
+    } else if (auto op = s.as<AttrStmt>()) {
+      visit(op->body);
+    } else if (auto op = s.as<Allocate>()) {
+      visit(op->body);
+    } else if (auto op = s.as<Store>()) {
+      ++cost.steps;
+      cost.registers = std::max(cost.registers, std::max(need.Get(op->value), need.Get(op->index)));
+    } else if (auto op = s.as<Evaluate>()) {
+      ++cost.steps;
+      cost.registers = std::max(cost.registers, need.Get(op->value));
+    }
+  };
+  visit(body);
+  return cost;
+}
+
+// Whether the body indexes a local buffer by the loop var. Only a full unroll makes such indices constant, a
+// partial one leaves a dynamic index that puts the buffer in local memory.
+bool IndexesLocalBufByVar(const Stmt &body, const Var &var, const std::unordered_set<const Variable *> &local_bufs) {
+  bool found = false;
+  PostOrderVisit(body, [&](const NodeRef &node) {
+    if (auto op = node.as<Load>()) {
+      found = found || (local_bufs.count(op->buffer_var.get()) > 0 && ExprUseVar(op->index, var));
+    } else if (auto op = node.as<Store>()) {
+      found = found || (local_bufs.count(op->buffer_var.get()) > 0 && ExprUseVar(op->index, var));
+    }
+  });
+  return found;
+}
+
+/*
+ * Chooses how far every innermost serial loop of a GPU kernel is unrolled. Unrolling by a factor f
+ * interleaves f copies of the body, which raises the instruction level parallelism but also the
+ * registers live in the loop. The largest factor whose estimate fits in the register cap of the kernel
+ * is taken:
+ *   for (i, 0, 16)                          // pragma_unroll = 4
+ *     C[i] = A[i] * B[i] + C[i]     -->     for (i, 0, 16)
+ *                                             C[i] = A[i] * B[i] + C[i]
+ * A full unroll makes the loop Unrolled. Loops indexing local buffers by their var are only fully unrolled.
+ * A loop that fits no factor is left unannotated, so that the compiler still decides from the registers it
+ * really allocates.
+ */
+class GpuUnrollPlanner : public IRMutator {
+ public:
+  explicit GpuUnrollPlanner(int register_cap) : register_cap_(register_cap) {}
+  ~GpuUnrollPlanner() override = default;
+
+  Stmt Mutate_(const AttrStmt *op, const Stmt &s) final {
+    if (op->attr_key != air::ir::attr::thread_extent || in_kernel_) {
+      return IRMutator::Mutate_(op, s);
+    }
+    if (!AnalyzeKernel(s)) {
+      return s;
+    }
+    in_kernel_ = true;
+    Stmt stmt = IRMutator::Mutate_(op, s);
+    in_kernel_ = false;
+    local_bufs_.clear();
+    return stmt;
+  }
+
+  Stmt Mutate_(const For *op, const Stmt &s) final {
+    Stmt stmt = IRMutator::Mutate_(op, s);
+    op = stmt.as<For>();
+    CHECK(op);
+    auto extent = op->extent.as<IntImm>();
+    if (!in_kernel_ || op->for_type != ForType::Serial || extent == nullptr || extent->value <= 1) {
+      return stmt;
+    }
+    LoopBodyCost cost = GetLoopBodyCost(op->body, local_bufs_);
+    if (cost.has_rolled_loop || cost.steps == 0) {
+      return stmt;
+    }
+    int available = kernel_register_cap_ - local_words_ - kReservedRegisters;
+    auto fits = [&cost, available](int64_t factor) {
+      return factor * cost.steps <= kMaxUnrollSteps && factor * cost.registers <= available;
+    };
+    int64_t factor = 1;
+    if (fits(extent->value)) {
+      factor = extent->value;
+    } else if (!IndexesLocalBufByVar(op->body, op->loop_var, local_bufs_)) {
+      for (int f : kPartialFactors) {
+        if (f < extent->value && extent->value % f == 0 && fits(f)) {
+          factor = f;
+          break;
+        }
+      }
+    }
+    int registers = local_words_ + kReservedRegisters + static_cast<int>(factor) * cost.registers;
+    if (factor == 1) {
+      plan_ << " " << op->loop_var->name_hint << "(regs " << registers << ", left to the compiler)";
+      return stmt;
+    }
+    plan_ << " " << op->loop_var->name_hint << "(regs " << registers << ", factor " << factor << ")";
+    ++num_loops_;
+    ForType for_type = factor == extent->value ? ForType::Unrolled : ForType::Serial;
+    stmt = For::make(op->loop_var, op->min, op->extent, for_type, op->device_api, op->body);
+    return AttrStmt::make(op->loop_var, kPragmaUnroll, make_const(Int(32), factor), stmt);
+  }
+
+  std::string Plan() const { return plan_.str(); }
+  int NumLoops() const { return num_loops_; }
+
+ private:
+  // Collects the local buffers of the kernel and sets the register cap from its block size. Tensor core
+  // kernels are skipped as their fragments live in registers out of sight of the estimate.
+  bool AnalyzeKernel(const Stmt &kernel) {
+    bool tensor_core = false;
+    int64_t threads = 1;
+    local_words_ = 0;
+    std::unordered_set<const Variable *> thread_vars;
+    PostOrderVisit(kernel, [&, this](const NodeRef &node) {
+      if (auto op = node.as<AttrStmt>()) {
+        if (op->attr_key == air::ir::attr::pragma_tensor_core) {
+          tensor_core = true;
+        } else if (op->attr_key == air::ir::attr::thread_extent) {
+          auto iv = op->node.as<IterVarNode>();
+          CHECK(iv);
+          auto extent = op->value.as<IntImm>();
+          if (iv->thread_tag.find("threadIdx.") == 0 && extent != nullptr &&
+              thread_vars.insert(iv->var.get()).second) {
+            threads *= extent->value;
+          }
+        } else if (op->attr_key == air::ir::attr::storage_scope) {
+          auto buf = op->node.as<Variable>();
+          auto scope = op->value.as<StringImm>();
+          if (buf != nullptr && scope != nullptr && scope->value == "local") {
+            local_bufs_.insert(buf);
+          }
+        }
+      }
+    });
+    PostOrderVisit(kernel, [this](const NodeRef &node) {
+      if (auto op = node.as<Allocate>()) {
+        if (local_bufs_.count(op->buffer_var.get()) > 0) {
+          local_words_ += NumWords(op->type) * std::max(op->constant_allocation_size(), 1);
+        }
+      }
+    });
+    if (tensor_core) {
+      local_bufs_.clear();
+      return false;
+    }
+    kernel_register_cap_ = register_cap_;
+    if (kernel_register_cap_ <= 0) {
+      // keep at least half of the resident threads of a multiprocessor
+      int max_regs_per_sm = 65536;
+      int max_threads_per_sm = 2048;
+      air::GpuComputeInfo info = air::GetGpuComputeInfo();
+      if (info.defined()) {
+        max_regs_per_sm = info->max_regs_per_sm;
+        max_threads_per_sm = info->max_threads_per_sm;
+      }
+      int64_t resident = std::max(threads, static_cast<int64_t>(max_threads_per_sm / 2));
+      kernel_register_cap_ = static_cast<int>(
+        std::min(std::max(max_regs_per_sm / resident, static_cast<int64_t>(kMinRegisterCap)),
+                 static_cast<int64_t>(kMaxRegistersPerThread)));
+    }
+    return true;
+  }
+
+  int register_cap_;
+  int kernel_register_cap_{0};
+  bool in_kernel_{false};
+  int local_words_{0};
+  std::unordered_set<const Variable *> local_bufs_;
+  std::ostringstream plan_;
+  int num_loops_{0};
+};
+}  // namespace
+
+Stmt PlanGpuUnroll(const Stmt &stmt, int register_cap) {
+  GpuUnrollPlanner planner(register_cap);
+  Stmt res = planner.Mutate(stmt);
+  LOG(DEBUG) << "PlanGpuUnroll: " << planner.NumLoops() << " loops planned:" << planner.Plan();
+  return res;
+}
+}  // namespace ir
+}  // namespace akg
@@ -1005,12 +1005,68 @@ namespace akg {
 namespace ir {
 using air::arith::Analyzer;
 
-Expr Simplify_cce(Expr expr, const Map<Var, Range> &vrange) {
-  Analyzer analyzer;
-  for (auto kv : vrange) {
-    analyzer.Bind(kv.first, kv.second);
+namespace {
+thread_local SimplifyCCEScope *g_simplify_cce_scope = nullptr;
+// memo table is dropped when it grows beyond this number of entries
+constexpr size_t MAX_SIMPLIFY_MEMO_ENTRIES = 1 << 16;
+
+/*!
+ * \brief Structural hash of an expression that is consistent with air::ir::Equal, i.e. variables are hashed by
+ *  identity and everything else by value.
+ */
+class ExprStructHasher : public IRVisitor {
+ public:
+  size_t Hash(const Expr &expr) {
+    hash_ = 0;
+    Visit(expr);
+    return hash_;
+  }
+
+  void Visit(const NodeRef &node) final {
+    if (!node.defined()) {
+      Mix(0);
+      return;
+    }
+    Mix(node->type_index());
+    if (auto e = node.as<ExprNode>()) {
+      Mix(static_cast<size_t>(e->type.code()) << 24 | static_cast<size_t>(e->type.bits()) << 8 | e->type.lanes());
+    }
+    IRVisitor::Visit(node);
+  }
+
+  void Visit_(const Variable *op) final { Mix(std::hash<const void *>()(op)); }
+  void Visit_(const IntImm *op) final { Mix(std::hash<int64_t>()(op->value)); }
+  void Visit_(const UIntImm *op) final { Mix(std::hash<uint64_t>()(op->value)); }
+  void Visit_(const FloatImm *op) final { Mix(std::hash<double>()(op->value)); }
+  void Visit_(const StringImm *op) final { Mix(std::hash<std::string>()(op->value)); }
+  void Visit_(const Call *op) final {
+    Mix(std::hash<std::string>()(op->name));
+    Mix(static_cast<size_t>(op->call_type));
+    Mix(static_cast<size_t>(op->value_index));
+    IRVisitor::Visit_(op);
+  }
+
+ private:
+  void Mix(size_t value) { hash_ ^= value + 0x9e3779b9 + (hash_ << 6) + (hash_ >> 2); }
+  size_t hash_{0};
+};
+
+// Same bound as a variable that is not bound in a fresh analyzer.
+air::arith::ConstIntBound UnboundedOf(const Type &dtype) {
+  if (!dtype.is_int() && !dtype.is_uint()) {
+    return air::arith::ConstIntBound(air::arith::ConstIntBound::kNegInf, air::arith::ConstIntBound::kPosInf);
+  }
+  using air::arith::ConstIntBound;
+  int64_t vbits = dtype.bits() - static_cast<int>(dtype.is_int());
+  int64_t min_value = 0;
+  if (!dtype.is_uint()) {
+    min_value = vbits >= 63 ? ConstIntBound::kNegInf : -(static_cast<int64_t>(1) << vbits);
   }
+  int64_t max_value = vbits >= 63 ? ConstIntBound::kPosInf : (static_cast<int64_t>(1) << vbits) - 1;
+  return ConstIntBound(min_value, max_value);
+}
 
+Expr SimplifyWithAnalyzer(const Expr &expr, Analyzer &analyzer) {
   arith::RewriteSimplifierCCE rewrite_simplify_cce(&analyzer);
   if (is_const(expr)) return expr;
   auto res = rewrite_simplify_cce(expr);
@@ -1020,6 +1076,105 @@ Expr Simplify_cce(Expr expr, const Map<Var, Range> &vrange) {
   res = analyzer.canonical_simplify(res);
   return res;
 }
+}  // namespace
+
+size_t HashExprStructurally(const Expr &expr) { return ExprStructHasher().Hash(expr); }
+
+size_t HashVarRange(const Map<Var, Range> &vrange) {
+  ExprStructHasher hasher;
+  size_t hash = 0;
+  // binding maps are unordered, so combine the entries with an order-independent operation
+  for (const auto &kv : vrange) {
+    auto range_hash = hasher.Hash(kv.second->min) * 31 + hasher.Hash(kv.second->extent);
+    hash += std::hash<const void *>()(kv.first.get()) ^ range_hash;
+  }
+  return hash;
+}
+
+bool EqualVarRange(const Map<Var, Range> &a, const Map<Var, Range> &b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (const auto &kv : a) {
+    auto it = b.find(kv.first);
+    if (it == b.end() || !Equal((*it).second->min, kv.second->min) ||
+        !Equal((*it).second->extent, kv.second->extent)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+SimplifyCCEScope::SimplifyCCEScope(bool report) : report_(report), prev_(g_simplify_cce_scope) {
+  g_simplify_cce_scope = this;
+}
+
+SimplifyCCEScope::~SimplifyCCEScope() {
+  g_simplify_cce_scope = prev_;
+  if (report_ && hits_ + misses_ > 0) {
+    LOG(DEBUG) << "Simplify_cce memo: " << hits_ << " hits, " << misses_ << " misses, hit rate "
+               << static_cast<double>(hits_) / (hits_ + misses_) << ", " << num_entries_ << " entries";
+  }
+}
+
+SimplifyCCEScope *SimplifyCCEScope::Current() { return g_simplify_cce_scope; }
+
+void SimplifyCCEScope::BindScope(const Map<Var, Range> &vrange) {
+  for (const auto &var : bound_vars_) {
+    if (vrange.find(var) == vrange.end()) {
+      analyzer_.const_int_bound.Update(var, UnboundedOf(var.type()), true);
+    }
+  }
+  bound_vars_.clear();
+  for (const auto &kv : vrange) {
+    analyzer_.Bind(kv.first, kv.second, true);
+    bound_vars_.push_back(kv.first);
+  }
+}
+
+const Expr *SimplifyCCEScope::Lookup(size_t key, const Expr &expr, const Map<Var, Range> &vrange) const {
+  auto it = memo_.find(key);
+  if (it == memo_.end()) {
+    return nullptr;
+  }
+  for (const auto &entry : it->second) {
+    if ((entry.expr.same_as(expr) || Equal(entry.expr, expr)) && EqualVarRange(entry.vrange, vrange)) {
+      return &entry.result;
+    }
+  }
+  return nullptr;
+}
+
+Expr SimplifyCCEScope::Simplify(const Expr &expr, const Map<Var, Range> &vrange) {
+  if (is_const(expr)) return expr;
+  size_t key = HashExprStructurally(expr) * 31 + HashVarRange(vrange);
+  if (auto cached = Lookup(key, expr, vrange)) {
+    ++hits_;
+    return *cached;
+  }
+  ++misses_;
+  BindScope(vrange);
+  auto res = SimplifyWithAnalyzer(expr, analyzer_);
+  if (num_entries_ >= MAX_SIMPLIFY_MEMO_ENTRIES) {
+    memo_.clear();
+    num_entries_ = 0;
+  }
+  memo_[key].push_back(MemoEntry{expr, vrange, res});
+  ++num_entries_;
+  return res;
+}
+
+Expr Simplify_cce(Expr expr, const Map<Var, Range> &vrange) {
+  if (auto scope = SimplifyCCEScope::Current()) {
+    return scope->Simplify(expr, vrange);
+  }
+  Analyzer analyzer;
+  for (auto kv : vrange) {
+    analyzer.Bind(kv.first, kv.second);
+  }
+
+  return SimplifyWithAnalyzer(expr, analyzer);
+}
 
 Stmt Simplify_cce(const Stmt &stmt, const Map<Var, Range> &vrange) {
   Analyzer analyzer;
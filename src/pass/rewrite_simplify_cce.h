@@ -17,6 +17,12 @@
 #define PASS_REWRITE_SIMPLIFY_CCE_H_
 #define CHECK_IMPL_CONDITION false
 
+#include <tvm/arithmetic.h>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 #include "tvm.h"
 
 namespace akg {
@@ -39,6 +45,57 @@ Expr Simplify_cce(Expr expr, const Map<Var, Range> &vrange = Map<Var, Range>());
  * \note Analyzer will call into sub-analyzers to get the result.
  */
 Stmt Simplify_cce(const Stmt &stmt, const Map<Var, Range> &vrange = Map<Var, Range>());
+
+/*!
+ * \brief Structural hash of an expression that is consistent with air::ir::Equal, i.e. variables are hashed by
+ *  identity and everything else by value.
+ */
+size_t HashExprStructurally(const Expr &expr);
+
+/*! \brief Order-independent hash of variable ranges, consistent with EqualVarRange. */
+size_t HashVarRange(const Map<Var, Range> &vrange);
+
+/*! \brief Whether two maps bind the same variables to structurally equal ranges. */
+bool EqualVarRange(const Map<Var, Range> &a, const Map<Var, Range> &b);
+
+/*!
+ * \brief Memoizing simplification service for one compilation.
+ *
+ * While a scope is alive on the current thread, Simplify_cce(Expr, vrange) shares one analyzer whose variable
+ * bindings are replaced for every query, and returns the cached result of a structurally equal query made under
+ * the same bindings. Scopes may be nested; the innermost one is used.
+ */
+class SimplifyCCEScope {
+ public:
+  explicit SimplifyCCEScope(bool report = false);
+  ~SimplifyCCEScope();
+
+  /*! \return The innermost scope of the current thread, or nullptr if there is none. */
+  static SimplifyCCEScope *Current();
+
+  Expr Simplify(const Expr &expr, const Map<Var, Range> &vrange);
+
+  size_t Hits() const { return hits_; }
+  size_t Misses() const { return misses_; }
+
+ private:
+  struct MemoEntry {
+    Expr expr;
+    Map<Var, Range> vrange;
+    Expr result;
+  };
+  void BindScope(const Map<Var, Range> &vrange);
+  const Expr *Lookup(size_t key, const Expr &expr, const Map<Var, Range> &vrange) const;
+
+  air::arith::Analyzer analyzer_;
+  std::vector<Var> bound_vars_;
+  std::unordered_map<size_t, std::vector<MemoEntry>> memo_;
+  size_t num_entries_{0};
+  size_t hits_{0};
+  size_t misses_{0};
+  bool report_{false};
+  SimplifyCCEScope *prev_{nullptr};
+};
 }  // namespace ir
 }  // namespace akg
 
@@ -0,0 +1,260 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <tvm/ir.h>
+#include <tvm/ir_mutator.h>
+#include <tvm/ir_pass.h>
+#include <tvm/ir_visitor.h>
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include "pass/utils.h"
+
+namespace akg {
+namespace ir {
+namespace {
+constexpr auto kBlockIdxZ = "blockIdx.z";
+
+bool HasIntrinsic(const Stmt &stmt, const char *name) {
+  bool found = false;
+  PostOrderVisit(stmt, [&found, name](const NodeRef &node) {
+    if (auto call = node.as<Call>()) {
+      found = found || call->is_intrinsic(name);
+    }
+  });
+  return found;
+}
+
+/*
+ * Checks that the tensor core kernel can take the split: blockIdx.z is free, the only global output
+ * is written by scalar stores from a shared memory copy of the accumulator and never read, and the K
+ * loop has a constant extent divisible by the split. atomicAdd has no vector form, so a store of
+ * several lanes or inside a vectorized loop keeps the kernel unsplit.
+ */
+class SplitKChecker : public IRVisitor {
+ public:
+  void Visit_(const AttrStmt *op) final {
+    if (op->attr_key == air::ir::attr::thread_extent) {
+      auto iv = op->node.as<IterVarNode>();
+      CHECK(iv);
+      if (iv->thread_tag == kBlockIdxZ) {
+        block_z_bound = true;
+      }
+    } else if (op->attr_key == air::ir::attr::storage_scope) {
+      auto buf = op->node.as<Variable>();
+      auto scope = op->value.as<StringImm>();
+      if (buf != nullptr && scope != nullptr && scope->value == "shared") {
+        shared_bufs_.insert(buf);
+      }
+    }
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const Allocate *op) final {
+    local_bufs_.insert(op->buffer_var.get());
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const For *op) final {
+    if (op->for_type == ForType::Vectorized) {
+      ++vectorized_depth_;
+      IRVisitor::Visit_(op);
+      --vectorized_depth_;
+      return;
+    }
+    if (reduce_loop == nullptr && op->for_type == ForType::Serial && HasIntrinsic(op->body, "tvm_mma_sync") &&
+        !HasIntrinsic(op->body, "tvm_store_matrix_sync")) {
+      reduce_loop = op;
+    }
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const Store *op) final {
+    if (local_bufs_.count(op->buffer_var.get()) == 0) {
+      auto load = op->value.as<Load>();
+      if (load == nullptr || shared_bufs_.count(load->buffer_var.get()) == 0) {
+        valid_ = false;
+      }
+      if (op->value.type().lanes() > 1 || vectorized_depth_ > 0) {
+        valid_ = false;
+      }
+      if (output == nullptr) {
+        output = op->buffer_var.get();
+      } else if (output != op->buffer_var.get()) {
+        valid_ = false;
+      }
+    }
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const Load *op) final {
+    loaded_bufs_.insert(op->buffer_var.get());
+    IRVisitor::Visit_(op);
+  }
+
+  bool CanSplit(int split) const {
+    if (!valid_ || block_z_bound || output == nullptr || loaded_bufs_.count(output) > 0 || reduce_loop == nullptr) {
+      return false;
+    }
+    auto extent = reduce_loop->extent.as<IntImm>();
+    return extent != nullptr && extent->value >= split && extent->value % split == 0;
+  }
+
+  bool block_z_bound{false};
+  const Variable *output{nullptr};
+  const For *reduce_loop{nullptr};
+
+ private:
+  bool valid_{true};
+  int vectorized_depth_{0};
+  std::unordered_set<const Variable *> local_bufs_;
+  std::unordered_set<const Variable *> shared_bufs_;
+  std::unordered_set<const Variable *> loaded_bufs_;
+};
+
+/*
+ * Zeroes the output before the GEMM kernel adds its partial sums to it:
+ *   // attr [blockIdx.x] thread_extent = ceil(size / threads)
+ *   // attr [threadIdx.x] thread_extent = threads
+ *   if (blockIdx.x * threads + threadIdx.x < size)
+ *     C[blockIdx.x * threads + threadIdx.x] = 0
+ * It is a kernel of its own, so every block of the GEMM sees the zeroed output.
+ */
+Stmt MakeCleanKernel(const Buffer &output, int64_t size) {
+  constexpr int64_t kCleanThreads = 256;
+  int64_t threads = std::min(size, kCleanThreads);
+  int64_t blocks = (size + threads - 1) / threads;
+  IterVar block_x = air::thread_axis(Range(0, static_cast<int>(blocks)), "blockIdx.x");
+  IterVar thread_x = air::thread_axis(Range(0, static_cast<int>(threads)), "threadIdx.x");
+  Expr index = block_x->var * static_cast<int>(threads) + thread_x->var;
+  Stmt body = Store::make(output->data, make_zero(output->dtype), index, const_true());
+  if (size % threads != 0) {
+    body = IfThenElse::make(index < static_cast<int>(size), body);
+  }
+  body = AttrStmt::make(thread_x, air::ir::attr::thread_extent, static_cast<int>(threads), body);
+  return AttrStmt::make(block_x, air::ir::attr::thread_extent, static_cast<int>(blocks), body);
+}
+
+/*
+ * Gives every block on blockIdx.z a contiguous range of the K loop and adds its partial sums to the
+ * output atomically, after the clean kernel has zeroed it:
+ *                                          clean kernel of C
+ *   for (k, 0, KT)                         for (ko, 0, KT / S)
+ *     mma(..., k)                   -->       mma(..., blockIdx.z * (KT / S) + ko)
+ *   C[i] = C_shared[j]                     atomicAdd(&C[i], C_shared[j])
+ */
+class SplitKRewriter : public IRMutator {
+ public:
+  SplitKRewriter(const SplitKChecker &checker, int split, const Stmt &clean)
+      : output_(checker.output), reduce_loop_(checker.reduce_loop), split_(split), clean_(clean) {}
+
+  Stmt Mutate_(const AttrStmt *op, const Stmt &s) final {
+    if (op->attr_key != air::ir::attr::thread_extent || in_kernel_) {
+      return IRMutator::Mutate_(op, s);
+    }
+    in_kernel_ = true;
+    size_t num_atomics = num_atomics_;
+    Stmt stmt = IRMutator::Mutate_(op, s);
+    in_kernel_ = false;
+    // other kernels of the function are left as they are
+    if (!split_done_ || split_kernel_done_) {
+      num_atomics_ = num_atomics;
+      return s;
+    }
+    split_kernel_done_ = true;
+    IterVar block_z = air::thread_axis(Range(0, split_), kBlockIdxZ);
+    Map<Var, Expr> vmap;
+    vmap.Set(split_var_, block_z->var);
+    return Block::make(clean_, AttrStmt::make(block_z, air::ir::attr::thread_extent, split_, Substitute(stmt, vmap)));
+  }
+
+  Stmt Mutate_(const For *op, const Stmt &s) final {
+    if (op != reduce_loop_) {
+      return IRMutator::Mutate_(op, s);
+    }
+    Expr chunk = make_const(op->extent.type(), op->extent.as<IntImm>()->value / split_);
+    Var ko = op->loop_var.copy_with_suffix(".split");
+    Expr k = ko + Cast::make(op->loop_var.type(), split_var_) * chunk;
+    Map<Var, Expr> vmap;
+    vmap.Set(op->loop_var, k);
+    Stmt body = Substitute(Mutate(op->body), vmap);
+    split_done_ = true;
+    return For::make(ko, op->min, chunk, op->for_type, op->device_api, body);
+  }
+
+  Stmt Mutate_(const Store *op, const Stmt &s) final {
+    if (op->buffer_var.get() != output_) {
+      return IRMutator::Mutate_(op, s);
+    }
+    ++num_atomics_;
+    Expr dst = Load::make(op->value.type(), op->buffer_var, op->index, op->predicate);
+    Expr addr = Call::make(Handle(), "&", {dst}, Call::Extern);
+    return Evaluate::make(Call::make(op->value.type(), "atomicAdd", {addr, op->value}, Call::Extern));
+  }
+
+  size_t NumAtomics() const { return num_atomics_; }
+
+ private:
+  const Variable *output_;
+  const For *reduce_loop_;
+  int split_;
+  Stmt clean_;
+  bool in_kernel_{false};
+  bool split_done_{false};
+  bool split_kernel_done_{false};
+  // placeholder for blockIdx.z until the kernel root is rebuilt
+  Var split_var_{"split_k_idx", Int(32)};
+  size_t num_atomics_{0};
+};
+}  // namespace
+
+Stmt SplitKGemm(const Stmt &stmt, const Map<Tensor, Buffer> &extern_buffer, int split) {
+  if (split <= 1) {
+    return stmt;
+  }
+  SplitKChecker checker;
+  checker.Visit(stmt);
+  Buffer output;
+  if (checker.CanSplit(split)) {
+    for (const auto &kv : extern_buffer) {
+      if (kv.second->data.get() == checker.output) {
+        output = kv.second;
+      }
+    }
+  }
+  const IntImm *size = nullptr;
+  if (output.defined()) {
+    Expr elems = make_const(Int(64), 1);
+    for (const auto &dim : output->shape) {
+      elems = elems * Cast::make(Int(64), dim);
+    }
+    elems = Simplify(elems);
+    size = elems.as<IntImm>();
+  }
+  // the output is zeroed by a kernel of a known grid, so it needs a constant size
+  if (size == nullptr || size->value <= 0 || size->value > std::numeric_limits<int32_t>::max()) {
+    LOG(WARNING) << "SplitKGemm: the kernel does not fit a split of K by " << split << ", keep it unsplit";
+    return stmt;
+  }
+  SplitKRewriter rewriter(checker, split, MakeCleanKernel(output, size->value));
+  Stmt res = rewriter.Mutate(stmt);
+  LOG(DEBUG) << "SplitKGemm: K loop " << checker.reduce_loop->loop_var->name_hint << " split among " << split
+             << " blocks on " << kBlockIdxZ << ", " << rewriter.NumAtomics() << " stores turned into atomicAdd";
+  return res;
+}
+}  // namespace ir
+}  // namespace akg
@@ -0,0 +1,300 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <tvm/arithmetic.h>
+#include <tvm/ir.h>
+#include <tvm/ir_mutator.h>
+#include <tvm/ir_pass.h>
+#include <unordered_set>
+#include <vector>
+#include "pass/utils.h"
+
+namespace akg {
+namespace ir {
+namespace {
+// every counter pair lives in registers during the whole loop
+constexpr size_t kMaxDivModCounters = 8;
+
+/*
+ * A quotient/remainder pair of "(a * i + b) / K" where i is the loop var, and a, b and K are
+ * invariant in the loop. Both are carried across iterations instead of being recomputed:
+ *   q = (a * min + b) / K, r = (a * min + b) % K
+ *   for (i, min, extent) {
+ *     ... q ... r ...
+ *     q = q + a / K + (r + a % K >= K ? 1 : 0)
+ *     r = r + a % K >= K ? r + a % K - K : r + a % K
+ *   }
+ * Since a % K < K, a single conditional wrap keeps r in [0, K).
+ */
+struct DivModCounter {
+  Expr numerator;
+  Expr divisor;
+  bool is_floor;
+  Expr coeff;
+  Expr base;
+  bool need_quotient{false};
+  bool need_remainder{false};
+  Var quotient;
+  Var remainder;
+};
+
+bool IsPure(const Expr &e, const std::unordered_set<const Variable *> &inner_vars) {
+  bool pure = true;
+  PostOrderVisit(e, [&pure, &inner_vars](const NodeRef &node) {
+    if (node.as<Load>() || node.as<Call>() || node.as<Let>()) {
+      pure = false;
+    } else if (auto var = node.as<Variable>()) {
+      if (inner_vars.count(var) > 0) pure = false;
+    }
+  });
+  return pure;
+}
+
+class DivModCounterCollector : public IRVisitor {
+ public:
+  DivModCounterCollector(const For *loop, air::arith::Analyzer *analyzer) : loop_(loop), analyzer_(analyzer) {
+    PostOrderVisit(loop->body, [this](const NodeRef &node) {
+      if (auto op = node.as<For>()) {
+        inner_vars_.insert(op->loop_var.get());
+      } else if (auto op = node.as<LetStmt>()) {
+        inner_vars_.insert(op->var.get());
+      } else if (auto op = node.as<Let>()) {
+        inner_vars_.insert(op->var.get());
+      } else if (auto op = node.as<AttrStmt>()) {
+        if (auto iv = op->node.as<IterVarNode>()) {
+          inner_vars_.insert(iv->var.get());
+        }
+      }
+    });
+  }
+  ~DivModCounterCollector() override = default;
+
+  void Visit_(const Div *op) final { Record(op->a, op->b, false, true); }
+  void Visit_(const Mod *op) final { Record(op->a, op->b, false, false); }
+  void Visit_(const FloorDiv *op) final { Record(op->a, op->b, true, true); }
+  void Visit_(const FloorMod *op) final { Record(op->a, op->b, true, false); }
+
+  std::vector<DivModCounter> counters;
+
+ private:
+  void Record(const Expr &numerator, const Expr &divisor, bool is_floor, bool is_quotient) {
+    Visit(numerator);
+    Visit(divisor);
+    Type t = numerator.type();
+    if (!(t.is_int() || t.is_uint()) || t.lanes() != 1 || !divisor.type().is_scalar()) {
+      return;
+    }
+    // divisions by powers of two are already shifts and masks
+    int64_t k = 0;
+    if (auto imm = divisor.as<IntImm>()) {
+      k = imm->value;
+      if (k <= 1 || (k & (k - 1)) == 0) return;
+    }
+    std::unordered_set<const Variable *> loop_var = {loop_->loop_var.get()};
+    if (!ExprUseVar(numerator, loop_var) || ExprUseVar(divisor, loop_var) || !IsPure(numerator, inner_vars_) ||
+        !IsPure(divisor, inner_vars_)) {
+      return;
+    }
+    for (auto &c : counters) {
+      if (c.is_floor == is_floor && Equal(c.numerator, numerator) && Equal(c.divisor, divisor)) {
+        c.need_quotient = c.need_quotient || is_quotient;
+        c.need_remainder = c.need_remainder || !is_quotient;
+        return;
+      }
+    }
+    if (counters.size() >= kMaxDivModCounters) {
+      return;
+    }
+    auto coeffs = air::arith::DetectLinearEquation(numerator, {loop_->loop_var});
+    if (coeffs.size() != 2 || is_zero(coeffs[0])) {
+      return;
+    }
+    // truncated division only matches the floor one for non-negative operands
+    if (!is_floor && !t.is_uint()) {
+      Expr first = coeffs[0] * loop_->min + coeffs[1];
+      if (k == 0 || !analyzer_->CanProve(coeffs[0] >= 0) || !analyzer_->CanProve(first >= 0)) {
+        return;
+      }
+    }
+    DivModCounter c;
+    c.numerator = numerator;
+    c.divisor = divisor;
+    c.is_floor = is_floor;
+    c.coeff = coeffs[0];
+    c.base = coeffs[1];
+    c.need_quotient = is_quotient;
+    c.need_remainder = !is_quotient;
+    counters.push_back(c);
+  }
+
+  const For *loop_;
+  air::arith::Analyzer *analyzer_;
+  std::unordered_set<const Variable *> inner_vars_;
+};
+
+class DivModCounterReplacer : public IRMutator {
+ public:
+  explicit DivModCounterReplacer(const std::vector<DivModCounter> &counters) : counters_(counters) {}
+  ~DivModCounterReplacer() override = default;
+
+  Expr Mutate_(const Div *op, const Expr &e) final { return Replace(op->a, op->b, false, true, op, e); }
+  Expr Mutate_(const Mod *op, const Expr &e) final { return Replace(op->a, op->b, false, false, op, e); }
+  Expr Mutate_(const FloorDiv *op, const Expr &e) final { return Replace(op->a, op->b, true, true, op, e); }
+  Expr Mutate_(const FloorMod *op, const Expr &e) final { return Replace(op->a, op->b, true, false, op, e); }
+
+ private:
+  template <typename T>
+  Expr Replace(const Expr &numerator, const Expr &divisor, bool is_floor, bool is_quotient, const T *op,
+               const Expr &e) {
+    for (const auto &c : counters_) {
+      if (c.is_floor == is_floor && Equal(c.numerator, numerator) && Equal(c.divisor, divisor)) {
+        return Load::make(e.type(), is_quotient ? c.quotient : c.remainder, 0, const_true(1));
+      }
+    }
+    return IRMutator::Mutate_(op, e);
+  }
+
+  const std::vector<DivModCounter> &counters_;
+};
+
+/*
+ * Only divisions affine in a serial loop var are reduced. A division of thread or block indices by a divisor
+ * known at runtime is evaluated once per thread, so a multiply-high by a magic number does not pay off unless
+ * the magic number is computed once per launch on the host and passed to the kernel: computing it in the
+ * kernel takes a 64 bit division per thread, which is dearer than the single division it replaces. Such
+ * divisions are left to the compiler of the device code.
+ */
+class DivModStrengthReducer : public IRMutator {
+ public:
+  Stmt Mutate_(const AttrStmt *op, const Stmt &s) final {
+    if (op->attr_key == air::ir::attr::thread_extent || op->attr_key == air::ir::attr::virtual_thread) {
+      auto iv = op->node.as<IterVarNode>();
+      CHECK(iv);
+      analyzer_.Bind(iv->var, Range::make_by_min_extent(0, op->value), true);
+    } else if (op->attr_key == "pragma_unroll" && op->node.as<Variable>()) {
+      unroll_vars_.insert(op->node.as<Variable>());
+    }
+    return IRMutator::Mutate_(op, s);
+  }
+
+  Stmt Mutate_(const For *op, const Stmt &s) final {
+    analyzer_.Bind(op->loop_var, Range::make_by_min_extent(op->min, op->extent), true);
+    Stmt stmt = IRMutator::Mutate_(op, s);
+    op = stmt.as<For>();
+    CHECK(op);
+    // unrolled and vectorized loops already fold the index arithmetic of each iteration, and so do the loops
+    // planned for unrolling, whose carried counters would keep the compiler from unrolling them
+    if (op->for_type != ForType::Serial || unroll_vars_.count(op->loop_var.get()) > 0 ||
+        (is_const(op->extent) && GetIntConst(op->extent) <= 1)) {
+      return stmt;
+    }
+    DivModCounterCollector collector(op, &analyzer_);
+    collector.Visit(op->body);
+    if (collector.counters.empty()) {
+      return stmt;
+    }
+    return ReduceLoop(op, collector.counters);
+  }
+
+  size_t NumCounters() const { return num_counters_; }
+
+ private:
+  Stmt ReduceLoop(const For *op, std::vector<DivModCounter> &counters) {
+    std::vector<Stmt> init;
+    std::vector<Stmt> update;
+    std::vector<std::pair<Var, Expr>> strides;
+    Expr runtime_check;
+    for (auto &c : counters) {
+      Type t = c.numerator.type();
+      c.quotient = Variable::make(Handle(), "quo");
+      c.remainder = Variable::make(Handle(), "rem");
+      Expr first = Simplify(c.coeff * op->min + c.base);
+      Expr quo_stride = Simplify(c.is_floor ? floordiv(c.coeff, c.divisor) : truncdiv(c.coeff, c.divisor));
+      Expr rem_stride = Simplify(c.is_floor ? floormod(c.coeff, c.divisor) : truncmod(c.coeff, c.divisor));
+      if (!is_const(quo_stride)) {
+        Var v = Variable::make(t, "quo_stride");
+        strides.emplace_back(v, quo_stride);
+        quo_stride = v;
+      }
+      if (!is_const(rem_stride)) {
+        Var v = Variable::make(t, "rem_stride");
+        strides.emplace_back(v, rem_stride);
+        rem_stride = v;
+      }
+      // divisors only known at runtime are checked before the loop, the original loop is kept as fallback
+      if (!is_const(c.divisor) && !analyzer_.CanProve(c.divisor > 0)) {
+        Expr positive = c.divisor > make_zero(c.divisor.type());
+        runtime_check = runtime_check.defined() ? (runtime_check && positive) : positive;
+      }
+
+      Expr quo = Load::make(t, c.quotient, 0, const_true(1));
+      Expr rem = Load::make(t, c.remainder, 0, const_true(1));
+      Expr next_rem = rem + rem_stride;
+      Expr wrap = next_rem >= c.divisor;
+      if (c.need_quotient) {
+        init.push_back(Store::make(c.quotient, c.is_floor ? floordiv(first, c.divisor) : truncdiv(first, c.divisor),
+                                   0, const_true(1)));
+        Expr carry = is_zero(rem_stride) ? make_zero(t) : Select::make(wrap, make_const(t, 1), make_zero(t));
+        update.push_back(Store::make(c.quotient, quo + quo_stride + carry, 0, const_true(1)));
+      }
+      init.push_back(Store::make(c.remainder, c.is_floor ? floormod(first, c.divisor) : truncmod(first, c.divisor),
+                                 0, const_true(1)));
+      if (!is_zero(rem_stride)) {
+        update.push_back(Store::make(c.remainder, Select::make(wrap, next_rem - c.divisor, next_rem), 0,
+                                     const_true(1)));
+      }
+    }
+
+    Stmt body = DivModCounterReplacer(counters).Mutate(op->body);
+    if (!update.empty()) {
+      body = Block::make(body, Block::make(update));
+    }
+    Stmt res = For::make(op->loop_var, op->min, op->extent, op->for_type, op->device_api, body);
+    res = Block::make(Block::make(init), res);
+    for (const auto &c : counters) {
+      std::vector<Var> bufs = {c.remainder};
+      if (c.need_quotient) {
+        bufs.push_back(c.quotient);
+      }
+      for (const auto &buf : bufs) {
+        res = Allocate::make(buf, c.numerator.type(), {make_const(Int(32), 1)}, const_true(), res);
+        res = AttrStmt::make(buf, air::ir::attr::storage_scope, Expr("local"), res);
+      }
+    }
+    for (auto it = strides.rbegin(); it != strides.rend(); ++it) {
+      res = LetStmt::make(it->first, it->second, res);
+    }
+    if (runtime_check.defined()) {
+      res = IfThenElse::make(runtime_check, res, GetRef<Stmt>(op));
+    }
+    num_counters_ += counters.size();
+    return res;
+  }
+
+  air::arith::Analyzer analyzer_;
+  std::unordered_set<const Variable *> unroll_vars_;
+  size_t num_counters_{0};
+};
+}  // namespace
+
+Stmt StrengthReduceDivMod(const Stmt &stmt) {
+  DivModStrengthReducer reducer;
+  Stmt res = reducer.Mutate(stmt);
+  LOG(DEBUG) << "StrengthReduceDivMod: " << reducer.NumCounters() << " quotient/remainder pairs carried by loops";
+  return res;
+}
+}  // namespace ir
+}  // namespace akg
@@ -2882,6 +2882,19 @@ Array<Expr> GetBinaryOpExprChildren(const Expr &e) {
   }
 }
 
+/// Get the child of expr of an elementwise unary math intrinsic
+/// \param e - Expr to be processed
+/// \return Expr the operand - If e is not such an intrinsic, then return empty Expr.
+Expr GetUnaryOpExprChild(const Expr &e) {
+  static const std::unordered_set<std::string> unary_ops = {"tanh", "exp", "log", "sqrt", "rsqrt", "fabs"};
+  auto call = e.as<Call>();
+  if (call == nullptr || call->call_type != Call::PureIntrinsic || call->args.size() != 1 ||
+      unary_ops.count(call->name) == 0) {
+    return Expr();
+  }
+  return call->args[0];
+}
+
 /// Get the calculate op name of expr of binary operation
 /// \param e - Expr to be processed
 /// \return Expr op name - If e is not binary op, then return empty Expr.
@@ -2894,6 +2907,10 @@ Expr GetBinaryOpName(const Expr &e) {
     return Expr("mul");
   } else if (e.as<Div>()) {
     return Expr("div");
+  } else if (e.as<Max>()) {
+    return Expr("max");
+  } else if (e.as<Min>()) {
+    return Expr("min");
   } else {
     return Expr();
   }
@@ -392,6 +392,8 @@ Array<Expr> GetBinaryOpExprChildren(const Expr &e);
 
 Expr GetBinaryOpName(const Expr &e);
 
+Expr GetUnaryOpExprChild(const Expr &e);
+
 Array<VarExpr> GetVarsInExpr(const Expr &expr, bool exclude_upper_case_vars = false);
 
 /// Get index of item in array
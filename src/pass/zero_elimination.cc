@@ -32,12 +32,14 @@
 #include <set>
 #include <utility>
 #include <vector>
+#include <unordered_map>
 #include <unordered_set>
 #include <tuple>
 
 #include "pass/utils.h"
 #include "pass/zero_elimination.h"
 #include "pass/autodiff_cce.h"
+#include "pass/rewrite_simplify_cce.h"
 
 namespace akg {
 namespace ir {
@@ -98,8 +100,13 @@ Expr SelectElseZero(const Expr &cond, const Expr &on_true) {
   return Select::make(cond, on_true, make_zero(on_true.type()));
 }
 
-// Simplify_cce the expression as thoroughly as possible by using all available simplifiers.
-Expr SuperSimplify(Expr e, const Map<Var, Range> &vranges) {
+namespace {
+// the memo is dropped when it grows beyond this number of entries
+constexpr size_t kMaxSuperSimplifyMemoEntries = 1 << 15;
+
+thread_local SuperSimplifyScope *g_super_simplify_scope = nullptr;
+
+Expr SuperSimplifyImpl(Expr e, const Map<Var, Range> &vranges) {
   // For some reason no simplifier can detect that there is only one value of the variable
   std::unordered_map<const Variable *, Expr> vmap;
   for (const auto &var_range : vranges) {
@@ -116,8 +123,109 @@ Expr SuperSimplify(Expr e, const Map<Var, Range> &vranges) {
   return AutodiffSimplify().Mutate(CanonicalSimplify(Simplify_cce(CanonicalSimplify(e, vranges), vranges), vranges));
 }
 
+/*
+ * Cheap check on the constant bounds of "a - b" for an integer comparison of a and b. It only answers
+ * whether the comparison is false at some point of the ranges, in which case no simplifier can prove it.
+ * Empty ranges make every condition vacuously true, so they disable the check.
+ */
+template <typename T>
+bool DiffBound(const T *op, const Map<Var, Range> &vranges, int64_t *min_value, int64_t *max_value) {
+  Type t = op->a.type();
+  if (!(t.is_int() || t.is_uint()) || t.lanes() != 1 || t.bits() > 32) {
+    return false;
+  }
+  air::arith::Analyzer analyzer;
+  for (const auto &kv : vranges) {
+    auto extent = kv.second->extent.template as<IntImm>();
+    if (extent == nullptr || extent->value < 1) {
+      return false;
+    }
+    analyzer.Bind(kv.first, kv.second);
+  }
+  auto bound = analyzer.const_int_bound(Cast::make(Int(64), op->a) - Cast::make(Int(64), op->b));
+  *min_value = bound->min_value;
+  *max_value = bound->max_value;
+  return true;
+}
+
+bool SurelyUnprovable(const Expr &e, const Map<Var, Range> &vranges) {
+  using air::arith::ConstIntBound;
+  int64_t lo = ConstIntBound::kNegInf;
+  int64_t hi = ConstIntBound::kPosInf;
+  // the infinite bounds compare as the extreme int64 values, so they never reject a condition
+  if (auto op = e.as<LT>()) {
+    return DiffBound(op, vranges, &lo, &hi) && lo >= 0;
+  } else if (auto op = e.as<LE>()) {
+    return DiffBound(op, vranges, &lo, &hi) && lo > 0;
+  } else if (auto op = e.as<GT>()) {
+    return DiffBound(op, vranges, &lo, &hi) && hi <= 0;
+  } else if (auto op = e.as<GE>()) {
+    return DiffBound(op, vranges, &lo, &hi) && hi < 0;
+  } else if (auto op = e.as<EQ>()) {
+    return DiffBound(op, vranges, &lo, &hi) && (lo > 0 || hi < 0);
+  }
+  return false;
+}
+}  // namespace
+
+SuperSimplifyScope::SuperSimplifyScope() : prev_(g_super_simplify_scope) { g_super_simplify_scope = this; }
+
+SuperSimplifyScope::~SuperSimplifyScope() { g_super_simplify_scope = prev_; }
+
+SuperSimplifyScope *SuperSimplifyScope::Current() { return g_super_simplify_scope; }
+
+/*
+ * The entries hold references to their variables, hence hashing variables by address cannot confuse a variable
+ * with a later one allocated at the same address.
+ */
+const Expr *SuperSimplifyScope::Lookup(size_t key, const Expr &e, const Map<Var, Range> &vranges) const {
+  auto it = memo_.find(key);
+  if (it == memo_.end()) {
+    return nullptr;
+  }
+  for (const auto &entry : it->second) {
+    if ((entry.expr.same_as(e) || Equal(entry.expr, e)) && EqualVarRange(entry.vranges, vranges)) {
+      return &entry.result;
+    }
+  }
+  return nullptr;
+}
+
+Expr SuperSimplifyScope::Simplify(const Expr &e, const Map<Var, Range> &vranges) {
+  size_t key = HashExprStructurally(e) * 31 + HashVarRange(vranges);
+  if (auto cached = Lookup(key, e, vranges)) {
+    ++hits_;
+    return *cached;
+  }
+  ++misses_;
+  Expr res = SuperSimplifyImpl(e, vranges);
+  if (num_entries_ >= kMaxSuperSimplifyMemoEntries) {
+    memo_.clear();
+    num_entries_ = 0;
+  }
+  memo_[key].push_back(MemoEntry{e, vranges, res});
+  ++num_entries_;
+  return res;
+}
+
+// Simplify_cce the expression as thoroughly as possible by using all available simplifiers.
+Expr SuperSimplify(Expr e, const Map<Var, Range> &vranges) {
+  if (is_const(e)) {
+    return e;
+  }
+  if (auto scope = SuperSimplifyScope::Current()) {
+    return scope->Simplify(e, vranges);
+  }
+  return SuperSimplifyImpl(e, vranges);
+}
+
 // Provability check that uses SuperSimplify
-bool CanProve(const Expr &e, const Map<Var, Range> &vranges) { return is_one(SuperSimplify(e, vranges)); }
+bool CanProve(const Expr &e, const Map<Var, Range> &vranges) {
+  if (SurelyUnprovable(e, vranges)) {
+    return false;
+  }
+  return is_one(SuperSimplify(e, vranges));
+}
 
 class ExprFreeVarsVisitor : public IRVisitor {
  public:
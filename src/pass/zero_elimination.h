@@ -21,6 +21,7 @@
 #include <tvm.h>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace akg {
 namespace ir {
@@ -116,6 +117,40 @@ TVM_DLL Expr SuperSimplify(Expr e, const Map<Var, Range> &vranges = Map<Var, Ran
  */
 TVM_DLL bool CanProve(const Expr &e, const Map<Var, Range> &vranges = Map<Var, Range>());
 
+/*!
+ * \brief Memo of SuperSimplify for one compilation.
+ *
+ * While a scope is alive on the current thread, SuperSimplify returns the cached result of a structurally equal
+ * query made under the same ranges. Scopes may be nested; the innermost one is used.
+ */
+class SuperSimplifyScope {
+ public:
+  SuperSimplifyScope();
+  ~SuperSimplifyScope();
+
+  /*! \return The innermost scope of the current thread, or nullptr if there is none. */
+  static SuperSimplifyScope *Current();
+
+  Expr Simplify(const Expr &e, const Map<Var, Range> &vranges);
+
+  size_t Hits() const { return hits_; }
+  size_t Misses() const { return misses_; }
+
+ private:
+  struct MemoEntry {
+    Expr expr;
+    Map<Var, Range> vranges;
+    Expr result;
+  };
+  const Expr *Lookup(size_t key, const Expr &e, const Map<Var, Range> &vranges) const;
+
+  std::unordered_map<size_t, std::vector<MemoEntry>> memo_;
+  size_t num_entries_{0};
+  size_t hits_{0};
+  size_t misses_{0};
+  SuperSimplifyScope *prev_{nullptr};
+};
+
 /*!
  * \brief Compose two domain transformations into one.
  */
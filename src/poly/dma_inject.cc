@@ -2115,6 +2115,50 @@ TensorClusterInfo TensorFootprintCluster::HoistBufferFootprintClusterInfo(
   return tensor_info;
 }
 
+std::string TensorFootprintClusterCache::AccessKey(const isl::union_map &reads, const isl::union_map &copyin,
+                                                   const isl::union_map &writes, const isl::union_map &fake_copyin) {
+  std::vector<isl::union_map> accesses = {reads, copyin, writes, fake_copyin};
+  // isl objects are copy-on-write, so holding the same object means holding the same relation
+  bool same_accesses = last_accesses_.size() == accesses.size();
+  for (size_t i = 0; same_accesses && i < accesses.size(); ++i) {
+    same_accesses = last_accesses_[i].get() == accesses[i].get();
+  }
+  if (!same_accesses) {
+    std::stringstream key;
+    for (const auto &access : accesses) {
+      key << access << ";";
+    }
+    last_accesses_ = accesses;
+    last_access_key_ = key.str();
+  }
+  return last_access_key_;
+}
+
+std::shared_ptr<TensorFootprintCluster> TensorFootprintClusterCache::HoistBufferFootprintCluster(
+  const isl::union_map &outer_schedule, const isl::id &target_id, const isl::union_map &reads,
+  const isl::union_map &copyin, const isl::union_map &writes, const isl::union_map &fake_copyin) {
+  std::stringstream key;
+  key << target_id.get_name() << "@" << outer_schedule << "@" << AccessKey(reads, copyin, writes, fake_copyin);
+  auto it = clusters_.find(key.str());
+  if (it != clusters_.end()) {
+    ++hits_;
+    return it->second;
+  }
+  ++misses_;
+  std::shared_ptr<TensorFootprintCluster> cluster =
+    TensorFootprintCluster::HoistBufferFootprintCluster(outer_schedule, target_id, reads, copyin, writes, fake_copyin);
+  clusters_.emplace(key.str(), cluster);
+  return cluster;
+}
+
+void TensorFootprintClusterCache::Clear() {
+  clusters_.clear();
+  last_accesses_.clear();
+  last_access_key_.clear();
+  hits_ = 0;
+  misses_ = 0;
+}
+
 }  // namespace poly
 }  // namespace ir
 }  // namespace akg
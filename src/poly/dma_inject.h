@@ -136,6 +136,38 @@ class TensorFootprintCluster {
   isl::multi_aff ComputeBufferedFootprints(bool with_strides, bool with_lower_bounds) const;
 };
 
+/*
+ * Memoize the footprint clusters computed by the promotion passes. The key is the promoted tensor,
+ * the outer schedule (schedule prefix) and the access relations, so that trying several promotion
+ * depths, or promoting the same tensor again in a later pass, does not recompute the footprint with isl.
+ * A tensor that is not accessed under the outer schedule is cached as nullptr.
+ */
+class TensorFootprintClusterCache {
+ public:
+  TensorFootprintClusterCache() = default;
+  ~TensorFootprintClusterCache() = default;
+
+  std::shared_ptr<TensorFootprintCluster> HoistBufferFootprintCluster(
+    const isl::union_map &outer_schedule, const isl::id &target_id, const isl::union_map &reads,
+    const isl::union_map &copyin, const isl::union_map &writes, const isl::union_map &fake_copyin);
+
+  void Clear();
+  size_t Size() const { return clusters_.size(); }
+  size_t Hits() const { return hits_; }
+  size_t Misses() const { return misses_; }
+
+ private:
+  std::string AccessKey(const isl::union_map &reads, const isl::union_map &copyin, const isl::union_map &writes,
+                        const isl::union_map &fake_copyin);
+
+  std::unordered_map<std::string, std::shared_ptr<TensorFootprintCluster>> clusters_;
+  // the access relations rarely change during one scop, so their textual form is computed once per change
+  std::vector<isl::union_map> last_accesses_;
+  std::string last_access_key_;
+  size_t hits_{0};
+  size_t misses_{0};
+};
+
 inline std::ostream &operator<<(std::ostream &os, const ScopedFootprint &scoped_fp) {
   if (!scoped_fp.box) {
     return os;
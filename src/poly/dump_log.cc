@@ -23,6 +23,7 @@
 #include <iostream>
 #include <iomanip>
 
+#include "common/ir_dump_writer.h"
 #include "poly/poly_util.h"
 #include "poly/dma_inject.h"
 
@@ -221,7 +222,7 @@ bool CompareSchTreeWithString(const std::string &compare_sch_, const isl::schedu
   return (sch_tree_str == compare_sch);
 }
 
-void PrintHeader(std::ofstream &of, const std::string &str) {
+void PrintHeader(std::ostream &of, const std::string &str) {
   of << std::endl << ">>>>>>>>>> " << str << " <<<<<<<<<<" << std::endl;
 }
 void PrintHeader(const std::string &str) { std::cout << ">>>>>>>>>> " << str << " <<<<<<<<<<" << std::endl; }
@@ -345,6 +346,10 @@ void AnalysisResult::DumpScopDataBasics(std::ofstream &of) {
   for (const auto &item : GetReduceOutTensors()) {
     of << item << std::endl;
   }
+
+  PrintHeader(of, "footprint_cluster_cache");
+  auto &fp_cache = GetFootprintClusterCache();
+  of << "entries=" << fp_cache.Size() << " hits=" << fp_cache.Hits() << " misses=" << fp_cache.Misses() << std::endl;
 }
 
 void ScopInfo::DumpScopDataAdvanced(std::ofstream &of) {
@@ -502,7 +507,14 @@ void ScopInfo::DumpSchTree(const std::string &file_name, const isl::schedule &sc
                   << std::string(mmu_info_.IsSpecGemm() ? "_specgemm" : "");
   if (user_config_.GetDumpPassIr()) {
 #if DUMP_IR
-    DumpSchTreeImpl(CreateDumpDir(final_file_name.str()), sch_dump);
+    if (common::IrDumpWriter::Enabled()) {
+      // the schedule is printed here as isl objects cannot be shared with the writer thread
+      std::string sch_str = DumpSchTreeToString(sch_dump);
+      common::IrDumpWriter::GetInstance().Push("poly/" + final_file_name.str(),
+                                               [sch_str](std::ostream &os) { os << sch_str; });
+    } else {
+      DumpSchTreeImpl(CreateDumpDir(final_file_name.str()), sch_dump);
+    }
     dump_schtree_count++;
 #endif
 
@@ -552,12 +564,7 @@ void AnalysisResult::DumpBufferDefInfos(std::ostream &out) {
 }
 
 void ScopInfo::DumpTransform(const std::string &file_name, PassInfo &pass_info) {
-  auto real_path = CreateDumpDir(file_name);
-  std::ofstream of;
-  of.open(real_path, std::ios::out);
-  if (!of.is_open()) {
-    return;
-  }
+  std::ostringstream of;
 
   PrintHeader(of, "group_filter_map");
   for (const auto &group : pass_info.group_filter_map_) {
@@ -590,7 +597,16 @@ void ScopInfo::DumpTransform(const std::string &file_name, PassInfo &pass_info)
     of << time_log << std::endl;
   }
 
-  of.close();
+  std::string log = of.str();
+  if (common::IrDumpWriter::Enabled()) {
+    common::IrDumpWriter::GetInstance().Push("poly/" + file_name, [log](std::ostream &os) { os << log; });
+    return;
+  }
+  std::ofstream file(CreateDumpDir(file_name), std::ios::out);
+  if (file.is_open()) {
+    file << log;
+    file.close();
+  }
 }
 }  // namespace poly
 }  // namespace ir
@@ -37,7 +37,7 @@ void CreateDirIfNotExist(const std::string &file_name);
 std::string DumpSchTreeToString(const isl::schedule &sch);
 void DumpSchTreeImpl(const std::string &file_name, const isl::schedule &sch);
 std::string PrettyPrintSchTree(const isl::schedule &sch);
-void PrintHeader(std::ofstream &of, const std::string &str);
+void PrintHeader(std::ostream &of, const std::string &str);
 void PrintHeader(const std::string &str);
 void DumpNode(std::ofstream &of, const air::Node *node);
 
@@ -109,8 +109,8 @@ Stmt GpuIslEmitter::EmitWrite(const isl::ast_node_user &node) {
   return Stmt();
 }
 
-Stmt GpuIslEmitter::EmitSync() {
-  return Evaluate::make(Call::make(Int(32), STORAGE_SYNC, {StringImm::make(SYNC_SCOP_SHARED)}, Call::Intrinsic));
+Stmt GpuIslEmitter::EmitSync(const std::string &scope) {
+  return Evaluate::make(Call::make(Int(32), STORAGE_SYNC, {StringImm::make(scope)}, Call::Intrinsic));
 }
 
 Stmt GpuIslEmitter::EmitStmt(const isl::ast_node_user &node) {
@@ -135,7 +135,7 @@ Stmt GpuIslEmitter::EmitStmt(const isl::ast_node_user &node) {
     }
     return EmitWrite(node);
   } else if (info_.IsSync(stmt_id)) {
-    return EmitSync();
+    return EmitSync(info_.IsWarpSync(stmt_id) ? SYNC_SCOP_WARP : SYNC_SCOP_SHARED);
   } else {
     return EmitUserStmt(node);
   }
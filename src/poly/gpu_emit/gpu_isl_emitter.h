@@ -64,7 +64,7 @@ class GpuIslEmitter : public IslEmitter {
   Stmt EmitAccessNodeFromPromoteAcsCall(isl::id var, const Node *node, Array<Expr> &args);
   Stmt EmitAccessNodeFromPromoteAcsProvide(isl::id var, const Node *node, Array<Expr> &args);
 
-  Stmt EmitSync();
+  Stmt EmitSync(const std::string &scope = SYNC_SCOP_SHARED);
   Stmt EmitAttr();  // thread_extent, virtual_thread
 
   Expr FindRealizeScope(const isl::id &var);
@@ -65,6 +65,9 @@ constexpr auto PARIS_REDUCE_LIB_SPACE = "paris_reduce";
 constexpr auto PARIS_REDUCE_LIB_NAME = "ParisReduce";
 constexpr auto AKG_REDUCE_RETURN_NAME = "AkgAtomicReturn";
 constexpr auto PARIS_REDUCE_RETURN_NAME = "ParisReturn";
+constexpr auto AKG_DETERMINISTIC_RETURN_NAME = "AkgDeterministicReturn";
+constexpr auto REDUCE_RETURN_TYPE_ATOMIC = "atomic";
+constexpr auto REDUCE_RETURN_TYPE_DETERMINISTIC = "deterministic";
 constexpr auto REDUCE_LIB_TYPE_FLAG = "reduceLibType";
 constexpr auto REDUCE_INIT_FLAG = "InitStmt";
 
@@ -18,6 +18,8 @@
  * \file gpu_reduce_emit_pass.cc
  */
 
+#include <algorithm>
+#include <limits>
 #include "emit_pass.h"
 #include "gpu_isl_emitter_reduce.h"
 
@@ -481,14 +483,49 @@ struct AtomicReturnData {
   Type output_tensor_data_type_info_;
   Expr atomic_rhs_;
   Stmt gm_write_stmt_;
+  // filled when the partials are folded by the last block instead of atomically
+  bool deterministic_{false};
+  Expr elem_id_;
+  Expr part_id_;
+  int64_t num_parts_{1};
+  int64_t num_elems_{1};
 };
 
+// The last block folds the partials of an output serially and the workspace is a static device array,
+// so the deterministic return is only chosen by itself when both stay small.
+constexpr int64_t MAX_DETERMINISTIC_PARTS = 256;
+constexpr int64_t MAX_DETERMINISTIC_WORKSPACE_BYTES = 32 * 1024 * 1024;
+
+bool UseAnyVar(const Expr &e, const std::vector<std::pair<Var, int64_t>> &vars) {
+  bool found = false;
+  PostOrderVisit(e, [&found, &vars](const NodeRef &node) {
+    for (const auto &v : vars) {
+      if (node.get() == v.first.get()) {
+        found = true;
+      }
+    }
+  });
+  return found;
+}
+
 class AtomicReturnStmtEmit : public IRMutator {
  public:
   explicit AtomicReturnStmtEmit(ScopInfo &scop_info) : scop_info_(scop_info) {}
 
   Stmt Mutate_(const AttrStmt *op, const Stmt &s) {
     auto key = op->attr_key;
+    if (key == air::ir::attr::thread_extent) {
+      auto iv = op->node.as<IterVarNode>();
+      CHECK(iv);
+      auto extent = op->value.as<IntImm>();
+      if (!IsStartsWith(iv->thread_tag, "blockIdx.")) {
+        return IRMutator::Mutate_(op, s);
+      }
+      block_vars_.emplace_back(iv->var, extent != nullptr ? extent->value : -1);
+      Stmt stmt = IRMutator::Mutate_(op, s);
+      block_vars_.pop_back();
+      return stmt;
+    }
     if (IsStartsWith(key, REDUCE_ATOMIC_FLAG)) {
       in_atomic_area_ = true;
       std::vector<std::string> strs = common::Split(key, "_");
@@ -516,11 +553,126 @@ class AtomicReturnStmtEmit : public IRMutator {
       atomic_data_.output_tensor_data_type_info_ = scop_info_.GetDtypeOf(op->func->func_name());
 
       ConstructAtomicReturnFuncName();
-      return MakeAtomicStmt();
+      atomic_data_.deterministic_ = PrepareDeterministicReturn(op);
+      return atomic_data_.deterministic_ ? MakeDeterministicStmt() : MakeAtomicStmt();
     }
     return IRMutator::Mutate_(op, s);
   }
 
+  Stmt Mutate_(const IfThenElse *op, const Stmt &s) {
+    conditions_.push_back(op->condition);
+    Stmt stmt = IRMutator::Mutate_(op, s);
+    conditions_.pop_back();
+    return stmt;
+  }
+
+  Stmt Mutate_(const For *op, const Stmt &s) {
+    auto extent = op->extent.as<IntImm>();
+    loop_vars_.emplace_back(op->loop_var, extent != nullptr ? extent->value : -1);
+    Stmt stmt = IRMutator::Mutate_(op, s);
+    loop_vars_.pop_back();
+    return stmt;
+  }
+
+  /*
+   * The blocks whose index does not appear in the output index all reduce into the same output element.
+   * Each of them gets a slot in a workspace of num_parts * num_elems partials; the slots are folded in
+   * order by the last block to arrive, which makes the result independent of the block schedule.
+   */
+  bool PrepareDeterministicReturn(const Provide *p) {
+    auto return_type = scop_info_.user_config_.GetReduceReturnType();
+    if (return_type == REDUCE_RETURN_TYPE_ATOMIC ||
+        scop_info_.user_config_.GetReduceLibType() != REDUCE_LIB_TYPE_ORIGIN) {
+      return false;
+    }
+    bool forced = return_type == REDUCE_RETURN_TYPE_DETERMINISTIC;
+    auto output = p->func.as<OperationNode>();
+    CHECK(output);
+    Array<Expr> shape = output->output_shape(p->value_index);
+    Expr elem_id = make_const(Int(32), 0);
+    int64_t num_elems = 1;
+    for (size_t i = shape.size(); i > 0; --i) {
+      auto extent = shape[i - 1].as<IntImm>();
+      if (extent == nullptr || i > p->args.size()) {
+        LOG_IF(WARNING, forced) << "Deterministic reduce return needs a static output shape, use atomic return.";
+        return false;
+      }
+      elem_id = elem_id + p->args[i - 1] * make_const(Int(32), num_elems);
+      num_elems *= extent->value;
+    }
+
+    std::vector<std::pair<Var, int64_t>> reduce_blocks;
+    for (const auto &block : block_vars_) {
+      bool in_index = false;
+      for (const auto &arg : p->args) {
+        in_index = in_index || UseAnyVar(arg, {block});
+      }
+      if (!in_index) {
+        reduce_blocks.push_back(block);
+      }
+    }
+    Expr part_id = make_const(Int(32), 0);
+    int64_t num_parts = 1;
+    for (const auto &block : reduce_blocks) {
+      if (block.second < 1) {
+        LOG_IF(WARNING, forced) << "Deterministic reduce return needs static grid, use atomic return.";
+        return false;
+      }
+      part_id = part_id + block.first * make_const(Int(32), num_parts);
+      num_parts *= block.second;
+    }
+    // a block that skips the return would leave the output unwritten, one returning twice would fold too early
+    bool guarded = std::any_of(conditions_.begin(), conditions_.end(),
+                               [&reduce_blocks](const Expr &cond) { return UseAnyVar(cond, reduce_blocks); });
+    for (const auto &loop : loop_vars_) {
+      bool in_index = false;
+      for (const auto &arg : p->args) {
+        in_index = in_index || UseAnyVar(arg, {loop});
+      }
+      guarded = guarded || (!in_index && loop.second != 1);
+    }
+    int64_t workspace = num_parts * num_elems * atomic_data_.output_tensor_data_type_info_.bytes();
+    if (num_parts <= 1 || guarded || workspace > std::numeric_limits<int>::max()) {
+      LOG_IF(WARNING, forced) << "Deterministic reduce return does not fit this kernel, use atomic return.";
+      return false;
+    }
+    if (!forced && (num_parts > MAX_DETERMINISTIC_PARTS || workspace > MAX_DETERMINISTIC_WORKSPACE_BYTES)) {
+      return false;
+    }
+    atomic_data_.elem_id_ = Simplify(elem_id);
+    atomic_data_.part_id_ = Simplify(part_id);
+    atomic_data_.num_parts_ = num_parts;
+    atomic_data_.num_elems_ = num_elems;
+    LOG(DEBUG) << "Deterministic reduce return for " << p->func->func_name() << ": " << num_parts << " parts of "
+               << num_elems << " elements.";
+    return true;
+  }
+
+  Stmt MakeDeterministicStmt() {
+    std::string func_name = AKG_REDUCE_LIB_SPACE;
+    func_name += "::";
+    func_name += AKG_DETERMINISTIC_RETURN_NAME;
+
+    Expr template_arg0 = make_const(atomic_data_.output_tensor_data_type_info_, 1);
+    Expr template_arg1 = StringImm::make(atomic_data_.akg_atomic_template_arg_);
+    auto p = atomic_data_.gm_write_stmt_.as<Provide>();
+    CHECK(p);
+    Expr output = Call::make(p->value.type(), p->func->func_name(), p->args, Call::Halide, p->func, 0);
+    output = Call::make(output.type(), "&", {output}, Call::Extern);
+    Expr op = Call::make(Int(32), atomic_data_.reduce_op_, {}, Call::Extern);
+
+    Array<Expr> args = {template_arg0,
+                        template_arg1,
+                        atomic_data_.atomic_rhs_,
+                        output,
+                        op,
+                        atomic_data_.elem_id_,
+                        atomic_data_.part_id_,
+                        make_const(Int(32), atomic_data_.num_parts_),
+                        make_const(Int(32), atomic_data_.num_elems_)};
+    return Evaluate::make(Call::make(Int(32), func_name, args, Call::Extern));
+  }
+
   void ConstructAtomicReturnFuncName() {
     std::string reduce_lib_namespace = "";
     std::string reduce_return_name = "";
@@ -575,6 +727,9 @@ class AtomicReturnStmtEmit : public IRMutator {
   ScopInfo &scop_info_;
   AtomicReturnData atomic_data_;
   bool in_atomic_area_{false};
+  std::vector<std::pair<Var, int64_t>> block_vars_;
+  std::vector<std::pair<Var, int64_t>> loop_vars_;
+  std::vector<Expr> conditions_;
 };
 
 class ConditionExprMod : public air::ir::IRMutator {
@@ -683,6 +838,7 @@ class DeleteComplicatedSync : public IRMutator {
         auto name = call->name;
         if (name == STORAGE_SYNC) {
           emit_sync_ = true;
+          last_sync_scope_ = SyncScope(call);
         } else {
           emit_sync_ = false;
         }
@@ -717,8 +873,9 @@ class DeleteComplicatedSync : public IRMutator {
     if (value.as<Call>()) {
       auto call = value.as<Call>();
       auto name = call->name;
+      // a warp sync does not cover a block sync right after it
       if (name == STORAGE_SYNC) {
-        if (emit_sync_) {
+        if (emit_sync_ && (last_sync_scope_ != SYNC_SCOP_WARP || SyncScope(call) == SYNC_SCOP_WARP)) {
           return Stmt();
         }
       }
@@ -727,7 +884,13 @@ class DeleteComplicatedSync : public IRMutator {
   }
 
  private:
+  static std::string SyncScope(const Call *call) {
+    auto scope = call->args.empty() ? nullptr : call->args[0].as<StringImm>();
+    return scope != nullptr ? scope->value : SYNC_SCOP_SHARED;
+  }
+
   bool emit_sync_{false};
+  std::string last_sync_scope_;
 };
 
 Stmt EmitForReduce(Stmt stmt, ScopInfo &scop_info) {
@@ -546,7 +546,7 @@ Stmt EmitTensorCoreHelper::MakeFragmentElemTransform(Expr op_name) {
   auto node_a = node_;
 
   auto call_b = data_for_elemwise_.b.as<Call>();
-  if (call_b) {
+  if (call_b && call_b->call_type == Call::Halide) {
     key_ = air::ir::TensorKey{call_b->func, call_b->value_index};
     call_ = call_b;
     buffer_node_ = data_for_elemwise_.node_b;
@@ -599,11 +599,14 @@ Stmt EmitTensorCoreHelper::MakeFragmentElemTransform(Expr op_name) {
     Buffer buffer_a(data_for_elemwise_.node_a);
     Buffer buffer = Downcast<Buffer>(node_c[0]);
 
-    Stmt stmt = Evaluate::make(
-        Call::make(Handle(), air::ir::intrinsic::akg_fragment_elem,
-                  {buffer->data, fragment_offset_[buffer->elem_offset], buffer_a->data,
-                   fragment_offset_[buffer_a->elem_offset], Expr(data_for_elemwise_.b),
-                   op_name}, Call::Intrinsic));
+    // the operand b is a scalar or the address of a broadcast vector, unary epilogues have none
+    Array<Expr> args = {buffer->data, fragment_offset_[buffer->elem_offset], buffer_a->data,
+                        fragment_offset_[buffer_a->elem_offset]};
+    if (data_for_elemwise_.b.defined()) {
+      args.push_back(data_for_elemwise_.b);
+    }
+    args.push_back(op_name);
+    Stmt stmt = Evaluate::make(Call::make(Handle(), air::ir::intrinsic::akg_fragment_elem, args, Call::Intrinsic));
     fragment_offset_.clear();
     stmt = AttrStmt::make(node_c, "buffer_bind_scope", tuple_c, stmt);
     stmt = AttrStmt::make(node_a, "buffer_bind_scope", tuple_a, stmt);
@@ -751,14 +754,19 @@ class ModifyTheLocalOffset : public IRMutator {
         return stmt;
       }
       const Call *value = op->value.as<Call>();
-      if (value != nullptr) {
+      if (value != nullptr && value->call_type == Call::Halide) {
         Stmt stmt = ModifyTheOpIndexOfLoadFill(op, GetFragmentIndex(op));
         frag_load_new_.insert(stmt.as<Provide>());
         return stmt;
       }
 
+      SetFragmentAxes(op);
+      vector_kind_.clear();
       Stmt stmt = ModifyTheOpIndexOfSync(op, GetFragmentIndex(op));
       frag_load_new_.insert(stmt.as<Provide>());
+      if (!vector_kind_.empty()) {
+        frag_vector_new_[stmt.as<Provide>()] = vector_kind_;
+      }
       return stmt;
     }
 
@@ -787,6 +795,12 @@ class ModifyTheLocalOffset : public IRMutator {
   }
 
   Expr Mutate_(const Call *op, const Expr &e) {
+    if (sync_value_mod && op->call_type != Call::Halide) {
+      return IRMutator::Mutate_(op, e);
+    }
+    if (sync_value_mod && !tensor_core_info_.frag_reg_.count(op->name) && op->args.size() == 1) {
+      return GetVectorIndex(op);
+    }
     if (sync_value_mod) {
       Array<Expr> real_index;
       if (scop_info_.user_config_.GetEnableConvTensorCore()) {
@@ -878,6 +892,34 @@ class ModifyTheLocalOffset : public IRMutator {
     return new_index;
   }
 
+  // The last var of each index is the one of the wmma interface, see GetFragmentIndex.
+  const Variable *GetWmmaVar(const Expr &index) {
+    auto used_vars = ExprUsedVarsVisitor().Run(index);
+    return used_vars.empty() ? nullptr : used_vars.back();
+  }
+
+  void SetFragmentAxes(const Provide *op) {
+    auto call = frag_load_[op].as<Call>();
+    CHECK(call);
+    auto size = call->args.size();
+    CHECK_GE(size, 2);
+    row_var_ = GetWmmaVar(call->args[size - 2]);
+    col_var_ = GetWmmaVar(call->args[size - 1]);
+  }
+
+  // A vector broadcast over the fragment is read in place by the epilogue, from the element of the first row
+  // (row vector) or the first column (col vector) of the tile.
+  Expr GetVectorIndex(const Call *op) {
+    const Variable *var = GetWmmaVar(op->args[0]);
+    CHECK(var != nullptr && (var == col_var_ || var == row_var_))
+      << "Cannot broadcast " << op->name << " along an axis of the fragment";
+    vector_kind_ = (var == col_var_) ? ROW_VECTOR : COL_VECTOR;
+    Map<Var, Expr> vmap;
+    vmap.Set(Var(GetObjPtr(var)), make_const(var->type, 0));
+    Array<Expr> tile_index = {Simplify(Substitute(op->args[0], vmap))};
+    return Call::make(op->type, op->name, tile_index, op->call_type, op->func, op->value_index);
+  }
+
   Stmt ModifyTheOpIndexOfLoadFill(const Provide *op, Array<Expr> real_index) {
     return Provide::make(op->func, op->value_index, op->value, real_index);
   }
@@ -917,9 +959,13 @@ class ModifyTheLocalOffset : public IRMutator {
   std::unordered_map<const Provide *, Expr> frag_store_;
   std::unordered_set<const Provide *> frag_load_new_;
   std::unordered_set<const Provide *> frag_store_new_;
+  std::unordered_map<const Provide *, std::string> frag_vector_new_;
   std::vector<const For *> vec_for_vars_;
   int for_count_{0};
   bool sync_value_mod{false};
+  const Variable *row_var_{nullptr};
+  const Variable *col_var_{nullptr};
+  std::string vector_kind_;
 };
 
 class TensorCoreInterfaceEmit : public IRMutator {
@@ -928,7 +974,8 @@ class TensorCoreInterfaceEmit : public IRMutator {
       : tensor_core_info_(info),
         scop_info_(scop_info),
         frag_load_(warp.frag_load_new_),
-        frag_store_(warp.frag_store_new_) {}
+        frag_store_(warp.frag_store_new_),
+        frag_vector_(warp.frag_vector_new_) {}
 
   Stmt Mutate_(const Provide *op, const Stmt &s) {
     Stmt stmt = IRMutator::Mutate_(op, s);
@@ -940,7 +987,7 @@ class TensorCoreInterfaceEmit : public IRMutator {
       }
 
       const Call *value = op->value.as<Call>();
-      if (value != nullptr) {
+      if (value != nullptr && value->call_type == Call::Halide) {
         for_count_ = DATA_LOAD_STORE_FOR_DEPTH;
         return EmitLoadStmt(stmt);
       }
@@ -950,9 +997,10 @@ class TensorCoreInterfaceEmit : public IRMutator {
       }
 
       Array<Expr> elemwise = GetBinaryOpExprChildren(op->value);
-      if (!elemwise.empty()) {
+      if (!elemwise.empty() || GetUnaryOpExprChild(op->value).defined()) {
         for_count_ = DATA_COMPUTE_FOR_DEPTH;
-        return EmitFragmentElem(stmt);
+        auto it = frag_vector_.find(op);
+        return EmitFragmentElem(stmt, it != frag_vector_.end() ? it->second : "");
       }
 
       return stmt;
@@ -1129,15 +1177,34 @@ class TensorCoreInterfaceEmit : public IRMutator {
     return helper.MakeStoreTransform();
   }
 
-  Stmt EmitFragmentElem(Stmt stmt) {
+  // The epilogues run on the fragment elements in registers, see akg_fragment_elem.
+  Stmt EmitFragmentElem(Stmt stmt, const std::string &vector_kind) {
     auto op = stmt.as<Provide>();
     CHECK(op);
 
+    Expr a;
+    Expr b;
+    Expr op_name;
     auto elem = GetBinaryOpExprChildren(op->value);
-    Expr op_name = GetBinaryOpName(op->value);
-
-    Expr a = elem[0];
-    Expr b = elem[1];
+    if (elem.empty()) {
+      a = GetUnaryOpExprChild(op->value);
+      op_name = Expr(op->value.as<Call>()->name);
+    } else {
+      a = elem[0];
+      b = elem[1];
+      op_name = GetBinaryOpName(op->value);
+      CHECK(op_name.defined()) << "Unsupported fragment epilogue: " << op->value;
+    }
+    if (!vector_kind.empty()) {
+      // only marked for the tiles of the akg layout, see IsBroadcastVector
+      CHECK_EQ(tensor_core_info_.wmma_scope_, "akg") << "Vector epilogues need the akg wmma fragment layout";
+      auto call_a = a.as<Call>();
+      if (call_a != nullptr && !tensor_core_info_.frag_reg_.count(call_a->name)) {
+        std::swap(a, b);
+      }
+      op_name = Expr(op_name.as<StringImm>()->value + "_" + vector_kind);
+      b = Call::make(Handle(), air::ir::intrinsic::tvm_address_of, {b}, Call::PureIntrinsic);
+    }
     auto left_expr = MakeLeftCallFromProvide(op);
     Expr c = left_expr;
 
@@ -1165,6 +1232,7 @@ class TensorCoreInterfaceEmit : public IRMutator {
   bool sync_stmt_{false};
   std::unordered_set<const Provide *> frag_load_;
   std::unordered_set<const Provide *> frag_store_;
+  std::unordered_map<const Provide *, std::string> frag_vector_;
   std::stack<const For *> st;
   std::vector<const For *> vec_for_vars_;
   int for_count_{0};
@@ -1404,15 +1472,7 @@ Stmt EmitForTensorCoreDesignOne(Stmt stmt, TensorCoreInfo &info) {
 }
 
 bool CheckTileValid(Tile tile, TensorCoreInfo &info) {
-  if (tile.m == 16 && tile.n == 16 && tile.k == 4) {
-    info.wmma_scope_ = "akg";
-    return true;
-  }
-  if (tile.m == 16 && tile.n == 16 && tile.k == 8) {
-    info.wmma_scope_ = "akg";
-    return true;
-  }
-  if (tile.m == 32 && tile.n == 32 && tile.k == 4) {
+  if (IsAkgWmmaTile(tile.m, tile.n, tile.k)) {
     info.wmma_scope_ = "akg";
     return true;
   }
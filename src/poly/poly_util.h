@@ -348,6 +348,7 @@ constexpr auto THREAD_IDX_Y = "threadIdx.y";
 constexpr auto THREAD_IDX_Z = "threadIdx.z";
 
 constexpr auto SYNC_FLAG = "_sync_";
+constexpr auto WARP_SYNC_FLAG = "_warpSync_";
 constexpr auto STORAGE_SYNC = "tvm_storage_sync";
 constexpr auto REDUCE = "reduce";
 constexpr auto SYNC_SCOP_WARP = "warp";
@@ -356,6 +357,8 @@ constexpr auto SYNC_SCOP_GLOBAL = "global";
 
 constexpr auto ROW_MAJOR = "row_major";
 constexpr auto COL_MAJOR = "col_major";
+constexpr auto ROW_VECTOR = "row_vector";
+constexpr auto COL_VECTOR = "col_vector";
 constexpr auto REDUCE_AREA_FLAG = "reduce_area";
 
 /******************************************************
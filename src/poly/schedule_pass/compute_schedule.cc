@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #include "compute_schedule.h"
+#include "poly/schedule_pass/computed_schedule_cache.h"
 
 namespace akg {
 namespace ir {
@@ -220,13 +221,42 @@ isl::union_pw_aff ComputeSchedule::GenerateNewAffine(const isl::union_pw_aff &sw
   return new_aff;
 };
 
+std::string ComputeSchedule::IslOptionsKey() {
+  auto &config = scop_info_.user_config_;
+  std::string key;
+  for (bool flag : {config.GetComputeReschedule(), config.GetDisableScheduleShift(),
+                    config.GetEnableScheduleMaxConstant(), config.GetDisableLoopReversal(),
+                    config.GetDisableLoopFusion()}) {
+    key += flag ? '1' : '0';
+  }
+  return key;
+}
+
+isl::schedule ComputeSchedule::ComputeOrReuse() {
+  auto cache = ComputedScheduleCache::Current();
+  if (cache == nullptr) {
+    return pass_info_.constraints_.compute_schedule();
+  }
+  std::string key = IslOptionsKey() + "\n" + pass_info_.constraints_.to_str();
+  std::string cached;
+  if (cache->Find(key, &cached)) {
+    isl_schedule *sch = isl_schedule_read_from_str(pass_info_.constraints_.ctx().get(), cached.c_str());
+    if (sch != nullptr) {
+      return isl::manage(sch);
+    }
+  }
+  auto computed_sch = pass_info_.constraints_.compute_schedule();
+  cache->Insert(key, computed_sch.to_str());
+  return computed_sch;
+}
+
 isl::schedule ComputeSchedule::Run(isl::schedule sch) {
   if (scop_info_.user_config_.GetModScheduleShift()) {
     pass_info_.dependences_ = ModDependences(pass_info_.dependences_);
   }
   pass_info_.constraints_ = MakeScheduleConstraints(sch, pass_info_);
   SetIslOptions();
-  auto computed_sch = pass_info_.constraints_.compute_schedule();
+  auto computed_sch = ComputeOrReuse();
   if (scop_info_.user_config_.GetTarget() == TARGET_CUDA) {
     computed_sch = PermuteOuterBand(computed_sch);
   }
@@ -39,6 +39,10 @@ class ComputeSchedule : public SchedulePass {
 
   void SetIslOptions();
 
+  // computes the schedule of the constraints, or reuses the one computed for identical constraints in the
+  // cache of the current ComputedScheduleCacheScope
+  isl::schedule ComputeOrReuse();
+
   isl::union_map ModDependences(const isl::union_map &dependences);
   
   isl::schedule PermuteOuterBand(const isl::schedule sch);
@@ -48,6 +52,8 @@ class ComputeSchedule : public SchedulePass {
 
 
  private:
+  std::string IslOptionsKey();
+
   PassInfo &pass_info_;
 
   ScopInfo &scop_info_;
@@ -0,0 +1,56 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "poly/schedule_pass/computed_schedule_cache.h"
+
+namespace akg {
+namespace ir {
+namespace poly {
+namespace {
+thread_local ComputedScheduleCache *g_computed_schedule_cache = nullptr;
+}  // namespace
+
+bool ComputedScheduleCache::Find(const std::string &key, std::string *sch) const {
+  auto it = schedules_.find(key);
+  if (it == schedules_.end()) {
+    return false;
+  }
+  *sch = it->second;
+  return true;
+}
+
+void ComputedScheduleCache::Insert(const std::string &key, const std::string &sch) {
+  if (schedules_.count(key) > 0) {
+    return;
+  }
+  if (order_.size() >= kMaxCachedSchedules) {
+    schedules_.erase(order_.front());
+    order_.pop_front();
+  }
+  schedules_.emplace(key, sch);
+  order_.push_back(key);
+}
+
+ComputedScheduleCache *ComputedScheduleCache::Current() { return g_computed_schedule_cache; }
+
+ComputedScheduleCacheScope::ComputedScheduleCacheScope(ComputedScheduleCache *cache)
+    : prev_(g_computed_schedule_cache) {
+  g_computed_schedule_cache = cache;
+}
+
+ComputedScheduleCacheScope::~ComputedScheduleCacheScope() { g_computed_schedule_cache = prev_; }
+}  // namespace poly
+}  // namespace ir
+}  // namespace akg
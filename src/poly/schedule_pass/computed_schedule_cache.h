@@ -0,0 +1,61 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef POLY_COMPUTED_SCHEDULE_CACHE_H_
+#define POLY_COMPUTED_SCHEDULE_CACHE_H_
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+namespace akg {
+namespace ir {
+namespace poly {
+/*
+ * Tuning candidates of one kernel only differ in tiling and mapping attrs, so they build the same
+ * schedule constraints again and again. The computed schedules are kept as strings, since every
+ * candidate lowers with its own isl ctx, and are keyed by the printed constraints together with the
+ * options that steer the isl scheduler. A cache belongs to the prefix of one kernel and is only used
+ * while a ComputedScheduleCacheScope holds it, so no schedule is reused across kernels.
+ */
+class ComputedScheduleCache {
+ public:
+  static constexpr size_t kMaxCachedSchedules = 16;
+
+  bool Find(const std::string &key, std::string *sch) const;
+  void Insert(const std::string &key, const std::string &sch);
+  size_t Size() const { return schedules_.size(); }
+
+  /*! \return The cache of the innermost scope of the current thread, or nullptr if there is none. */
+  static ComputedScheduleCache *Current();
+
+ private:
+  std::unordered_map<std::string, std::string> schedules_;
+  std::deque<std::string> order_;
+};
+
+class ComputedScheduleCacheScope {
+ public:
+  explicit ComputedScheduleCacheScope(ComputedScheduleCache *cache);
+  ~ComputedScheduleCacheScope();
+
+ private:
+  ComputedScheduleCache *prev_{nullptr};
+};
+}  // namespace poly
+}  // namespace ir
+}  // namespace akg
+
+#endif  // POLY_COMPUTED_SCHEDULE_CACHE_H_
@@ -309,10 +309,9 @@ void MemoryManager::CollectBufferFootprintDefInfo(BufferDefInfo &tensor_info, co
     tensor_info.IsBindCopyinDataFlow()) {
     writes = writes.unite(scop_info_.analysis_result_.GetBindCopyin());
   }
-  tensor_info.footprints_cluster = TensorFootprintCluster::HoistBufferFootprintCluster(
+  tensor_info.footprints_cluster = scop_info_.analysis_result_.GetFootprintClusterCache().HoistBufferFootprintCluster(
     schedule_prom, tensor_info.ancester_tensor_id, scop_info_.analysis_result_.GetReads(),
-    scop_info_.analysis_result_.GetCopyin(), writes,
-    scop_info_.analysis_result_.GetFakeCopyin());
+    scop_info_.analysis_result_.GetCopyin(), writes, scop_info_.analysis_result_.GetFakeCopyin());
   if (tensor_info.footprints_cluster != nullptr) {
     tensor_info.footprint_cluster_map.emplace_back(std::make_pair(node, tensor_info.footprints_cluster));
     GatherBufferFootprintDefInfo(node, tensor_info);
@@ -17,6 +17,7 @@
 #include "mapping_outer_band.h"
 #include "poly/schedule_pass_gpu/operator_mapping_strategy.h"
 
+#include <algorithm>
 #include <numeric>
 
 #include "poly/schedule_tree_util.h"
@@ -62,6 +63,10 @@ isl::schedule_node MappingOuterBand::DoThreadSynchronization(const isl::schedule
             [](Synchronization s1, Synchronization s2) { return s1.pos >= s2.pos; });
 
   // Step 4. Insert sync node (extension and filter) in the sequence node
+  size_t num_warp_sync = std::count_if(all_syncs.begin(), all_syncs.end(),
+                                       [](const Synchronization &s) { return s.level == SyncLevel::WARP; });
+  LOG(DEBUG) << "Thread synchronization of a sequence with " << node.n_children() << " children: "
+             << all_syncs.size() - num_warp_sync << " block sync, " << num_warp_sync << " warp sync.";
   for (const auto &sync : all_syncs) {
     auto target = sync_node.child(sync.pos).child(0);
     sync_node = sync_manager.InsertExtensionNode(target, sync.level, true).parent().parent();
@@ -108,7 +113,14 @@ SyncCandidate *MappingOuterBand::InitSyncLinkedList(const isl::schedule_node &se
                                                     const isl::multi_union_pw_aff &domain_to_thread,
                                                     const isl::multi_union_pw_aff &domain_to_warp) {
   auto context_params = scop_info_.analysis_result_.GetContextParams();
-  auto dependency = pass_info_.dependences_;
+  // Only instances that touch one memory location, at least one of them writing it, can race across threads.
+  // The other dependences, e.g. the ones forced between liveouts, order the schedule but need no barrier.
+  auto reads = scop_info_.analysis_result_.GetReads().domain_factor_domain();
+  auto writes = scop_info_.analysis_result_.GetWrites().domain_factor_domain();
+  auto conflicts = writes.apply_range(writes.reverse())
+                     .unite(writes.apply_range(reads.reverse()))
+                     .unite(reads.apply_range(writes.reverse()));
+  auto dependency = pass_info_.dependences_.intersect(conflicts);
   auto seq_len = static_cast<int>(seq_node.n_children());
   auto root = std::unique_ptr<SyncCandidate>(new (std::nothrow) SyncCandidate(-1, seq_len));
   CHECK(root) << "memory alloc fail.";
@@ -21,6 +21,7 @@
 #include "poly/scop.h"
 #include "poly/dma_inject.h"
 #include "poly/poly_util.h"
+#include "poly/tiling/tiling_utils.h"
 
 namespace akg {
 namespace ir {
@@ -258,7 +259,8 @@ void RegisterMemoryManager::CreateTensorCluster(const isl::schedule_node &node,
                                   nullptr,
                                   isl::union_map::empty(isl::space(scop_info_.ctx_, 0))};
     promoted_info.footprints_cluster =
-      TensorFootprintCluster::HoistBufferFootprintCluster(outer_sch, item, reads, copyin, writes, fake_copyin);
+      scop_info_.analysis_result_.GetFootprintClusterCache().HoistBufferFootprintCluster(outer_sch, item, reads, copyin,
+                                                                                          writes, fake_copyin);
     if (promoted_info.footprints_cluster != nullptr) {
       promoted_info.footprint_cluster_map.emplace_back(std::make_pair(node, promoted_info.footprints_cluster));
       promoted_infos.push_back(promoted_info);
@@ -300,6 +302,21 @@ void RegisterMemoryManager::IsOutofMemory(std::vector<BufferDefInfo> promoted_in
       }
     }
   }
+
+  // tensor core fragments are sized for the warp layout and must stay in registers
+  if (memory_exceeding_ || scop_info_.user_config_.GetEnableTensorCoreUsePoly()) {
+    return;
+  }
+  OccupancyCalculator calculator;
+  auto regs_per_thread = OccupancyCalculator::EstimateRegsPerThread(static_cast<int64_t>(total_alloc_size));
+  auto info =
+    calculator.Estimate(alloc_threads, regs_per_thread, scop_info_.analysis_result_.GetSharedBytesPerBlock());
+  if (info.occupancy * 100 < scop_info_.user_config_.GetMinOccupancyPercent()) {
+    LOG(DEBUG) << "Register promotion needs about " << regs_per_thread << " registers per thread, occupancy "
+               << info.occupancy << " (limited by " << info.limiter << ") is below "
+               << scop_info_.user_config_.GetMinOccupancyPercent() << "%, try to promote at a deeper band.";
+    memory_exceeding_ = true;
+  }
 }
 
 void RegisterMemoryManager::GatherBufferFootprintDefInfo(const isl::schedule_node &node, BufferDefInfo &tensor_info) {
@@ -15,12 +15,15 @@
  */
 
 #include "shared_memory_manager.h"
+#include "build_module.h"
 #include "poly/schedule_tree_util.h"
 #include "poly/scop.h"
 #include "poly/dma_inject.h"
 #include "poly/poly_util.h"
+#include "poly/tiling/tiling_utils.h"
 #include <vector>
 #include <numeric>
+#include <unordered_set>
 
 namespace akg {
 namespace ir {
@@ -51,6 +54,7 @@ isl::schedule SharedMemoryManager::Run(isl::schedule sch) {
   bank_conflict_ = scop_info_.user_config_.GetEnableBankConflict();
   shared_inversed_thread_map_ = scop_info_.user_config_.GetSharedInversedThreadMap();
   shared_vector_align_ = scop_info_.user_config_.GetSharedVectorAlign();
+  pack_branches_ = scop_info_.user_config_.GetEnablePackSharedMemory() && CanPackBranches(root);
 
   // collect all bands at the given depth in the schedule tree
   size_t remain_memory = common::SHARED_MEMORY_SIZE;
@@ -61,6 +65,10 @@ isl::schedule SharedMemoryManager::Run(isl::schedule sch) {
   } else {
     root = HoistSharedMemoryOnDepth(root, remain_memory, depth_).root();
   }
+  if (ArenaBytes() < promoted_bytes_) {
+    LOG(DEBUG) << "Shared memory arena: " << ArenaBytes() << " bytes for " << promoted_bytes_ << " promoted bytes.";
+  }
+  scop_info_.analysis_result_.RecordSharedBytesPerBlock(static_cast<int64_t>(ArenaBytes()));
   bool unroll_shared = scop_info_.user_config_.GetUnrollShared();
   root = MapCopiesToThreads(root, unroll_shared);
   schedule_ = root.get_schedule();
@@ -103,6 +111,11 @@ isl::schedule_node SharedMemoryManager::HoistSharedMemoryOnDepth(const isl::sche
                     << "be promoted.";
           return node;
         }
+        // the memory of the other branches is reused when PackSharedMemory overlaps them, only the promotions
+        // of this branch are live here
+        cur_branch_ = PromotionBranch(node_splitted);
+        size_t used = pack_branches_ ? branch_bytes_[cur_branch_] : promoted_bytes_;
+        remain_memory = common::SHARED_MEMORY_SIZE > used ? common::SHARED_MEMORY_SIZE - used : 0;
         res_node = ManageToShareBelow(this->schedule_, node_splitted, remain_memory);
       }
     }
@@ -482,7 +495,8 @@ void SharedMemoryManager::CreateClusterList(const isl::schedule_node &node, cons
                                                 nullptr,
                                                 isl::union_map::empty(isl::space(scop_info_.ctx_, 0))};
     promoted_info.footprints_cluster =
-      TensorFootprintCluster::HoistBufferFootprintCluster(outer_sch, item, reads, copyin, writes, fake_copyin);
+      scop_info_.analysis_result_.GetFootprintClusterCache().HoistBufferFootprintCluster(outer_sch, item, reads, copyin,
+                                                                                          writes, fake_copyin);
     if (promoted_info.footprints_cluster != nullptr) {
       promoted_info.footprint_cluster_map.emplace_back(std::make_pair(node, promoted_info.footprints_cluster));
       scop_info_.analysis_result_.buffer_def_infos_.push_back(promoted_info);
@@ -521,7 +535,10 @@ void SharedMemoryManager::GatherBufferFootprintDefInfo(const isl::schedule_node
   Tensor tensor = placeholder(shapes, type, cluster_id.get_name());
   const Buffer buffer = decl_buffer(shapes, scop_info_.GetDtypeOf(tensor_id), cluster_id.get_name());
   scop_info_.user_config_.SetBind(tensor, buffer);
-  if (scop_info_.user_config_.GetVectorLoadType()) {
+  // atomicAdd has no vector form, so the output of a split-K GEMM is copied out of shared memory by scalars
+  bool split_k_output = g_attrs.GetInt(kGemmSplitKPlan, 1) > 1 && scop_info_.user_config_.GetEnableMatmul() &&
+                        tensor_id.get_name() == GetMatmulTensorsName(scop_info_)[MATRIX_C];
+  if (scop_info_.user_config_.GetVectorLoadType() && !split_k_output) {
     scop_info_.analysis_result_.RecordSharedTensorBitsMap(tensor_id.get_name(),
                                                           scop_info_.GetDtypeOf(tensor_id).bits());
   }
@@ -580,9 +597,19 @@ isl::schedule_node SharedMemoryManager::HoistClusters(const isl::schedule_node &
       if (!need_shared_memory) {
         continue;
       }
+      // promotion only for data reuse or coalescing is dropped when it costs too much occupancy
+      bool is_optional = use_reuse_filter && !scop_info_.user_config_.GetEnableMatmul() &&
+                         !scop_info_.user_config_.HasTranspose();
+      if (is_optional && IsOccupancyBelowFloor(ArenaBytes(memory_requirement))) {
+        LOG(DEBUG) << "Skip promoting " << id.get_name() << " to shared memory: " << memory_requirement
+                   << " bytes would drop occupancy below " << scop_info_.user_config_.GetMinOccupancyPercent() << "%.";
+        continue;
+      }
       GatherBufferFootprintDefInfo(res_node, buffer_info);
       res_node = HoistToBlockThreadMemory(res_node, GpuMemType::SHARED, id, *(fp_cluster), true);
       remaining_memory -= memory_requirement;
+      promoted_bytes_ += memory_requirement;
+      branch_bytes_[cur_branch_] += common::AlignUp(memory_requirement, common::SHARED_MEMORY_ALIGN_BYTES);
 
       // collect active_buffer_footprints_ info for codegen
       auto out_schedule = LocalSchedule(res_node);
@@ -672,6 +699,87 @@ void SharedMemoryManager::UpdateDepth(const isl::schedule_node &root) {
   }
 }
 
+bool SharedMemoryManager::IsOccupancyBelowFloor(size_t shared_bytes) {
+  int64_t threads = 1;
+  auto thread_cfg = scop_info_.user_config_.GetThreadConfig();
+  if (thread_cfg != nullptr) {
+    for (size_t i = 0; i < thread_cfg->bound; ++i) {
+      threads *= thread_cfg->GetAt(i).second;
+    }
+  }
+  OccupancyCalculator calculator;
+  auto info = calculator.Estimate(threads, OccupancyCalculator::EstimateRegsPerThread(0),
+                                  static_cast<int64_t>(shared_bytes));
+  return info.occupancy * 100 < scop_info_.user_config_.GetMinOccupancyPercent();
+}
+
+/*
+ * Subtrees below different children of a sequence or set node run one after another. When no band
+ * encloses that node, no loop carries a promoted buffer from one child to the next, so the buffers
+ * of different children can share an arena (see PackSharedMemory).
+ */
+size_t SharedMemoryManager::PromotionBranch(const isl::schedule_node &node) {
+  std::vector<isl::schedule_node> path;
+  for (auto n = node; n.has_parent(); n = n.parent()) {
+    path.push_back(n);
+  }
+  for (auto it = path.rbegin(); it != path.rend(); ++it) {
+    auto parent = it->parent();
+    if (parent.isa<isl::schedule_node_band>()) {
+      return 0;
+    }
+    if (parent.isa<isl::schedule_node_sequence>() || parent.isa<isl::schedule_node_set>()) {
+      return it->child_position();
+    }
+  }
+  return 0;
+}
+
+/*
+ * A tensor promoted under several branches keeps one buffer live across them, which PackSharedMemory cannot
+ * overlap. So the branches only get their own budgets when no tensor is accessed under two of them, which is
+ * decided before any budget is handed out: otherwise all promotions share the budget of the block.
+ */
+bool SharedMemoryManager::CanPackBranches(const isl::schedule_node &root) {
+  auto node = root;
+  while (node.has_children() && !node.isa<isl::schedule_node_band>() && !node.isa<isl::schedule_node_sequence>() &&
+         !node.isa<isl::schedule_node_set>()) {
+    node = node.child(0);
+  }
+  if (!node.isa<isl::schedule_node_sequence>() && !node.isa<isl::schedule_node_set>()) {
+    return true;
+  }
+  auto accesses =
+    scop_info_.analysis_result_.GetReads().unite(scop_info_.analysis_result_.GetWrites()).domain_factor_domain();
+  std::unordered_set<std::string> accessed;
+  for (int i = 0; i < static_cast<int>(node.n_children()); ++i) {
+    auto filter = node.child(i).as<isl::schedule_node_filter>();
+    if (!filter) {
+      return false;
+    }
+    std::unordered_set<std::string> tensors;
+    accesses.intersect_domain(filter.get_filter()).range().foreach_set(
+      [&tensors](const isl::set &s) { tensors.insert(s.get_tuple_name()); });
+    for (const auto &name : tensors) {
+      if (!accessed.insert(name).second) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+size_t SharedMemoryManager::ArenaBytes(size_t extra_bytes) {
+  if (!pack_branches_) {
+    return promoted_bytes_ + extra_bytes;
+  }
+  size_t peak = branch_bytes_[cur_branch_] + common::AlignUp(extra_bytes, common::SHARED_MEMORY_ALIGN_BYTES);
+  for (const auto &it : branch_bytes_) {
+    peak = std::max(peak, it.second);
+  }
+  return peak;
+}
+
 bool SharedMemoryManager::UnderThreadMarker(size_t depth) {
   isl::schedule_node root = this->schedule_.get_root();
   auto bands = BandsContainingScheduleDepth(root, depth);
@@ -83,6 +83,13 @@ class SharedMemoryManager : public SchedulePass {
 
   isl::schedule_node HoistSharedMemoryOnMark(const isl::schedule_node &root, size_t &remain_memory, size_t depth);
 
+  bool IsOccupancyBelowFloor(size_t shared_bytes);
+
+  size_t PromotionBranch(const isl::schedule_node &node);
+  bool CanPackBranches(const isl::schedule_node &root);
+
+  size_t ArenaBytes(size_t extra_bytes = 0);
+
  private:
   ScopInfo &scop_info_;
   isl::schedule schedule_;
@@ -94,6 +101,12 @@ class SharedMemoryManager : public SchedulePass {
   bool hoist_tensor_c_ = true;
   bool shared_inversed_thread_map_{false};
   int shared_vector_align_{0};
+  size_t promoted_bytes_{0};
+  // aligned bytes promoted under each branch of the outermost sequence; distinct branches are never live together
+  std::map<size_t, size_t> branch_bytes_;
+  size_t cur_branch_{0};
+  // whether the branches get their own budgets, which needs PackSharedMemory to overlap their buffers
+  bool pack_branches_{true};
 };
 
 }  // namespace poly
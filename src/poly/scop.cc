@@ -15,8 +15,12 @@
  */
 #include "poly/scop.h"
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
+#include <unordered_set>
 
+#include "poly/dma_inject.h"
 #include "poly/scop_builder.h"
 #include "poly/poly_util.h"
 #include "poly/npu_isl_emitter.h"
@@ -53,9 +57,14 @@ isl::set CreateParamsSet(ScopInfo &info) {
   auto context = isl::set::universe(space);
   auto dynamic_shape = info.user_config_.GetDynamicShape();
   auto params = info.user_config_.GetParams();
+  auto params_rev_map = info.user_config_.GetParamsRevMap();
+  int bucket_bound = info.user_config_.GetShapeBucketBound();
   for (const auto &param : params) {
     isl::aff aff(isl::aff::param_on_domain(space, isl::id(info.GetCtx(), param.second->name_hint)));
     context = context & (aff > 0);
+    if (bucket_bound > 0 && params_rev_map[param.second->name_hint].as<Variable>() != nullptr) {
+      context = context & (aff <= bucket_bound);
+    }
     if (dynamic_shape.empty()) {
       continue;
     }
@@ -122,6 +131,9 @@ isl::schedule Scop::GenIsl() {
 
 isl::schedule Scop::Transform(const isl::schedule &input_schedule) {
   auto final_schedule = input_schedule;
+  // the footprint clusters are shared by the promotion passes of this transform only
+  auto &fp_cache = info_.analysis_result_.GetFootprintClusterCache();
+  fp_cache.Clear();
   SchedulePassMgr mgr(info_);
   if (info_.user_config_.GetTarget() == TARGET_CCE) {
     info_.user_config_.SetConsiderCoincidence(true);
@@ -189,6 +201,7 @@ isl::schedule Scop::Transform(const isl::schedule &input_schedule) {
   }
 
   if (final_schedule.get()) info_.analysis_result_.SetTransformedSchedule(final_schedule);
+  fp_cache.Clear();
   return final_schedule;
 }
 
@@ -219,6 +232,139 @@ size_t &AstNodeNum() {
   return n;
 }
 constexpr auto AST_NODE_ID_PREFIX = "__node_";
+constexpr auto UNROLL_AST_OPTION = "unroll";
+constexpr auto SEPARATE_AST_OPTION = "separate";
+constexpr auto ATOMIC_AST_OPTION = "atomic";
+// bands are degraded one per ast rebuild up to this limit, all the remaining ones at once beyond it
+constexpr size_t MAX_AST_BUDGET_REBUILDS = 8;
+
+isl_bool CountAstNode(__isl_keep isl_ast_node *node, void *user) {
+  ++*static_cast<size_t *>(user);
+  return isl_bool_true;
+}
+
+size_t CountAstNodes(const isl::ast_node &node) {
+  size_t n = 0;
+  static_cast<void>(isl_ast_node_foreach_descendant_top_down(node.get(), CountAstNode, &n));
+  return n;
+}
+
+bool IsExpandingLoopType(isl_ast_loop_type type) {
+  return type == isl_ast_loop_separate || type == isl_ast_loop_unroll;
+}
+
+bool IsExpandingAstOption(const isl::set &option) {
+  if (!option.has_tuple_name()) return false;
+  auto name = option.get_tuple_name();
+  return name == UNROLL_AST_OPTION || name == SEPARATE_AST_OPTION;
+}
+
+/*
+ * Returns "unroll" or "separate" when the loops of the band are unrolled or separated, either by
+ * the loop types of its members or by its ast build options, and an empty string otherwise.
+ */
+std::string GetExpandingKind(const isl::schedule_node_band &band) {
+  bool unroll = false;
+  bool separate = false;
+  for (int i = 0; i < static_cast<int>(band.n_member()); ++i) {
+    for (auto type : {isl_schedule_node_band_member_get_ast_loop_type(band.get(), i),
+                      isl_schedule_node_band_member_get_isolate_ast_loop_type(band.get(), i)}) {
+      unroll = unroll || type == isl_ast_loop_unroll;
+      separate = separate || type == isl_ast_loop_separate;
+    }
+  }
+  for (auto option : band.get_ast_build_options().get_set_list()) {
+    if (IsExpandingAstOption(option)) {
+      unroll = unroll || option.get_tuple_name() == UNROLL_AST_OPTION;
+      separate = separate || option.get_tuple_name() == SEPARATE_AST_OPTION;
+    }
+  }
+  return unroll ? UNROLL_AST_OPTION : (separate ? SEPARATE_AST_OPTION : "");
+}
+
+isl::schedule_node DegradeBandToAtomic(const isl::schedule_node &node) {
+  auto band = node.as<isl::schedule_node_band>();
+  for (int i = 0; i < static_cast<int>(band.n_member()); ++i) {
+    if (IsExpandingLoopType(isl_schedule_node_band_member_get_ast_loop_type(band.get(), i))) {
+      band = band.member_set_ast_loop_atomic(i);
+    }
+    if (IsExpandingLoopType(isl_schedule_node_band_member_get_isolate_ast_loop_type(band.get(), i))) {
+      band = band.member_set_isolate_ast_loop_atomic(i);
+    }
+  }
+  auto options = isl::union_set::empty(band.ctx());
+  for (auto option : band.get_ast_build_options().get_set_list()) {
+    if (IsExpandingAstOption(option)) option = option.set_tuple_name(ATOMIC_AST_OPTION);
+    options = options.unite(isl::union_set(option));
+  }
+  return band.set_ast_build_options(options);
+}
+
+// Bands are numbered in bottom-up order, which degrading does not change.
+isl::schedule DegradeBandsToAtomic(const isl::schedule &sch, const std::unordered_set<int> &bands) {
+  int band_idx = 0;
+  auto fn = [&band_idx, &bands](const isl::schedule_node &node) -> isl::schedule_node {
+    if (!node.isa<isl::schedule_node_band>()) return node;
+    return bands.count(band_idx++) > 0 ? DegradeBandToAtomic(node) : node;
+  };
+  return sch.root().map_descendant_bottom_up(fn).schedule();
+}
+
+// Unrolled bands come first as they copy the body once per iteration, then inner bands before outer ones.
+std::vector<std::pair<int, std::string>> CollectExpandingBands(const isl::schedule &sch) {
+  std::vector<std::pair<int, std::string>> bands;
+  int band_idx = 0;
+  auto fn = [&band_idx, &bands](const isl::schedule_node &node) -> isl::schedule_node {
+    if (!node.isa<isl::schedule_node_band>()) return node;
+    auto kind = GetExpandingKind(node.as<isl::schedule_node_band>());
+    if (!kind.empty()) bands.emplace_back(band_idx, kind);
+    ++band_idx;
+    return node;
+  };
+  static_cast<void>(sch.root().map_descendant_bottom_up(fn));
+  std::stable_sort(bands.begin(), bands.end(),
+                   [](const std::pair<int, std::string> &a, const std::pair<int, std::string> &b) {
+                     return a.second == UNROLL_AST_OPTION && b.second != UNROLL_AST_OPTION;
+                   });
+  return bands;
+}
+
+/*
+ * Isolated, separated and unrolled loops copy the band body for every part or iteration. When the
+ * ast is larger than the node budget, the expanding bands are generated as atomic loops one at a
+ * time until it fits, so that the later passes and the code generation work on a bounded kernel.
+ * Tensor core scops are left alone, as their emitter matches the loops of the separated warp tiles.
+ */
+isl::ast_node FitAstNodeBudget(ScopInfo &info, const isl::schedule &sch, const isl::ast_node &ast_node,
+                               const std::function<isl::ast_node(const isl::schedule &)> &build_ast) {
+  if (info.user_config_.GetEnableTensorCore() || info.user_config_.GetEnableConvTensorCore()) return ast_node;
+  auto budget = static_cast<size_t>(std::max(info.user_config_.GetAstNodeBudget(), 0));
+  size_t num_nodes = CountAstNodes(ast_node);
+  if (budget == 0 || num_nodes <= budget) return ast_node;
+
+  auto res = ast_node;
+  auto schedule = sch;
+  auto bands = CollectExpandingBands(sch);
+  std::unordered_set<int> degraded;
+  for (size_t i = 0; i < bands.size() && num_nodes > budget;) {
+    size_t end = degraded.size() + 1 < MAX_AST_BUDGET_REBUILDS ? i + 1 : bands.size();
+    for (; i < end; ++i) {
+      degraded.insert(bands[i].first);
+      LOG(DEBUG) << "ast has " << num_nodes << " nodes over the budget " << budget << ", generate band "
+                 << bands[i].first << " as atomic instead of " << bands[i].second;
+    }
+    schedule = DegradeBandsToAtomic(sch, degraded);
+    res = build_ast(schedule);
+    num_nodes = CountAstNodes(res);
+  }
+  if (num_nodes > budget) {
+    LOG(DEBUG) << "ast has " << num_nodes << " nodes over the budget " << budget << " with " << degraded.size()
+               << " bands generated as atomic";
+  }
+  if (!degraded.empty()) info.DumpSchTree("ast_node_budget", schedule);
+  return res;
+}
+
 Stmt GenHalide(ScopInfo &info, const isl::schedule &sch, bool used_for_tile_out_band) {
   if (!used_for_tile_out_band) {
     // we should check the return value to be isl_stat_ok, but it returns isl_stat_error, so we skip this check.
@@ -251,6 +397,11 @@ Stmt GenHalide(ScopInfo &info, const isl::schedule &sch, bool used_for_tile_out_
   std::chrono::high_resolution_clock::time_point timer_start;
   TIMER_START;
   auto ast_node = builder.node_from(sch);
+  auto build_ast = [&builder, &node_info_repo](const isl::schedule &schedule) -> isl::ast_node {
+    node_info_repo.clear();
+    return builder.node_from(schedule);
+  };
+  ast_node = FitAstNodeBudget(info, sch, ast_node, build_ast);
   TIMER_SHOW("NodeFrom", std::string(info.mmu_info_.IsSpecGemm() ? "_specgemm" : ""));
 
   ast_node = CanonicalizeBlockInAst(ast_node);
@@ -16,6 +16,8 @@
 #ifndef POLY_SCOP_H_
 #define POLY_SCOP_H_
 
+#include <functional>
+
 #include "poly/scop_info.h"
 #include "poly/pass_info.h"
 
@@ -42,6 +44,9 @@ class Scop {
 };
 
 Stmt GenHalide(ScopInfo &info, const isl::schedule &, bool used_for_tile_out_band = false);
+size_t CountAstNodes(const isl::ast_node &node);
+isl::ast_node FitAstNodeBudget(ScopInfo &info, const isl::schedule &sch, const isl::ast_node &ast_node,
+                               const std::function<isl::ast_node(const isl::schedule &)> &build_ast);
 Stmt DsaHalideOptimizer(const Stmt &s, bool dynamic_shape = false);
 Stmt RestoreCombinedParams(Stmt stmt, ScopInfo &info);
 std::pair<TileSizes, std::deque<ParamInfo>> GenerateTiling(const isl::schedule &sch, ScopInfo &scop_info, Stmt body);
@@ -1457,6 +1457,13 @@ bool AnalysisResult::IsFakeCopyin(const isl::id &tensor_id) {
   return in_copyin_map;
 }
 
+TensorFootprintClusterCache &AnalysisResult::GetFootprintClusterCache() {
+  if (footprint_cluster_cache_ == nullptr) {
+    footprint_cluster_cache_ = std::make_shared<TensorFootprintClusterCache>();
+  }
+  return *footprint_cluster_cache_;
+}
+
 static std::string MemTypeToString(const MemType &memType) {
   switch (memType) {
     case MemType::BUF_:
@@ -166,6 +166,7 @@ struct MappingCfg {
 };
 
 class TensorFootprintCluster;
+class TensorFootprintClusterCache;
 struct BufferedFootPrintInfo {
   std::shared_ptr<TensorFootprintCluster> cluster;
   isl::union_map outer_schedule;
@@ -210,9 +211,13 @@ class UserConfig {
     ParseBoolAttr(attrs, "pragma_speedup_tiling", &pragma_speedup_tiling_);
     ParseBoolAttr(attrs, "pragma_allow_tail_tiling", &pragma_allow_tail_tiling_);
     ParseBoolAttr(attrs, "pragma_analyze_multicore", &pragma_analyze_multicore_);
+    ParseBoolAttr(attrs, "pragma_tiling_search", &pragma_tiling_search_);
+    ParseIntAttr(attrs, "pragma_tiling_search_time", &pragma_tiling_search_time_);
+    ParseIntAttr(attrs, "pragma_tiling_beam_width", &pragma_tiling_beam_width_);
     ParseIntAttr(attrs, "prune_tuning_space_level", &prune_tuning_space_level_);
     ParseBoolAttr(attrs, "pragma_checkcoincident", &tile_check_coincident_);
     ParseIntAttr(attrs, "max_unroll_loop", &max_unroll_loop_);
+    ParseIntAttr(attrs, "ast_node_budget", &ast_node_budget_);
     ParseBoolAttr(attrs, "unroll_shared", &unroll_shared_);
 
     ParseBoolAttr(attrs, "pragma_rmselfdep", &remove_self_dependence_);
@@ -263,6 +268,9 @@ class UserConfig {
       ParseBoolAttr(attrs, "use_shared_memory", &use_shared_memory_);
       ParseBoolAttr(attrs, "enable_bank_conflict_opt", &enable_bank_conflict_);
       ParseBoolAttr(attrs, "enable_one_dim_thread", &enable_one_dim_thread_);
+      ParseBoolAttr(attrs, "enable_wave_aligned_mapping", &enable_wave_aligned_mapping_);
+      ParseIntAttr(attrs, "min_occupancy_percent", &min_occupancy_percent_);
+      ParseBoolAttr(attrs, "enable_pack_shared_memory", &enable_pack_shared_memory_);
       ParseBoolAttr(attrs, "shared_inversed_thread_map", &shared_inversed_thread_map_);
       ParseBoolAttr(attrs, "enable_stitch_fusion", &enable_stitch_fusion_);
       ParseIntAttr(attrs, "shared_vector_align", &shared_vector_align_);
@@ -270,6 +278,7 @@ class UserConfig {
       ParseIntAttr(attrs, "shared_memory_depth", &shared_depth_);
       ParseStringAttr(attrs, "shared_memory_tensors", &shared_tensors_);
       ParseStringAttr(attrs, "reduce_lib_type", &reduce_lib_type_);
+      ParseStringAttr(attrs, "reduce_return_type", &reduce_return_type_);
       ParseStringAttr(attrs, "local_memory_tensors", &local_tensors_);
       ParseVectorLoadTypeAttr(attrs, "vector_load_type", &vector_load_type_);
     }
@@ -285,6 +294,8 @@ class UserConfig {
   bool GetIsDynamic() const { return is_dynamic_; }
   std::vector<NodeRef> GetDynamicShape() { return dynamic_shape_; }
   int GetDynamicShapeBound() const { return dynamic_shape_bound_; }
+  // a gpu kernel of a shape bucket takes its shape parameters up to the upper bound of the bucket
+  int GetShapeBucketBound() { return GetTarget() == TARGET_CUDA ? dynamic_shape_bound_ : 0; }
   bool GetTileSizeIsVar() const { return tile_size_is_var_; }
   bool GetOuterBandNeedSplit() const { return outer_band_need_split_; }
 
@@ -322,11 +333,16 @@ class UserConfig {
   bool GetPragmaAnalyzeReuseBuffer() const { return pragma_analyze_reuse_buffer_; }
   bool GetPragmaAllowTailTiling() const { return pragma_allow_tail_tiling_; }
   bool GetPragmaAnalyzeMulticore() const { return pragma_analyze_multicore_; }
+  bool GetPragmaTilingSearch() const { return pragma_tiling_search_; }
+  int GetPragmaTilingSearchTime() const { return pragma_tiling_search_time_; }
+  int GetPragmaTilingBeamWidth() const { return pragma_tiling_beam_width_; }
   int GetPruneTuningSpaceLevel() const { return prune_tuning_space_level_; }
   bool GetTileCheckCoincident() const { return tile_check_coincident_; }
   void SetTileCheckCoincident(const bool tile_check_coincident) { tile_check_coincident_ = tile_check_coincident; }
   int GetMaxUnrollLoop() const { return max_unroll_loop_; }
   void SetUnroll(const int max_unroll_loop) { this->max_unroll_loop_ = max_unroll_loop; }
+  int GetAstNodeBudget() const { return target_ == TARGET_CUDA ? ast_node_budget_ : 0; }
+  void SetAstNodeBudget(const int ast_node_budget) { this->ast_node_budget_ = ast_node_budget; }
   bool GetUnrollShared() const { return unroll_shared_; }
   void SetUnrollShared(const bool unroll_shared) { this->unroll_shared_ = unroll_shared; }
   void SetDisableLoopFusion(const bool disable_loop_fusion) { this->disable_loop_fusion_ = disable_loop_fusion; }
@@ -451,6 +467,10 @@ class UserConfig {
   bool GetEnableOneDimThread() { return enable_one_dim_thread_; }
   void SetEnableOneDimThread(bool enable_one_dim_thread) { enable_one_dim_thread_ = enable_one_dim_thread; }
 
+  bool GetEnableWaveAlignedMapping() { return enable_wave_aligned_mapping_; }
+  int GetMinOccupancyPercent() { return min_occupancy_percent_; }
+  bool GetEnablePackSharedMemory() { return enable_pack_shared_memory_; }
+
   bool UseRegisterMemory() { return use_register_memory_; }
   bool UseSharedMemory() { return use_shared_memory_; }
   void SetUseSharedMemory(bool use_shared_memory) { use_shared_memory_ = use_shared_memory; }
@@ -460,6 +480,7 @@ class UserConfig {
   void SetSharedTensors(std::string shared_tensors) { shared_tensors_ = shared_tensors; }
   std::string GetSharedTensors() { return shared_tensors_; }
   std::string GetReduceLibType() { return reduce_lib_type_; }
+  std::string GetReduceReturnType() { return reduce_return_type_; }
   std::string GetLocalTensors() { return local_tensors_; }
   void SetEnableBankConflict(bool enable_bank_conflict) { enable_bank_conflict_ = enable_bank_conflict; }
   bool GetEnableBankConflict() { return enable_bank_conflict_; }
@@ -610,11 +631,21 @@ class UserConfig {
   // one is named "origin"
   // one is named "paris"
   std::string reduce_lib_type_{"origin"};
+  // how block partials of a multi-block reduction reach the output: "atomic", "deterministic" or "auto".
+  // The workspace of the deterministic return is shared by all launches of the module, so it is opt-in for
+  // kernels whose launches are serialized.
+  std::string reduce_return_type_{"atomic"};
   // local memory tensor list
   std::string local_tensors_;
   // vectorization
   int vector_load_type_{0};
   bool enable_one_dim_thread_{false};
+  // adjust block mapping so that the grid fills whole waves on the device
+  bool enable_wave_aligned_mapping_{false};
+  // promotion stops before the estimated occupancy drops below this percentage
+  int min_occupancy_percent_{10};
+  // promotions under different branches of a sequence may overlap in one shared arena
+  bool enable_pack_shared_memory_{true};
 
   // tiling config
   std::string b_dim_;
@@ -629,9 +660,15 @@ class UserConfig {
   bool pragma_speedup_tiling_{false};
   bool pragma_allow_tail_tiling_{true};
   bool pragma_analyze_multicore_{true};
+  bool pragma_tiling_search_{false};
+  int pragma_tiling_search_time_{100};  // search budget in milliseconds
+  int pragma_tiling_beam_width_{4};
   int prune_tuning_space_level_{0};  // 0: no_prune; 1: prune mem-exceed; 2: prune aligned_mem-exceed
   bool tile_check_coincident_{true};
   int max_unroll_loop_{1};
+  // number of isl ast nodes above which separate/unroll bands are generated as atomic, 0 means no limit.
+  // Only gpu kernels are limited, the npu flow relies on its separated and unrolled bands.
+  int ast_node_budget_{5000};
   bool unroll_shared_{false};
   bool enable_bank_conflict_{false};
   bool shared_inversed_thread_map_{false};
@@ -733,6 +770,11 @@ struct Mma {
   int64_t k;
 };
 
+// Whether the accumulator fragments of a warp tile have the layout of the akg wmma library, see get_element_coord.
+inline bool IsAkgWmmaTile(int64_t m, int64_t n, int64_t k) {
+  return (m == 16 && n == 16 && (k == 4 || k == 8)) || (m == 32 && n == 32 && k == 4);
+}
+
 struct MmaConv {
   int64_t m;
   int64_t h;
@@ -892,6 +934,9 @@ class AnalysisResult {
   void RecordReduceDirection(const std::string reduce_direction) { reduce_direction_ = reduce_direction; }
   std::string GetReduceDirection() const { return reduce_direction_; }
 
+  void RecordSharedBytesPerBlock(int64_t shared_bytes) { shared_bytes_per_block_ = shared_bytes; }
+  int64_t GetSharedBytesPerBlock() const { return shared_bytes_per_block_; }
+
   void RecordReduceInitIds(isl::id reduce_init_id) { reduce_init_ids_.push_back(reduce_init_id); }
   std::vector<isl::id> GetReduceInitIds() const { return reduce_init_ids_; }
 
@@ -916,6 +961,9 @@ class AnalysisResult {
 
   bool IsFakeCopyin(const isl::id &tensor_id);
 
+  // footprint clusters shared by the npu and gpu promotion passes
+  TensorFootprintClusterCache &GetFootprintClusterCache();
+
  public:
   std::vector<std::pair<std::string, STMT_OP_TYPE>> stmt_type_;
   std::vector<std::pair<isl::union_set, BufferedFootPrintInfo>> active_buffer_footprints_;
@@ -926,6 +974,7 @@ class AnalysisResult {
   ReduceMap reduces_;
   ReduceTensorInfoMap reduce_tensor_info_;
   std::string reduce_direction_;
+  int64_t shared_bytes_per_block_{0};
   std::vector<isl::id> reduce_init_ids_;
   std::unordered_set<std::string> reduce_attrs_;
   std::unordered_set<std::string> not_reduce_attrs_;
@@ -969,7 +1018,8 @@ class AnalysisResult {
   std::unordered_map<std::string, int> shared_tensor_bits_map_;
   TensorScheduleRepo tensor_schedule_repo_;
   std::unordered_map<std::string, std::string> matrix_matmul_major_;
-  Mma mma_;
+  Mma mma_{0, 0, 0};
+  std::shared_ptr<TensorFootprintClusterCache> footprint_cluster_cache_;
 };
 
 class CubeInfo {
@@ -1135,7 +1185,8 @@ class ScopInfo {
   static bool IsGMLWrite(const isl::id &id) { return id.get_name() == std::string("GMLwrite"); }
   static bool IsGMWrite(const isl::id &id) { return id.get_name() == std::string("GMwrite"); }
   static bool IsGMRead(const isl::id &id) { return id.get_name() == std::string("GMread"); }
-  static bool IsSync(const isl::id &id) { return IsStartsWith(id.name(), SYNC_FLAG); }
+  static bool IsSync(const isl::id &id) { return IsStartsWith(id.name(), SYNC_FLAG) || IsWarpSync(id); }
+  static bool IsWarpSync(const isl::id &id) { return IsStartsWith(id.name(), WARP_SYNC_FLAG); }
   static bool IsRealize(const isl::id &id) { return IsStartsWith(id.get_name(), "REALIZE"); }
   static bool IsReduceInit(const isl::id &id) { return IsStartsWith(id.get_name(), "red_init"); }
   static bool IsReduceUpdate(const isl::id &id) { return IsStartsWith(id.get_name(), "red_update"); }
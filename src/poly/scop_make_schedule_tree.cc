@@ -184,24 +184,29 @@ class ScopMakeScheduleTree final : protected IRVisitor {
         accumulator = mp[MATRIX_C];
       }
       CHECK(accumulator != "") << "MatMul info not enough!";
+      auto IsMatmulTensor = [&matmul_map](const Call *call) -> bool {
+        return call != nullptr && matmul_map.find(call->name) != matmul_map.end();
+      };
       Array<Expr> elem_tensors = GetBinaryOpExprChildren(op->value);
       if (!elem_tensors.empty()) {
         auto left = elem_tensors[0].as<Call>();
         auto right = elem_tensors[1].as<Call>();
-        if ((left || right) && (matmul_map.find(left->name) != matmul_map.end() || matmul_map.find(right->name) != matmul_map.end())) {
+        if (IsMatmulTensor(left) || IsMatmulTensor(right)) {
           if (op->func->func_name() != accumulator) {
-            scop_info_.analysis_result_.RecordMatrixMatmulMap(op->func->func_name(), MATRIX_ELSE);
-            scop_info_.analysis_result_.RecordMatrixMatmulMajor(op->func->func_name(), ROW_MAJOR);
+            RecordMatrixElse(op->func->func_name());
           }
-          if (left && left->name != accumulator) {
-            scop_info_.analysis_result_.RecordMatrixMatmulMap(left->name, MATRIX_ELSE);
-            scop_info_.analysis_result_.RecordMatrixMatmulMajor(left->name, ROW_MAJOR);
+          // vectors broadcast over the tile are read in place by the fragment epilogue
+          bool commutative = op->value.as<Add>() || op->value.as<Mul>() || op->value.as<Max>() || op->value.as<Min>();
+          if (left && left->name != accumulator && !(commutative && IsBroadcastVector(left, op))) {
+            RecordMatrixElse(left->name);
           }
-          if (right && right->name != accumulator) {
-            scop_info_.analysis_result_.RecordMatrixMatmulMap(right->name, MATRIX_ELSE);
-            scop_info_.analysis_result_.RecordMatrixMatmulMajor(right->name, ROW_MAJOR);
+          if (right && right->name != accumulator && !IsBroadcastVector(right, op)) {
+            RecordMatrixElse(right->name);
           }
         }
+      } else if (IsMatmulTensor(GetUnaryOpExprChild(op->value).as<Call>()) &&
+                 op->func->func_name() != accumulator) {
+        RecordMatrixElse(op->func->func_name());
       }
     }
 
@@ -898,6 +903,26 @@ class ScopMakeScheduleTree final : protected IRVisitor {
   bool found{false};
 
  private:
+  void RecordMatrixElse(const std::string &name) {
+    scop_info_.analysis_result_.RecordMatrixMatmulMap(name, MATRIX_ELSE);
+    scop_info_.analysis_result_.RecordMatrixMatmulMajor(name, ROW_MAJOR);
+  }
+
+  // A vector indexed by one of the two innermost axes of the output, e.g. the bias of a dense layer. Only the
+  // fragments of the akg layout tell a lane the coordinates of its elements; with the nvcuda tiles the vector is
+  // loaded as a fragment and the epilogue is element-wise.
+  bool IsBroadcastVector(const Call *call, const Provide *op) {
+    auto size = op->args.size();
+    if (call->args.size() != 1 || size < 2 || scop_info_.analysis_result_.GetMatrixMatmulMap().count(call->name)) {
+      return false;
+    }
+    auto mma = scop_info_.analysis_result_.GetMmaMode();
+    if (!IsAkgWmmaTile(mma.m, mma.n, mma.k)) {
+      return false;
+    }
+    return Equal(call->args[0], op->args[size - 1]) || Equal(call->args[0], op->args[size - 2]);
+  }
+
   const NodeRef s;
   ScopInfo &scop_info_;
   isl::set set;
@@ -24,9 +24,7 @@ namespace poly {
 
 isl::id SyncManager::MakeUniqueId(SyncLevel level) {
   if (level == SyncLevel::WARP) {
-    // For now, tvm codegen does not support warp sync.
-    // So, used shared sync instead of warp sync.
-    return GetSyncId();
+    return GetWarpSyncId();
   } else {
     return GetSyncId();
   }
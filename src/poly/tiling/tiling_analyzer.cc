@@ -92,6 +92,9 @@ void TileAxis::LinkToLoop(const For *loop) {
     return;
   }
   this->loops.emplace_back(loop);
+  if (this->range_extent.as<IntImm>() == nullptr) {
+    this->range_extent = BucketExtent(this->range_extent);
+  }
 
   this->c1_constraints.tile_min_ = this->range_min == 0 ? CastIntToExpr(MIN_TILE) : CastIntToExpr(this->range_min);
   this->c1_constraints.tile_extent_ = this->range_extent;
@@ -99,6 +102,28 @@ void TileAxis::LinkToLoop(const For *loop) {
   this->c0_constraints.tile_extent_ = this->c1_constraints.tile_extent_;
 }
 
+// The gpu kernel of a shape bucket is tiled for the upper bound of the bucket, the extents of its shape
+// parameters being guarded by the context of the scop.
+Expr TileAxis::BucketExtent(const Expr &extent) const {
+  auto &user_config = analyzer_->scop_info_.user_config_;
+  int bucket_bound = user_config.GetShapeBucketBound();
+  if (bucket_bound <= 0) {
+    return extent;
+  }
+  auto params_rev_map = user_config.GetParamsRevMap();
+  Map<Var, Expr> bounds;
+  for (const auto &it : user_config.GetParams()) {
+    // the loops may still refer to the shape var instead of its param
+    const Expr &shape_var = params_rev_map[it.second->name_hint];
+    if (shape_var.as<Variable>() != nullptr) {
+      bounds.Set(it.second, make_const(it.second.type(), bucket_bound));
+      bounds.Set(air::Downcast<Var>(shape_var), make_const(shape_var.type(), bucket_bound));
+    }
+  }
+  Expr bucket_extent = CanonicalSimplify(Substitute(extent, bounds));
+  return bucket_extent.as<IntImm>() != nullptr ? bucket_extent : extent;
+}
+
 void TileAxis::MarkWithAttr(const AttrInfo &new_attr) {
   for (const auto &old_attr : this->attrs) {
     if (old_attr.attr_key == new_attr.attr_key && old_attr.attr_value == new_attr.attr_value) {
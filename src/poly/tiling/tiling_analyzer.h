@@ -254,6 +254,8 @@ class TileAxis {
   void DumpAxis(bool on_screen = false);
 
  private:
+  Expr BucketExtent(const Expr &extent) const;
+
   TilingAnalyzer *analyzer_{nullptr};
 };
 
@@ -16,6 +16,7 @@
  */
 
 #include "poly/tiling/tiling_solver.h"
+#include <chrono>
 #include "build_module.h"
 namespace akg {
 namespace ir {
@@ -856,6 +857,11 @@ TileCandidate *TraverseSolver::Solve() {
       }
     }
 
+    if (analyzer_.scop_info_.user_config_.GetPragmaTilingSearch() && analyzer_.op_type_ == VECTOR_OP &&
+        analyzer_.scop_info_.user_config_.GetTarget() == TARGET_CCE && !is_retry_) {
+      SearchTileFactors(band, CACHE1);
+    }
+
     if (analyzer_.op_type_ == GEMM_OP || analyzer_.scop_info_.user_config_.GetTarget() == TARGET_CUDA) {
       for (TileAxis *axis : cand_.GetTileAxis()) {
         std::unique_ptr<TileInfo> info(new (std::nothrow) TileInfo(axis, CACHE0, band));
@@ -1139,6 +1145,218 @@ bool TraverseSolver::DoTiling(const TileInfo *info) {
   return success;
 }
 
+std::vector<int64_t> TraverseSolver::CollectSearchCandidates(TileAxis *axis, TileLevel level) {
+  std::vector<int64_t> candidates;
+  TileAxis::Constraint cons = axis->GetConstConstraint(level);
+  if (!cons.cand_factor.empty()) {
+    for (const auto &f : cons.cand_factor) {
+      candidates.emplace_back(f.as<IntImm>()->value);
+    }
+    std::sort(candidates.begin(), candidates.end());
+    return candidates;
+  }
+
+  auto extent_imm = cons.tile_extent_.as<IntImm>();
+  auto min_imm = cons.tile_min_.as<IntImm>();
+  auto mod_imm = cons.tile_mod_.as<IntImm>();
+  if (extent_imm == nullptr || min_imm == nullptr || mod_imm == nullptr) {
+    return candidates;
+  }
+  int64_t dst = level == CACHE1 ? extent_imm->value : cand_.GetConstTileVal(axis).first;
+  int64_t min_tile = std::max<int64_t>(std::max<int64_t>(min_imm->value, axis->range_min), MIN_TILE);
+  int64_t mod = std::max<int64_t>(mod_imm->value, MIN_TILE);
+  if (dst < min_tile) {
+    return candidates;
+  }
+
+  // Divisors of the extent never produce a tail and powers of two keep the tail aligned, search only these.
+  std::set<int64_t> factors{min_tile, dst};
+  for (int64_t i = 1; i * i <= dst; ++i) {
+    if (dst % i == 0) {
+      factors.insert(i);
+      factors.insert(dst / i);
+    }
+  }
+  if (!axis->forbid_iso) {
+    for (int64_t i = 1; i <= dst; i *= 2) {
+      factors.insert(i);
+    }
+  }
+  for (auto t : factors) {
+    if (t < min_tile || t > dst) continue;
+    if (axis->forbid_iso && dst % t != 0) continue;
+    if (dst >= mod && t % mod != 0 && t != dst) continue;
+    candidates.emplace_back(t);
+  }
+
+  // Keep the search space small: sample evenly but always keep both ends.
+  const size_t max_candidates = 16;
+  if (candidates.size() > max_candidates) {
+    std::vector<int64_t> sampled;
+    double step = static_cast<double>(candidates.size() - 1) / (max_candidates - 1);
+    for (size_t i = 0; i < max_candidates; ++i) {
+      sampled.emplace_back(candidates[static_cast<size_t>(i * step + 0.5)]);
+    }
+    sampled.erase(std::unique(sampled.begin(), sampled.end()), sampled.end());
+    candidates = sampled;
+  }
+  return candidates;
+}
+
+void TraverseSolver::ApplySearchTiles(const std::vector<TileAxis *> &axes, const std::vector<int64_t> &tiles,
+                                      const std::vector<int64_t> &min_tiles, TileLevel level) {
+  for (size_t i = 0; i < axes.size(); ++i) {
+    int64_t tile = i < tiles.size() ? tiles[i] : min_tiles[i];
+    if (level == CACHE1) {
+      cand_.UpdateConstTile(axes[i], tile);
+    } else {
+      cand_.UpdateConstTile(axes[i], cand_.GetConstTileVal(axes[i]).first, tile);
+    }
+  }
+}
+
+/*
+ * Score of the current tiling, higher is better. It sums up:
+ *  1. memory utilization of the local buffers from the footprint model (MemInfer);
+ *  2. tile size of each axis weighted by the priority set by TilingPriorityScorer;
+ *  3. load balance of the blocks over the available cores;
+ * and subtracts a penalty for each axis that leaves a tail.
+ */
+double TraverseSolver::ScoreTiling(const std::vector<TileAxis *> &axes, TileLevel level, int band) {
+  const double tail_penalty = 0.5;
+  std::vector<TilingMemScope> scopes = {MEM_SCOPE_BUFFER};
+  if (analyzer_.op_type_ != VECTOR_OP || level == CACHE0) {
+    scopes = {MEM_SCOPE_CACHE1, MEM_SCOPE_CACHE0_A, MEM_SCOPE_CACHE0_B, MEM_SCOPE_CACHE0_C};
+  }
+  double mem_score = 0.0;
+  int mem_scope_num = 0;
+  for (auto scope : scopes) {
+    if (mem_limit_[scope] <= 0) continue;
+    auto used = static_cast<double>(cand_.MemInfer(scope, band).second);
+    mem_score += std::min(1.0, used / mem_limit_[scope]);
+    ++mem_scope_num;
+  }
+  if (mem_scope_num > 0) {
+    mem_score /= mem_scope_num;
+  }
+
+  double priority_score = 0.0;
+  double priority_sum = 0.0;
+  int64_t tail_num = 0;
+  int64_t blocks = 1;
+  for (auto axis : axes) {
+    int64_t extent = axis->GetConstExtent();
+    auto tile_val = cand_.GetConstTileVal(axis);
+    int64_t tile = level == CACHE1 ? tile_val.first : tile_val.second;
+    if (extent <= 0 || tile <= 0) continue;
+    double weight = std::max(axis->priority, 0) + 1;
+    priority_sum += weight;
+    if (extent > 1) {
+      priority_score += weight * std::log2(std::min(tile, extent)) / std::log2(extent);
+    } else {
+      priority_score += weight;
+    }
+    if (extent % tile != 0) {
+      ++tail_num;
+    }
+    if (axis->mc_sup) {
+      blocks *= (extent + tile - 1) / tile;
+    }
+  }
+  if (priority_sum > 0) {
+    priority_score /= priority_sum;
+  }
+
+  double balance_score = 1.0;
+  int64_t cores = cand_.GetCoreNumConf();
+  if (cores > 1) {
+    int64_t waves = (blocks + cores - 1) / cores;
+    balance_score = static_cast<double>(blocks) / (waves * cores);
+  }
+
+  return mem_score + priority_score + balance_score - tail_penalty * tail_num / std::max<size_t>(axes.size(), 1);
+}
+
+void TraverseSolver::SearchTileFactors(int band, TileLevel level) {
+  auto start = std::chrono::steady_clock::now();
+  auto budget = std::chrono::milliseconds(analyzer_.scop_info_.user_config_.GetPragmaTilingSearchTime());
+  auto beam_width = static_cast<size_t>(std::max(analyzer_.scop_info_.user_config_.GetPragmaTilingBeamWidth(), 1));
+  std::vector<TileAxis *> axes = cand_.GetTileAxis();
+  if (axes.empty()) return;
+
+  std::vector<int64_t> greedy_tiles;
+  for (auto axis : axes) {
+    auto tile_val = cand_.GetConstTileVal(axis);
+    greedy_tiles.emplace_back(level == CACHE1 ? tile_val.first : tile_val.second);
+  }
+  auto RestoreGreedy = [this, &axes, &greedy_tiles, level](const std::string &reason) {
+    ApplySearchTiles(axes, greedy_tiles, greedy_tiles, level);
+    std::stringstream ss;
+    ss << "Tiling search on band " << tiling_band_ << " keeps greedy result: " << reason;
+    analyzer_.GetTileLogger().AppendLog(DO_TILING, ss);
+  };
+  double greedy_score = ScoreTiling(axes, level, band);
+
+  std::vector<std::vector<int64_t>> candidates;
+  std::vector<int64_t> min_tiles;
+  for (auto axis : axes) {
+    candidates.emplace_back(CollectSearchCandidates(axis, level));
+    if (candidates.back().empty()) {
+      RestoreGreedy("axis " + std::to_string(axis->dim_axis) + " has no static candidate.");
+      return;
+    }
+    min_tiles.emplace_back(candidates.back().front());
+  }
+
+  std::vector<SearchState> beam = {SearchState()};
+  size_t visited = 0;
+  for (size_t i = 0; i < axes.size(); ++i) {
+    std::vector<SearchState> next;
+    for (const auto &state : beam) {
+      for (auto tile : candidates[i]) {
+        if (std::chrono::steady_clock::now() - start > budget) {
+          RestoreGreedy("time budget of " + std::to_string(budget.count()) + " ms is exhausted.");
+          return;
+        }
+        ++visited;
+        SearchState new_state = state;
+        new_state.tiles.emplace_back(tile);
+        ApplySearchTiles(axes, new_state.tiles, min_tiles, level);
+        if (!cand_.SpaceVerify(axes[i], level, band) || !MemoryVerify(level, band)) {
+          continue;
+        }
+        new_state.score = ScoreTiling(axes, level, band);
+        next.emplace_back(new_state);
+      }
+    }
+    if (next.empty()) {
+      RestoreGreedy("no candidate fits in memory.");
+      return;
+    }
+    std::stable_sort(next.begin(), next.end(),
+                     [](const SearchState &a, const SearchState &b) { return a.score > b.score; });
+    if (next.size() > beam_width) {
+      next.resize(beam_width);
+    }
+    beam = next;
+  }
+
+  const SearchState &best = beam.front();
+  if (best.score <= greedy_score) {
+    RestoreGreedy("best score " + std::to_string(best.score) + " <= greedy score " + std::to_string(greedy_score) +
+                  ".");
+    return;
+  }
+  ApplySearchTiles(axes, best.tiles, min_tiles, level);
+  std::stringstream ss;
+  ss << "Tiling search on band " << tiling_band_ << " visits " << visited << " states and updates tiles to [";
+  for (auto tile : best.tiles) {
+    ss << tile << " ";
+  }
+  ss << "], score " << greedy_score << " -> " << best.score;
+  analyzer_.GetTileLogger().AppendLog(DO_TILING, ss);
+}
+
 int64_t TraverseSolver::PostprocessFinalFactor(int64_t final_factor, TileAxis *axis) {
   auto processed = final_factor;
   if (processed == TileVarId::UNDEFINE) {
@@ -115,9 +115,25 @@ class TraverseSolver : TilingSolver {
     int64_t min_tile = 0;
     int64_t deviation = 0;
   };
+  struct SearchState {
+    std::vector<int64_t> tiles;
+    double score{0.0};
+  };
   bool IsTilable(TileInfo *info);
   bool MemoryVerify(TileLevel level, int band, int64_t *deviation = nullptr);
   bool DoTiling(const TileInfo *info);
+
+  /*
+   * Beam search over the candidate factors of all axes in band, started after the greedy tiling of level.
+   * Partial states fill the undecided axes with their minimal tile, so MemoryVerify prunes every branch whose
+   * smallest completion already exceeds the memory limit. The best state replaces the greedy result only if it
+   * scores higher and the search finishes within the time budget; otherwise the greedy tiling is kept.
+   */
+  void SearchTileFactors(int band, TileLevel level);
+  std::vector<int64_t> CollectSearchCandidates(TileAxis *axis, TileLevel level);
+  void ApplySearchTiles(const std::vector<TileAxis *> &axes, const std::vector<int64_t> &tiles,
+                        const std::vector<int64_t> &min_tiles, TileLevel level);
+  double ScoreTiling(const std::vector<TileAxis *> &axes, TileLevel level, int band);
   int64_t PostprocessFinalFactor(int64_t final_factor, TileAxis *axis);
   void AppendConvPragma();
   void AppendConvBackpropPragma();
@@ -319,6 +319,8 @@ class GemmStrategy : public TilingStrategy {
   std::pair<int64_t, int64_t> CalculateNumOfWarps(Mma mma);
   void CalculateMacroMma(Mma shape, Mma mma);
   void SetFinalConfig(Mma macro_mma, Mma mma);
+  // Return the number of blocks sharing the K loop of one macro tile, 1 means no split.
+  int64_t ChooseSplitK(Mma shape);
 
   // common utils
   int EstimateSharedSize(Mma alloc, int dtype);
@@ -389,6 +391,19 @@ class GpuStrategy : public TilingStrategy {
   int64_t GetThreadSize(const int64_t rest_threads, size_t inner_dim, const int64_t shape, const int64_t item);
   int64_t TileAfterThreadMapping(TileAxis *axis, size_t inner_dim, int64_t thread_size, const int64_t item);
 
+  /*
+   * Adjust tile of one block-mapped axis so that the grid is a whole number of waves, where a wave is the number of
+   * blocks that can be resident on the device at the same time.
+   * e.g.
+   *   80 sm, 8 resident blocks per sm, 704 blocks -> 1.1 waves (tail efficiency 0.55)
+   *   enlarge tile of outer axis by 1.1x -> 640 blocks -> 1 wave (tail efficiency 1.0)
+   */
+  void WaveAlignSpeedup();
+
+  // Estimate occupancy of one sm, limited by threads, registers and shared memory.
+  OccupancyInfo EstimateOccupancy(int64_t threads_per_block);
+  void CheckOccupancy();
+
   // Step 3. Transform list of integer into string mapping config.
   void SetMappingConfig();
 
@@ -15,6 +15,7 @@
  */
 #include "./tiling_strategy_manager.h"
 
+#include <limits>
 #include <numeric>
 
 #include "../../src/include/build_module.h"
@@ -84,10 +85,69 @@ void GemmStrategy::AddGpuConstraint() {
   std::string warp_cfg = std::to_string(w0_for_m_) + " " + std::to_string(w1_for_n_);
   analyzer_->scop_info_.user_config_.RecordReplaceConfig(WARP_COMPUTE, warp_cfg, MappingType::REPLACE_THREADS);
 
-  // Step 4. Set mapping and tiling config.
+  // Step 4. Split K among blocks when the macro tiles cannot fill the device.
+  // The plan is kept apart from the user attr, so that a retry of the tiling still sees what the user asked for.
+  int64_t split_k = b_axes.empty() ? ChooseSplitK(*shape) : 1;
+  g_attrs.Set(kGemmSplitKPlan, air::make_const(Int(32), split_k));
+
+  // Step 5. Set mapping and tiling config.
   SetFinalConfig(macro_mma_, mma);
 }
 
+int64_t GemmStrategy::ChooseSplitK(Mma shape) {
+  auto &scop_info = analyzer_->scop_info_;
+  std::string tensor_c = GetMatmulTensorsName(scop_info)[MATRIX_C];
+  bool only_write_c = true;
+  scop_info.analysis_result_.GetWrites().range().foreach_set([&only_write_c, &tensor_c](const isl::set &s) -> void {
+    only_write_c = only_write_c && s.get_tuple_name() == tensor_c;
+  });
+  // The partial sums are added atomically to the output, which SplitKGemm zeroes in a kernel launched before
+  // the GEMM, so nothing else may read or write it inside the kernel. The clean kernel indexes the output with
+  // int32, as SplitKGemm checks once more on the flattened IR.
+  if (!scop_info.user_config_.GetEnableAtomicAdd() || !only_write_c || scop_info.GetDtypeOf(tensor_c) != Float(32) ||
+      shape.k % macro_mma_.k != 0 || shape.m * shape.n > std::numeric_limits<int32_t>::max()) {
+    return 1;
+  }
+  int64_t k_tiles = shape.k / macro_mma_.k;
+  int64_t tiles = ((shape.m + macro_mma_.m - 1) / macro_mma_.m) * ((shape.n + macro_mma_.n - 1) / macro_mma_.n);
+  int64_t num_sm = std::max<int64_t>(1, GpuInfo::GetInstance().GetNumSm());
+
+  // Each split finishes with a round trip of the C tile through shared memory and global atomics, which costs
+  // about as much as a few K steps. A split only pays off when it fills the waves left empty by the M, N tiles.
+  constexpr int64_t kFixupCost = 2;
+  constexpr int64_t kMinKTilesPerSplit = 4;
+  constexpr int64_t kMaxSplitK = 32;
+  auto Cost = [tiles, k_tiles, num_sm](int64_t split) -> int64_t {
+    int64_t waves = (tiles * split + num_sm - 1) / num_sm;
+    return waves * (k_tiles / split + (split > 1 ? kFixupCost : 0));
+  };
+  int64_t best = 1;
+  int64_t user_split = g_attrs.GetInt(kGemmSplitK, 0);
+  if (user_split > 0) {
+    best = k_tiles % user_split == 0 ? user_split : 1;
+  } else if (tiles < num_sm) {
+    for (int64_t split = 2; split <= kMaxSplitK && k_tiles / split >= kMinKTilesPerSplit; split *= 2) {
+      if (k_tiles % split == 0 && Cost(split) < Cost(best)) {
+        best = split;
+      }
+    }
+  }
+  std::stringstream ss;
+  ss << "[Gemm] " << tiles << " macro tiles on " << num_sm << " SMs, " << k_tiles << " K steps -> split K by " << best
+     << " (cost " << Cost(best) << " vs " << Cost(1) << ")";
+  analyzer_->GetTileLogger().AppendLog(GPU_MAPPING, ss);
+  if (best > 1) {
+    // The partial C tile is staged in shared memory before it is added to the output. This has to be decided
+    // before the promotion, while the other side effects of the split wait for SplitKGemm to apply it.
+    auto shared_tensors = scop_info.user_config_.GetSharedTensors();
+    auto names = Split(shared_tensors, " ");
+    if (std::find(names.begin(), names.end(), tensor_c) == names.end()) {
+      scop_info.user_config_.SetSharedTensors(shared_tensors.empty() ? tensor_c : shared_tensors + " " + tensor_c);
+    }
+  }
+  return best;
+}
+
 std::pair<int64_t, int64_t> GemmStrategy::CalculateNumOfWarps(Mma mma) {
   int w0 = 1;
   int w1 = 1;
@@ -745,7 +805,9 @@ void GpuStrategy::AddGpuConstraint() {
   if (template_ == Template::PURE_ELEM) {
     InjectiveSpeedup();
   }
+  WaveAlignSpeedup();
   SetMappingConfig();
+  CheckOccupancy();
   if (!((template_ == Template::MATMUL || template_ == Template::CONV) &&
         analyzer_->scop_info_.user_config_.GetEnableTensorCore())) {
     analyzer_->ForEachAxisTopDown([this](TileAxis *axis) {
@@ -795,6 +857,7 @@ void GpuStrategy::MarkMappingInRootAxis() {
 
 void GpuStrategy::InitMappingLimit() {
   max_x_y_dim_thread_ = analyzer_->scop_info_.user_config_.GetMaxElemPerThread();
+  num_sm_ = GpuInfo::GetInstance().GetNumSm();
   DetermineTemplate();
   reverse_binding_ = analyzer_->scop_info_.user_config_.GetEnableAkgReduceLib() &&
                      analyzer_->scop_info_.analysis_result_.GetReduceDirection() == Y_DIRECTION;
@@ -1089,6 +1152,146 @@ void GpuStrategy::InnerThreadOuterBlock() {
   }
 }
 
+OccupancyInfo GpuStrategy::EstimateOccupancy(int64_t threads_per_block) {
+  // Tiles are not decided yet, so assume a few registers for each local buffer instead of its real footprint.
+  constexpr int64_t regs_per_local_buf = 8;
+  auto regs_per_thread = OccupancyCalculator::EstimateRegsPerThread(regs_per_local_buf * GetLocalAllocBufCount());
+  int64_t shared_per_block = 0;
+  if (is_reduce_op_[template_] && analyzer_->scop_info_.user_config_.GetEnableAkgReduceLib()) {
+    // reduce lib keeps one partial result per thread in shared memory
+    shared_per_block = threads_per_block * static_cast<int64_t>(sizeof(float));
+  }
+  OccupancyCalculator calculator;
+  return calculator.Estimate(threads_per_block, regs_per_thread, shared_per_block);
+}
+
+void GpuStrategy::CheckOccupancy() {
+  auto total_threads =
+    std::accumulate(thread_cfg_.begin(), thread_cfg_.end(), static_cast<int64_t>(1), std::multiplies<int64_t>());
+  auto info = EstimateOccupancy(total_threads);
+  std::stringstream ss;
+  ss << "Estimated occupancy = " << info.occupancy << " (resident blocks = " << info.resident_blocks
+     << ", active warps = " << info.active_warps << ", limited by " << info.limiter << ")";
+  analyzer_->GetTileLogger().AppendLog(GPU_MAPPING, ss);
+  auto floor = analyzer_->scop_info_.user_config_.GetMinOccupancyPercent();
+  if (info.occupancy * 100 < floor) {
+    ss << "Occupancy is below the floor " << floor << "%, promotion passes will limit the data kept on chip.";
+    analyzer_->GetTileLogger().AppendLog(GPU_MAPPING, ss);
+  }
+}
+
+void GpuStrategy::WaveAlignSpeedup() {
+  if (!analyzer_->scop_info_.user_config_.GetEnableWaveAlignedMapping() || block_cfg_.empty() ||
+      thread_cfg_.empty()) {
+    return;
+  }
+  if (template_ == Template::CUSTOM_CONFIG || template_ == Template::MATMUL || template_ == Template::CONV ||
+      template_ == Template::TRANSPOSE_OP || analyzer_->scop_info_.user_config_.GetEnableTensorCore()) {
+    return;
+  }
+  // only worth adjusting when the tail wave wastes a notable part of the device
+  constexpr double min_efficiency = 0.8;
+  constexpr double min_gain = 0.1;
+
+  auto total_threads =
+    std::accumulate(thread_cfg_.begin(), thread_cfg_.end(), static_cast<int64_t>(1), std::multiplies<int64_t>());
+  auto total_blocks =
+    std::accumulate(block_cfg_.begin(), block_cfg_.end(), static_cast<int64_t>(1), std::multiplies<int64_t>());
+  auto resident = std::max<int64_t>(1, EstimateOccupancy(total_threads).resident_blocks);
+  auto wave_size = num_sm_ * resident;
+  auto NumWaves = [wave_size](int64_t blocks) { return (blocks + wave_size - 1) / wave_size; };
+  auto TailEfficiency = [wave_size, &NumWaves](int64_t blocks) {
+    return static_cast<double>(blocks) / (NumWaves(blocks) * wave_size);
+  };
+
+  analyzer_->GetTileLogger().AppendLine(GPU_MAPPING, "WaveAlignSpeedup");
+  std::stringstream ss;
+  ss << "threads per block = " << total_threads << ", resident blocks per sm = " << resident << ", wave size = "
+     << wave_size << ", total blocks = " << total_blocks << ", waves = " << NumWaves(total_blocks)
+     << ", tail efficiency = " << TailEfficiency(total_blocks);
+  analyzer_->GetTileLogger().AppendLog(GPU_MAPPING, ss);
+  if (total_blocks <= wave_size || TailEfficiency(total_blocks) >= min_efficiency) {
+    return;
+  }
+
+  // The time of an axis is modeled as number of waves multiplied by work per block on this axis (i.e. its tile).
+  TileAxis *best_axis = nullptr;
+  int64_t best_tile = 0;
+  int64_t best_blocks = 0;
+  double best_cost = 1.0;
+  for (const auto &it : block_cfg_map_) {
+    auto axis = it.first;
+    auto idx = static_cast<size_t>(it.second);
+    if (idx >= block_cfg_.size() || block_cfg_[idx] <= 1 || block_cfg_[idx] != axis->block_constraints.map_extent_ ||
+        axis->HasAttr(AT_REDUCE_AXIS) || axis->range_extent.as<IntImm>() == nullptr ||
+        axis->c1_constraints.tile_min_.as<IntImm>() == nullptr ||
+        axis->c1_constraints.tile_extent_.as<IntImm>() == nullptr) {
+      continue;
+    }
+    auto extent = axis->range_extent.as<IntImm>()->value;
+    auto tile_min = std::max<int64_t>(MIN_TILE, axis->c1_constraints.tile_min_.as<IntImm>()->value);
+    auto cur_tile = axis->c1_constraints.tile_extent_.as<IntImm>()->value;
+    if (tile_min == cur_tile && cur_tile != MIN_TILE) {
+      continue;
+    }
+    auto cur_blocks = block_cfg_[idx];
+    auto other_blocks = total_blocks / cur_blocks;
+    auto cur_cost = static_cast<double>(NumWaves(total_blocks) * cur_tile);
+    auto step = thread_cfg_map_.count(axis) ? std::max<int64_t>(1, axis->thread_constraints.map_extent_) : 1;
+    auto mod = axis->c1_constraints.tile_mod_.as<IntImm>();
+    auto tile_mod = mod ? mod->value : 1;
+    // search around current tile only, so that the work per thread stays close to what mapping decided
+    auto min_tile = std::max<int64_t>(step, cur_tile / 2 / step * step);
+    auto max_tile = std::min<int64_t>(extent, cur_tile * 2);
+    for (auto tile = min_tile; tile <= max_tile; tile += step) {
+      auto blocks = (extent + tile - 1) / tile;
+      if (tile < tile_min || tile == cur_tile || (tile_mod > 1 && tile % tile_mod != 0) ||
+          (axis->forbid_iso && extent % tile != 0) || tile / step > max_elem_per_thread_ ||
+          (!block_limit_.empty() && blocks > block_limit_[std::min(idx, block_limit_.size() - 1)])) {
+        continue;
+      }
+      auto new_total = other_blocks * blocks;
+      if (new_total < wave_size || TailEfficiency(new_total) < TailEfficiency(total_blocks) + min_gain) {
+        continue;
+      }
+      auto cost = static_cast<double>(NumWaves(new_total) * tile) / cur_cost;
+      if (cost < best_cost) {
+        best_axis = axis;
+        best_tile = tile;
+        best_blocks = blocks;
+        best_cost = cost;
+      }
+    }
+  }
+  if (best_axis == nullptr || best_cost >= 1.0 - min_gain) {
+    ss << "no better tiling to align blocks to full waves, keep current mapping";
+    analyzer_->GetTileLogger().AppendLog(GPU_MAPPING, ss);
+    return;
+  }
+
+  auto idx = block_cfg_map_[best_axis];
+  auto new_total = total_blocks / block_cfg_[idx] * best_blocks;
+  ss << "axis " << best_axis->index << "_" << best_axis->dim_axis << " tile "
+     << best_axis->c1_constraints.tile_extent_ << " -> " << best_tile << ", blocks " << block_cfg_[idx] << " -> "
+     << best_blocks << ", total blocks = " << new_total << ", waves = " << NumWaves(new_total)
+     << ", tail efficiency = " << TailEfficiency(new_total) << ", relative time = " << best_cost;
+  analyzer_->GetTileLogger().AppendLog(GPU_MAPPING, ss);
+
+  std::string block_pos;
+  for (const auto &attr : best_axis->attrs) {
+    if (attr.attr_key == AT_BLOCK_CFG) {
+      block_pos = attr.attr_value.substr(0, attr.attr_value.find('_'));
+    }
+  }
+  if (!block_pos.empty()) {
+    best_axis->RemoveAttr(AT_BLOCK_CFG);
+    best_axis->MarkWithAttr(AttrInfo{AT_BLOCK_CFG, block_pos + "_" + std::to_string(best_blocks)});
+  }
+  block_cfg_[idx] = best_blocks;
+  best_axis->block_constraints.map_extent_ = best_blocks;
+  best_axis->TileRestrainToSingleValue(best_tile, TileLevel::CACHE1);
+}
+
 void GpuStrategy::SetMappingConfig() {
   std::stringstream ss;
   ss << "Use template " << template_map_[template_];
@@ -102,6 +102,45 @@ void TileLogger::LogFatalAndSaveLog(const std::string &fatal_log) {
 }
 std::string TileLogger::GetDumpDir() { return this->log_file_name_; }
 
+constexpr int64_t OccupancyCalculator::BASE_REGS_PER_THREAD;
+constexpr int64_t OccupancyCalculator::MAX_REGS_PER_THREAD;
+constexpr int64_t OccupancyCalculator::REG_ALLOC_UNIT_PER_WARP;
+constexpr int64_t OccupancyCalculator::WARP_SIZE;
+
+int64_t OccupancyCalculator::EstimateRegsPerThread(int64_t promoted_regs_per_thread) {
+  return std::min<int64_t>(MAX_REGS_PER_THREAD, BASE_REGS_PER_THREAD + std::max<int64_t>(0, promoted_regs_per_thread));
+}
+
+OccupancyInfo OccupancyCalculator::Estimate(int64_t threads_per_block, int64_t regs_per_thread,
+                                            int64_t shared_bytes_per_block) const {
+  OccupancyInfo info;
+  auto max_warps = std::max<int64_t>(1, gpu_info_.GetMaxThreadsPerSm() / WARP_SIZE);
+  auto warps = std::max<int64_t>(1, (threads_per_block + WARP_SIZE - 1) / WARP_SIZE);
+  auto Limit = [&info](int64_t blocks, const std::string &limiter) {
+    if (blocks < info.resident_blocks) {
+      info.resident_blocks = blocks;
+      info.limiter = limiter;
+    }
+  };
+
+  info.resident_blocks = gpu_info_.GetMaxBlocksPerSm();
+  info.limiter = "blocks";
+  Limit(max_warps / warps, "threads");
+  // registers are allocated per warp in fixed size units
+  auto regs_per_warp = regs_per_thread * WARP_SIZE;
+  regs_per_warp = (regs_per_warp + REG_ALLOC_UNIT_PER_WARP - 1) / REG_ALLOC_UNIT_PER_WARP * REG_ALLOC_UNIT_PER_WARP;
+  if (regs_per_warp > 0) {
+    Limit(gpu_info_.GetMaxRegsPerSm() / (regs_per_warp * warps), "registers");
+  }
+  if (shared_bytes_per_block > 0) {
+    Limit(gpu_info_.GetMaxSharedBytesPerSm() / shared_bytes_per_block, "shared memory");
+  }
+  info.resident_blocks = std::max<int64_t>(0, info.resident_blocks);
+  info.active_warps = info.resident_blocks * warps;
+  info.occupancy = static_cast<double>(info.active_warps) / max_warps;
+  return info;
+}
+
 /*
  * For a matmul operator C[b, m, n] += A[b, m, k] * B[b, n, k] where `b` indicates batch dim, `m` indicates row dim, `n`
  * indicates col dim and `k` indicates reduction dim, this function can extract `b, m, n, k` from all the loop vars
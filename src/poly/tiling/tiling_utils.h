@@ -91,9 +91,23 @@ class GpuInfo {
     return gpu_mem_limit_[scope_idx];
   }
 
+  int64_t GetNumSm() const { return num_sm_; }
+  int64_t GetMaxBlocksPerSm() const { return max_blocks_per_sm_; }
+  int64_t GetMaxThreadsPerSm() const { return max_threads_per_sm_; }
+  int64_t GetMaxRegsPerSm() const { return max_regs_per_sm_; }
+  int64_t GetMaxSharedBytesPerSm() const { return max_shared_bytes_per_sm_; }
+
  private:
-  GpuInfo() { InitGpuMemoryLimit(); }
+  GpuInfo() {
+    InitGpuMemoryLimit();
+    InitGpuComputeInfo();
+  }
   int64_t gpu_mem_limit_[MEM_SCOPE_BULK]{0};
+  int64_t num_sm_{80};
+  int64_t max_blocks_per_sm_{32};
+  int64_t max_threads_per_sm_{2048};
+  int64_t max_regs_per_sm_{65536};
+  int64_t max_shared_bytes_per_sm_{98304};
 
   void InitGpuMemoryLimit() {
     auto CollectLimit = [this](const std::string &scope, TilingMemScope mem) {
@@ -105,6 +119,50 @@ class GpuInfo {
     CollectLimit("reg", MEM_SCOPE_LOCAL);
     gpu_mem_limit_[MEM_SCOPE_GM] = 0;
   }
+
+  void InitGpuComputeInfo() {
+    air::GpuComputeInfo info = air::GetGpuComputeInfo();
+    if (!info.defined()) {
+      // keep the figures of v100 when the target does not describe its compute resources
+      return;
+    }
+    num_sm_ = info->num_sm;
+    max_blocks_per_sm_ = info->max_blocks_per_sm;
+    max_threads_per_sm_ = info->max_threads_per_sm;
+    max_regs_per_sm_ = info->max_regs_per_sm;
+    max_shared_bytes_per_sm_ = info->max_shared_bytes_per_sm;
+  }
+};
+
+/* Occupancy utils */
+struct OccupancyInfo {
+  int64_t resident_blocks{0};  // blocks that can reside on one sm at the same time
+  int64_t active_warps{0};     // warps that can reside on one sm at the same time
+  double occupancy{0.0};       // ratio of active warps to maximal warps per sm
+  std::string limiter;         // resource that limits resident blocks
+};
+
+/*
+ * Estimate theoretical occupancy of a kernel on one sm from the block size and the registers and shared memory that
+ * each block uses. Resources come from GpuInfo so that tiling and promotion passes see the same target.
+ */
+class OccupancyCalculator {
+ public:
+  OccupancyCalculator() : gpu_info_(GpuInfo::GetInstance()) {}
+  ~OccupancyCalculator() {}
+
+  OccupancyInfo Estimate(int64_t threads_per_block, int64_t regs_per_thread, int64_t shared_bytes_per_block) const;
+
+  // Registers used by one thread: a base cost for indices and addresses plus the registers of promoted tensors.
+  static int64_t EstimateRegsPerThread(int64_t promoted_regs_per_thread);
+
+  static constexpr int64_t BASE_REGS_PER_THREAD = 32;
+  static constexpr int64_t MAX_REGS_PER_THREAD = 255;
+
+ private:
+  static constexpr int64_t REG_ALLOC_UNIT_PER_WARP = 256;
+  static constexpr int64_t WARP_SIZE = 32;
+  GpuInfo &gpu_info_;
 };
 
 /* Log utils */
@@ -674,6 +674,221 @@ class ComputeInfo : public IRVisitor {
   }
 };
 
+/*
+ * Chooses the split points shared by the axes of all the ops. A plan cuts the R axes into consecutive
+ * segments, each fused into one axis, and is legal when no segment mixes axes of different reduce
+ * groups. Plans are scored by the global memory traffic per unit of mapped parallelism:
+ *   - traffic: the bytes an op reads and writes, inflated by the unused part of the 32-byte sectors
+ *     when the innermost fused extent is narrower than a sector;
+ *   - parallelism: only the innermost three segments map to blocks and threads, the outer ones run
+ *     serially. The innermost segment counts for at most the threads of a block, as the rest of it is
+ *     not more parallel than an outer segment, and the y/z dimensions of a grid are limited to 65535.
+ */
+constexpr int64_t kSectorBytes = 32;
+constexpr int64_t kMaxBlockThreads = 1024;
+constexpr int64_t kMaxGridDimYZ = 65535;
+constexpr size_t kMaxMappedDims = 3;
+// at most 2^(R - 1) plans are scored
+constexpr size_t kMaxPlanRank = 10;
+
+class FusePlanner {
+ public:
+  FusePlanner(const Schedule &sch, const std::unordered_map<IterVar, std::unordered_set<size_t>> &axis_reduce_group_ids)
+      : sch_(sch), axis_reduce_group_ids_(axis_reduce_group_ids) {}
+
+  // Returns the split to use, or an empty vector to keep the per-op grouping by reduce group.
+  std::vector<size_t> Choose(const std::vector<size_t> &split_config) {
+    if (!CollectOps()) {
+      return split_config;
+    }
+    std::vector<size_t> best;
+    double best_score = 0.0;
+    const size_t num_plans = static_cast<size_t>(1) << (rank_ - 1);
+    for (size_t mask = 0; mask < num_plans; ++mask) {
+      std::vector<size_t> plan = {0};
+      for (size_t i = 1; i < rank_; ++i) {
+        if (mask & (static_cast<size_t>(1) << (i - 1))) {
+          plan.push_back(i);
+        }
+      }
+      plan.push_back(rank_);
+      double score = 0.0;
+      if (!Score(plan, &score)) {
+        continue;
+      }
+      // ties go to the plan with fewer segments, i.e. less index arithmetic
+      if (best.empty() || score < best_score || (score == best_score && plan.size() < best.size())) {
+        best = plan;
+        best_score = score;
+      }
+    }
+    if (best.empty()) {
+      return split_config;
+    }
+
+    if (!split_config.empty()) {
+      double config_score = 0.0;
+      if (Score(split_config, &config_score)) {
+        // a given split keeps the kernels of a stitch consistent, so it is kept when legal
+        LOG(DEBUG) << "AutoFuse keeps split [" << PlanStr(split_config) << "] with score " << config_score
+                   << ", best plan [" << PlanStr(best) << "] scores " << best_score;
+        return split_config;
+      }
+      LOG(WARNING) << "AutoFuse split [" << PlanStr(split_config) << "] mixes axes of different reduce groups, use ["
+                   << PlanStr(best) << "] instead";
+    }
+    LOG(DEBUG) << "AutoFuse chooses split [" << PlanStr(best) << "] over " << ops_.size() << " ops: " << Explain(best);
+    return best;
+  }
+
+ private:
+  // all the ops to fuse must have the same rank and static extents for a shared split
+  bool CollectOps() {
+    for (const auto &s : sch_->stages) {
+      auto compute_op = s->op.as<ComputeOpNode>();
+      if (compute_op == nullptr || s->attach_type == air::kInline || compute_op->axis.size() <= 1) {
+        continue;
+      }
+      if (rank_ == 0) {
+        rank_ = compute_op->axis.size();
+      }
+      if (compute_op->axis.size() != rank_ || rank_ > kMaxPlanRank) {
+        return false;
+      }
+      // FuseOpAxis also cuts the reduce axes by the split, which only fits the axes of the ops
+      if (compute_op->reduce_axis.size() > 1) {
+        return false;
+      }
+      for (const auto &ax : compute_op->axis) {
+        if (!ax->dom->extent.as<IntImm>()) {
+          return false;
+        }
+      }
+      // a reduce group split by other axes is only fused after a reorder, which a shared split cannot express
+      for (size_t i = 1; i < rank_; ++i) {
+        if (GroupOf(compute_op->axis[i]) == GroupOf(compute_op->axis[i - 1])) {
+          continue;
+        }
+        for (size_t j = 0; j + 1 < i; ++j) {
+          if (GroupOf(compute_op->axis[j]) == GroupOf(compute_op->axis[i])) {
+            return false;
+          }
+        }
+      }
+      ops_.push_back(s->op);
+    }
+    return !ops_.empty();
+  }
+
+  std::vector<int64_t> SegmentExtents(const ComputeOpNode *op, const std::vector<size_t> &plan) const {
+    std::vector<int64_t> extents;
+    for (size_t i = 0; i + 1 < plan.size(); ++i) {
+      int64_t extent = 1;
+      for (size_t j = plan[i]; j < plan[i + 1]; ++j) {
+        extent *= op->axis[j]->dom->extent.as<IntImm>()->value;
+      }
+      extents.push_back(extent);
+    }
+    return extents;
+  }
+
+  const std::unordered_set<size_t> &GroupOf(const IterVar &ax) const {
+    static const std::unordered_set<size_t> no_group;
+    auto it = axis_reduce_group_ids_.find(ax);
+    return it == axis_reduce_group_ids_.end() ? no_group : it->second;
+  }
+
+  bool Legal(const ComputeOpNode *op, const std::vector<size_t> &plan) const {
+    if (plan.size() < 2 || plan.front() != 0 || plan.back() != rank_) {
+      return false;
+    }
+    for (size_t i = 0; i + 1 < plan.size(); ++i) {
+      if (plan[i] >= plan[i + 1]) {
+        return false;
+      }
+      for (size_t j = plan[i] + 1; j < plan[i + 1]; ++j) {
+        if (GroupOf(op->axis[j]) != GroupOf(op->axis[plan[i]])) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  int64_t AccessedBytes(const Operation &op) const {
+    int64_t bytes = 0;
+    Array<Tensor> tensors = op->InputTensors();
+    tensors.push_back(op.output(0));
+    for (const auto &t : tensors) {
+      int64_t elems = 1;
+      for (const auto &dim : t->shape) {
+        auto imm = dim.as<IntImm>();
+        elems *= imm ? imm->value : 1;
+      }
+      bytes += elems * t->dtype.bytes();
+    }
+    return bytes;
+  }
+
+  double Traffic(const Operation &op, const std::vector<int64_t> &extents) const {
+    int64_t inner_bytes = extents.back() * op.output(0)->dtype.bytes();
+    double waste = 1.0;
+    if (inner_bytes < kSectorBytes) {
+      waste = static_cast<double>(kSectorBytes) / static_cast<double>(inner_bytes);
+    }
+    return waste * static_cast<double>(AccessedBytes(op));
+  }
+
+  double Parallelism(const std::vector<int64_t> &extents) const {
+    double parallel = 1.0;
+    size_t mapped = std::min(extents.size(), kMaxMappedDims);
+    for (size_t i = 0; i < mapped; ++i) {
+      int64_t extent = extents[extents.size() - 1 - i];
+      parallel *= static_cast<double>(std::min(extent, i == 0 ? kMaxBlockThreads : kMaxGridDimYZ));
+    }
+    return parallel;
+  }
+
+  bool Score(const std::vector<size_t> &plan, double *score) const {
+    *score = 0.0;
+    for (const auto &op : ops_) {
+      auto compute_op = op.as<ComputeOpNode>();
+      if (!Legal(compute_op, plan)) {
+        return false;
+      }
+      auto extents = SegmentExtents(compute_op, plan);
+      *score += Traffic(op, extents) / Parallelism(extents);
+    }
+    return true;
+  }
+
+  std::string Explain(const std::vector<size_t> &plan) const {
+    std::ostringstream os;
+    for (const auto &op : ops_) {
+      auto extents = SegmentExtents(op.as<ComputeOpNode>(), plan);
+      os << op->func_name() << " {extents";
+      for (auto e : extents) {
+        os << " " << e;
+      }
+      os << ", traffic " << Traffic(op, extents) << " bytes, parallelism " << Parallelism(extents) << "} ";
+    }
+    return os.str();
+  }
+
+  static std::string PlanStr(const std::vector<size_t> &plan) {
+    std::ostringstream os;
+    for (size_t i = 0; i < plan.size(); ++i) {
+      os << (i == 0 ? "" : " ") << plan[i];
+    }
+    return os.str();
+  }
+
+  Schedule sch_;
+  const std::unordered_map<IterVar, std::unordered_set<size_t>> &axis_reduce_group_ids_;
+  std::vector<Operation> ops_;
+  size_t rank_{0};
+};
+
 class ComputeAtProcess {
  public:
   explicit ComputeAtProcess(Schedule sch) { sch_ = sch; }
@@ -709,7 +924,8 @@ void AutoFuse(Schedule sch, const std::string &split_str, std::vector<size_t> &s
   }
   auto compute_info = ComputeInfo(sch);
   compute_info.Run();
-  FuseOpAxis(sch, compute_info.axis_reduce_group_ids_, split_config, split_index).Run();
+  auto split_plan = FusePlanner(sch, compute_info.axis_reduce_group_ids_).Choose(split_config);
+  FuseOpAxis(sch, compute_info.axis_reduce_group_ids_, split_plan, split_index).Run();
   if (!fuse_check.compute_at_pairs_.empty()) {
     ComputeAtProcess(sch).Run(fuse_check.compute_at_pairs_);
   }
@@ -17,6 +17,7 @@
 #include <tvm/operation.h>
 #include <tvm/schedule_pass.h>
 #include <tvm.h>
+#include <sstream>
 #include <vector>
 #include <stack>
 
@@ -187,7 +188,174 @@ class CSE {
   std::unordered_map<Operation, int> counter;
 };
 
-void AutoInline(Schedule sch, const Target &target ,bool enable_cse) {
+/*
+ * Recompute cost model of inlining on GPU. Inlining an op replaces every access of its consumers by
+ * the op's expression, so the expression and the loads of its inputs are evaluated once per use
+ * instead of once per element:
+ *   inline:      uses * (compute + load * input_loads)
+ *   materialize: elems * (compute + load * input_loads + store) + uses * load
+ * where uses counts the elements of the consumers times their accesses to the op, and the uses
+ * through an inlined consumer are multiplied by the uses of that consumer. Transcendentals and
+ * casts are expensive to recompute, broadcast gathers multiply the uses.
+ * A materialized op is left as its own stage: the polyhedral scheduler fuses it into the loops of
+ * point-wise consumers, and the reuse of a gathered op comes from its promotion to shared memory.
+ */
+enum class InlineDecision { INLINE, MATERIALIZE };
+
+constexpr int64_t kArithCost = 1;
+constexpr int64_t kDivCost = 4;
+constexpr int64_t kCastCost = 2;
+constexpr int64_t kTranscendentalCost = 16;
+constexpr int64_t kLoadCost = 2;
+constexpr int64_t kStoreCost = 2;
+// inlining is kept unless materializing saves a clear margin, in percent
+constexpr int64_t kMaterializeMargin = 125;
+
+class RecomputeCost : public IRVisitor {
+ public:
+  RecomputeCost() {}
+  ~RecomputeCost() override = default;
+
+  void Visit_(const Call *op) final {
+    static const std::unordered_set<std::string> transcendental = {
+      "exp", "log", "tanh", "sigmoid", "sqrt", "rsqrt", "pow", "erf", "sin", "cos", "atan", "atan2", "expm1", "log1p"};
+    if (op->call_type == Call::Halide) {
+      ++loads_;
+    } else if (transcendental.count(op->name)) {
+      compute_ += kTranscendentalCost;
+    } else {
+      compute_ += kArithCost;
+    }
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const Cast *op) final {
+    compute_ += kCastCost;
+    IRVisitor::Visit_(op);
+  }
+
+  void Visit_(const Div *op) final { VisitDiv(op); }
+  void Visit_(const Mod *op) final { VisitDiv(op); }
+  void Visit_(const FloorDiv *op) final { VisitDiv(op); }
+  void Visit_(const FloorMod *op) final { VisitDiv(op); }
+
+  void Visit_(const Add *op) final { VisitArith(op); }
+  void Visit_(const Sub *op) final { VisitArith(op); }
+  void Visit_(const Mul *op) final { VisitArith(op); }
+  void Visit_(const Min *op) final { VisitArith(op); }
+  void Visit_(const Max *op) final { VisitArith(op); }
+  void Visit_(const Select *op) final {
+    compute_ += kArithCost;
+    IRVisitor::Visit_(op);
+  }
+
+  int64_t compute_{0};
+  int64_t loads_{0};
+
+ private:
+  template <typename T>
+  void VisitDiv(const T *op) {
+    compute_ += kDivCost;
+    IRVisitor::Visit_(op);
+  }
+
+  template <typename T>
+  void VisitArith(const T *op) {
+    compute_ += kArithCost;
+    IRVisitor::Visit_(op);
+  }
+};
+
+// number of points computed by op, with its reduction axes if asked; -1 when not known statically
+int64_t IterationPoints(const Operation &op, bool with_reduce_axis) {
+  const auto compute = op.as<ComputeOpNode>();
+  if (compute == nullptr) {
+    return -1;
+  }
+  Array<IterVar> axes = compute->axis;
+  if (with_reduce_axis) {
+    for (const auto &iv : compute->reduce_axis) {
+      axes.push_back(iv);
+    }
+  }
+  int64_t points = 1;
+  for (const auto &iv : axes) {
+    auto extent = iv->dom->extent.as<IntImm>();
+    if (extent == nullptr) {
+      return -1;
+    }
+    points *= extent->value;
+  }
+  return points;
+}
+
+class InlineCostModel {
+ public:
+  explicit InlineCostModel(const Schedule &sch) {
+    for (const Stage &s : sch->stages) {
+      const auto compute = s->op.as<ComputeOpNode>();
+      if (compute == nullptr) continue;
+      for (const auto &e : compute->body) {
+        PostOrderVisit(e, [this, &s](const NodeRef &node) {
+          auto call = node.as<Call>();
+          if (call && call->call_type == Call::Halide && call->func.defined()) {
+            ++accesses_[Downcast<Operation>(call->func)][s->op];
+          }
+        });
+      }
+    }
+  }
+
+  // Decide for an inlinable op. The consumers of op must be decided before, which holds when the
+  // stages are visited from the outputs back to the inputs.
+  InlineDecision Decide(const Operation &op, std::ostream &report) {
+    int64_t elems = IterationPoints(op, false);
+    int64_t uses = 0;
+    bool gather = false;
+    for (const auto &it : accesses_[op]) {
+      int64_t consumer_uses =
+        inlined_uses_.count(it.first) ? inlined_uses_[it.first] : IterationPoints(it.first, true);
+      if (elems < 0 || consumer_uses < 0) {
+        // dynamic shapes keep the default decision
+        inlined_uses_[op] = -1;
+        return InlineDecision::INLINE;
+      }
+      gather = gather || consumer_uses > elems;
+      uses += consumer_uses * it.second;
+    }
+    if (uses == 0) {
+      inlined_uses_[op] = -1;
+      return InlineDecision::INLINE;
+    }
+
+    RecomputeCost cost;
+    for (const auto &e : op.as<ComputeOpNode>()->body) {
+      cost.Visit(e);
+    }
+    int64_t per_point = cost.compute_ + kLoadCost * cost.loads_;
+    int64_t inline_cost = uses * per_point;
+    int64_t materialize_cost = elems * (per_point + kStoreCost) + uses * kLoadCost;
+    InlineDecision decision = InlineDecision::INLINE;
+    if (inline_cost * 100 > materialize_cost * kMaterializeMargin) {
+      decision = InlineDecision::MATERIALIZE;
+    } else {
+      inlined_uses_[op] = uses;
+    }
+    static const char *names[] = {"inline", "materialize"};
+    report << op->name << ": " << names[static_cast<int>(decision)] << " (elems " << elems << ", uses " << uses
+           << ", consumers " << accesses_[op].size() << (gather ? ", gathered" : "") << ", inline cost "
+           << inline_cost << ", materialize cost " << materialize_cost << ")\n";
+    return decision;
+  }
+
+ private:
+  // accesses_[producer][consumer]: number of reads of producer in the body of consumer
+  std::unordered_map<Operation, std::unordered_map<Operation, int64_t>> accesses_;
+  // points at which an inlined op is evaluated, -1 when unknown
+  std::unordered_map<Operation, int64_t> inlined_uses_;
+};
+
+std::string AutoInline(Schedule sch, const Target &target, bool enable_cse, bool enable_cost_model) {
   // Note: do not support inline of hybrid ops and extern ops
   std::unordered_set<Operation, NodeHash, NodeEqual> uninlinable;
   for (const Stage &s : sch->stages) {
@@ -217,13 +385,22 @@ void AutoInline(Schedule sch, const Target &target ,bool enable_cse) {
     common_subexpr = CSE().FindCommonSubexpr(sch);
   }
 
-  for (Stage s : sch->stages) {
+  bool use_cost_model = enable_cost_model && target->device_type == kDLGPU;
+  InlineCostModel cost_model(sch);
+  std::ostringstream report;
+  // visit consumers before producers, the uses of an op depend on whether its consumers are inlined
+  for (auto it = sch->stages.rbegin(); it != sch->stages.rend(); ++it) {
+    Stage s = *it;
     if (!s.is_scheduled() && (IsInjective(s->op) || air::schedule::IsElemWise(s->op)) && !CantInline(s->op, target) &&
         !s->is_output && uninlinable.count(s->op) == 0 && !(has_conv && !IsConvInline(s->op, conv_inputs)) &&
         (s->op->attrs.count("no_inline") == 0 && common_subexpr.count(s->op) == 0)) {
+      if (use_cost_model && cost_model.Decide(s->op, report) != InlineDecision::INLINE) {
+        continue;
+      }
       static_cast<void>(s.compute_inline());
     }
   }
+  return report.str();
 }
 }  // namespace schedule
 }  // namespace akg
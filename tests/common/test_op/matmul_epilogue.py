@@ -0,0 +1,44 @@
+# Copyright 2020-2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""matmul followed by an element-wise epilogue"""
+import akg.tvm as tvm
+import akg.topi as topi
+from akg.ops.math_gpu import tensorcore_batch_matmul
+
+VECTOR_OPS = {
+    "add": lambda a, b: a + b,
+    "sub": lambda a, b: a - b,
+    "mul": lambda a, b: a * b,
+    "div": lambda a, b: a / b,
+    "max": tvm.max,
+    "min": tvm.min,
+}
+
+UNARY_OPS = {
+    "tanh": topi.tanh,
+    "exp": topi.exp,
+}
+
+
+def matmul_epilogue(x, y, vec, out_dtype="float16", layout1="NHDT", layout2="NHTD", epilogue="add",
+                    vec_axis="row"):
+    """Matmul on the tensor core whose result is combined with a row (N) or col (M) vector, or a unary op."""
+    mm = tensorcore_batch_matmul.batch_matmul(x, y, None, out_dtype, layout1, layout2)
+    if epilogue in UNARY_OPS:
+        return UNARY_OPS[epilogue](mm)
+    op = VECTOR_OPS[epilogue]
+    if vec_axis == "row":
+        return tvm.compute(mm.shape, lambda i, j: op(mm[i, j], vec[j]), name="epilogue")
+    return tvm.compute(mm.shape, lambda i, j: op(mm[i, j], vec[i]), name="epilogue")
@@ -19,6 +19,7 @@ from tests.common.test_utils import gen_random_shape
 from tests.operators.gpu.test_ms_add import test_ms_add
 from tests.operators.gpu.test_ms_addn import test_ms_addn
 from tests.operators.gpu.test_ms_batch_matmul import test_ms_bmm
+from tests.operators.gpu.test_ms_matmul_epilogue import test_ms_matmul_epilogue
 from tests.operators.gpu.test_ms_exp import test_ms_exp
 from tests.operators.gpu.test_ms_maximum import test_ms_maximum
 from tests.operators.gpu.test_ms_minimum import test_ms_minimum
@@ -45,6 +46,7 @@ from tests.operators.gpu.test_ms_less_equal import test_ms_less_equal
 from tests.operators.gpu.test_ms_greater_equal import test_ms_greater_equal
 from tests.operators.gpu.test_ms_reciprocal import test_ms_reciprocal
 from tests.operators.gpu.test_ms_reduce_sum import test_ms_reduce_sum
+from tests.operators.gpu.test_ms_reduce_sum_deterministic import test_ms_reduce_sum_deterministic
 from tests.operators.gpu.test_ms_reduce_max import test_ms_reduce_max
 from tests.operators.gpu.test_ms_reduce_min import test_ms_reduce_min
 from tests.operators.gpu.test_ms_reduce_and import test_ms_reduce_and
@@ -123,6 +125,22 @@ def bmm(poly_sch, fuzz_shape=None, mind_trick_str=''):
     test_ms_bmm((128, 64), (64, 32), 'float16', 'float16', layout1='NHDT', layout2='NHTD', layout_out='NHDT',
                 shape_bias=(1, ), add_bias=False, tensor_core=True, poly_sch=poly_sch)
 
+def matmul_epilogue(poly_sch, fuzz_shape=None, mind_trick_str=''):
+    # 16x16x8 and 32x32x4 warp tiles use the akg fragment layout, 16x16x16 falls back to element-wise epilogues
+    tiles = [("NHDT", "NHTD", {"dim": "0 0 128 16 0 1 128 16 0 2 32 8", "bind_thread": "128 1"}),
+             ("NHTD", "NHTD", {"dim": "0 0 128 32 0 1 128 32 0 2 64 4", "bind_thread": "256 1"}),
+             ("NHDT", "NHTD", {"dim": "0 0 128 16 0 1 128 16 0 2 32 16", "bind_thread": "128 1"})]
+    for layout1, layout2, attrs in tiles:
+        attrs.update({"bind_block": "2 2"})
+        for epilogue in ["add", "sub", "mul", "div", "max", "min"]:
+            for vec_axis in ["row", "col"]:
+                test_ms_matmul_epilogue((256, 256), (256, 256), "float16", layout1, layout2, epilogue, vec_axis,
+                                        poly_sch=poly_sch, attrs=attrs)
+        for epilogue in ["tanh", "exp"]:
+            test_ms_matmul_epilogue((256, 256), (256, 256), "float16", layout1, layout2, epilogue,
+                                    poly_sch=poly_sch, attrs=attrs)
+
+
 def cast(poly_sch, fuzz_shape=None, mind_trick_str=''):
     test_ms_cast((32, 32, 14, 14, 16), "float16", "float32", poly_sch=poly_sch)
     test_ms_cast((32, 32, 14, 14, 16), "float32", "float16", poly_sch=poly_sch)
@@ -269,6 +287,13 @@ def reduce_sum(poly_sch, fuzz_shape=None, mind_trick_str=''):
                        keepdims=True, poly_sch=poly_sch)
 
 
+def reduce_sum_deterministic(poly_sch, fuzz_shape=None, mind_trick_str=''):
+    test_ms_reduce_sum_deterministic((9, 1024, 1024), 'float32', axis=None,
+                                     keepdims=False, poly_sch=poly_sch)
+    test_ms_reduce_sum_deterministic((1024, 1024), 'float32', axis=0,
+                                     keepdims=False, poly_sch=poly_sch)
+
+
 def conv(poly_sch, fuzz_shape=None, mind_trick_str=''):
     test_ms_conv((32, 64, 56, 56), (64, 64, 3, 3), (1, 1),
                  (1, 1, 1, 1), (1, 1), "float32", "float32")
@@ -459,12 +484,14 @@ if __name__ == '__main__':
     import traceback
     from datetime import datetime
 
-    op_map = {"abs": abs, "add": add, "addn": addn, "bmm": bmm, "cast": cast, "divide": divide,
+    op_map = {"abs": abs, "add": add, "addn": addn, "bmm": bmm, "matmul_epilogue": matmul_epilogue,
+              "cast": cast, "divide": divide,
               "equal": equal, "exp": exp, "greater_equal": greater_equal, "less_equal": less_equal,
               "log": log, "max": maximum, "min": minimum, "mul": mul, "neg": neg, "pow": pow,
               "reciprocal": reciprocal, "round": round, "rsqrt": rsqrt, "select": select, "sqrt": sqrt,
               "sub": sub, "reduce_max": reduce_max, "reduce_min": reduce_min, "reduce_and":reduce_and,
-              "reduce_or":reduce_or, "reduce_sum": reduce_sum, "expand_dims": expand_dims, "one_hot": one_hot,
+              "reduce_or":reduce_or, "reduce_sum": reduce_sum,
+              "reduce_sum_deterministic": reduce_sum_deterministic, "expand_dims": expand_dims, "one_hot": one_hot,
               "reshape": reshape, "tile": tile, "trans_data": trans_data,
               "conv": conv, "conv_tc": conv_tc,
               "fused_pad": fused_pad,
@@ -0,0 +1,67 @@
+# Copyright 2020-2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License
+
+import numpy as np
+from tests.common.test_op.matmul_epilogue import matmul_epilogue
+from tests.common.gen_random import random_gaussian
+from akg.utils import kernel_exec as utils
+
+NP_VECTOR_OPS = {"add": np.add, "sub": np.subtract, "mul": np.multiply, "div": np.divide,
+                 "max": np.maximum, "min": np.minimum}
+NP_UNARY_OPS = {"tanh": np.tanh, "exp": np.exp}
+
+
+def gen_data(shape1, shape2, dtype, layout1, layout2, epilogue, vec_axis):
+    # centered inputs keep the matmul result small enough for exp in fp16
+    lhs = random_gaussian(shape1, miu=0, sigma=0.1).astype(dtype)
+    rhs = random_gaussian(shape2, miu=0, sigma=0.1).astype(dtype)
+    data1 = lhs if layout1 == "NHDT" else np.transpose(lhs)
+    data2 = rhs if layout2 == "NHTD" else np.transpose(rhs)
+    mm = np.matmul(data1.astype("float32"), data2.astype("float32"))
+    vec_len = mm.shape[1] if vec_axis == "row" else mm.shape[0]
+    # keep the vector away from zero for div
+    vec = random_gaussian((vec_len, ), miu=1, sigma=0.1).astype(dtype)
+    if epilogue in NP_UNARY_OPS:
+        expect = NP_UNARY_OPS[epilogue](mm)
+    elif vec_axis == "row":
+        expect = NP_VECTOR_OPS[epilogue](mm, vec.astype("float32")[np.newaxis, :])
+    else:
+        expect = NP_VECTOR_OPS[epilogue](mm, vec.astype("float32")[:, np.newaxis])
+    expect = expect.astype(dtype)
+    output = np.full(expect.shape, np.nan, dtype)
+    return lhs, rhs, vec, output, expect
+
+
+def test_ms_matmul_epilogue(shape1, shape2, dtype="float16", layout1="NHDT", layout2="NHTD", epilogue="add",
+                            vec_axis="row", poly_sch=True, attrs=None):
+    """Checks the fragment epilogues against numpy, which covers the element coordinates of the akg fragments."""
+    m = shape1[0] if layout1 == "NHDT" else shape1[1]
+    n = shape2[1] if layout2 == "NHTD" else shape2[0]
+    vec_len = n if vec_axis == "row" else m
+    op_attrs = [dtype, layout1, layout2, epilogue, vec_axis]
+    default_attrs = {"target": "cuda", "pragma_enable_matmul": True, "enable_auto_inline": False}
+    if attrs:
+        default_attrs.update(attrs)
+    if poly_sch:
+        mod = utils.op_build_test(matmul_epilogue, (shape1, shape2, (vec_len, )), (dtype, dtype, dtype),
+                                  op_attrs=op_attrs, attrs=default_attrs, kernel_name="matmul_epilogue")
+
+    lhs, rhs, vec, output, expect = gen_data(shape1, shape2, dtype, layout1, layout2, epilogue, vec_axis)
+    output = utils.mod_launch(mod, (lhs, rhs, vec, output), expect=expect)
+    res = np.allclose(output, expect, rtol=5e-03, atol=1.e-3)
+    print("Test {}".format("Pass" if res else "Fail"))
+    if not res:
+        print("Error cuda:========================")
+        print(mod.imported_modules[0].get_source())
+        raise AssertionError("Test fail")
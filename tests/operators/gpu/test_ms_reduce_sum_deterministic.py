@@ -0,0 +1,53 @@
+# Copyright 2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License
+import numpy as np
+from tests.common.gen_random import random_gaussian
+from akg.utils import kernel_exec as utils
+from akg.ops.math_gpu.reduce_sum import reduce_sum
+
+def gen_data(in_shape, in_dtype, axis, keepdims):
+    support_list = {"float16": np.float16, "float32": np.float32}
+    data = random_gaussian(in_shape, miu=1, sigma=0.5).astype(support_list[in_dtype])
+    expect = np.sum(data, axis=axis, keepdims=keepdims)
+    if axis==None and keepdims==False:
+        expect = np.broadcast_to(expect, (1,))
+    return data, expect
+
+def test_ms_reduce_sum_deterministic(in_shape, in_dtype, axis=None, keepdims=False, poly_sch=False, repeat=3):
+    '''The last block overwrites the output, so it is launched without a clean and gives the same bits every run.'''
+    if poly_sch:
+        mod = utils.op_build_test(reduce_sum, (in_shape, ), (in_dtype, ), kernel_name="reduce_sum",
+                                  op_attrs=[axis, keepdims],
+                                  attrs={"target": "cuda", "enable_akg_reduce_lib": True, "enable_atomic_add": True,
+                                         "reduce_return_type": "deterministic"})
+
+    source = mod.imported_modules[0].get_source()
+    if "AkgDeterministicReturn" not in source:
+        print(source)
+        raise AssertionError("Test fail: the deterministic return is not used")
+
+    data, expect = gen_data(in_shape, in_dtype, axis, keepdims)
+    first = None
+    for i in range(repeat):
+        output = np.full(expect.shape, np.nan if i % 2 == 0 else 1.0e4, in_dtype)
+        output = utils.mod_launch(mod, (data, output), expect=expect)
+        if not np.allclose(output, expect, rtol=5e-03, atol=1.e-8):
+            print("Error cuda:========================")
+            print(source)
+            raise AssertionError("Test fail: run %d gives a wrong result" % i)
+        if first is None:
+            first = output.copy()
+        elif first.tobytes() != output.tobytes():
+            raise AssertionError("Test fail: run %d gives other bits than run 0" % i)
+    print("Test Pass")
@@ -0,0 +1,297 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Compile time benchmark of the composite graphs of a corpus. Every graph is lowered to ir with the registered
+ * composite_lower, which needs no device; a json array lowers its graphs one after another as a stitch list:
+ *   compile_bench --corpus corpus [--warmup 1] [--repeat 5] [--output result.json]
+ *                 [--baseline baseline.json] [--tolerance 0.1]
+ * The median wall time, the mean time of the passes and the peak resident memory of every case are reported.
+ * Every case runs in a process of its own, so that it starts with cold caches and its peak memory is its own.
+ * With a baseline, a case whose median is slower than the baseline by more than the tolerance is a regression
+ * and the exit code is 1. The output file of a run can be used as the baseline of the next ones.
+ */
+#include <dirent.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <tvm/runtime/registry.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "codegen/util.h"
+#include "picojson.h"
+
+namespace akg {
+namespace {
+struct BenchConfig {
+  std::string corpus;
+  std::string output;
+  std::string baseline;
+  int warmup{1};
+  int repeat{5};
+  double tolerance{0.1};
+};
+
+struct CaseResult {
+  double wall_ms{0};
+  int64_t peak_rss_kb{0};
+  std::map<std::string, double> stage_ms;
+};
+
+int64_t PeakRssKb() {
+  struct rusage usage;
+  return getrusage(RUSAGE_SELF, &usage) == 0 ? static_cast<int64_t>(usage.ru_maxrss) : 0;
+}
+
+std::vector<std::string> ListCorpus(const std::string &dir) {
+  std::vector<std::string> files;
+  DIR *d = opendir(dir.c_str());
+  CHECK(d != nullptr) << "Failed to open corpus " << dir;
+  for (struct dirent *entry = readdir(d); entry != nullptr; entry = readdir(d)) {
+    std::string name = entry->d_name;
+    auto pos = name.find_last_of('.');
+    if (pos != std::string::npos && (name.substr(pos) == ".info" || name.substr(pos) == ".json")) {
+      files.push_back(name);
+    }
+  }
+  closedir(d);
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+picojson::value ReadJson(const std::string &file) {
+  std::ifstream in(file);
+  CHECK(in.is_open()) << "Failed to open " << file;
+  std::stringstream buf;
+  buf << in.rdbuf();
+  picojson::value v;
+  std::string err = picojson::parse(v, buf.str());
+  CHECK(err.empty()) << "Failed to parse " << file << ": " << err;
+  return v;
+}
+
+// the graphs of a case, a json array being a stitch list
+std::vector<std::string> LoadGraphs(const std::string &file) {
+  picojson::value v = ReadJson(file);
+  std::vector<std::string> graphs;
+  if (v.is<picojson::array>()) {
+    for (const auto &graph : v.get<picojson::array>()) {
+      graphs.push_back(graph.serialize());
+    }
+  } else {
+    graphs.push_back(v.serialize());
+  }
+  return graphs;
+}
+
+CaseResult RunCase(const std::vector<std::string> &graphs, const BenchConfig &config) {
+  const auto *lower = air::runtime::Registry::Get("composite_lower");
+  CHECK(lower != nullptr) << "composite_lower is not registered";
+  Map<std::string, NodeRef> attrs;
+  auto run = [&graphs, lower, &attrs]() {
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &graph : graphs) {
+      NodeRef res = (*lower)(graph, attrs);
+      CHECK(res.defined());
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+  };
+  for (int i = 0; i < config.warmup; ++i) {
+    static_cast<void>(run());
+  }
+
+  CaseResult result;
+  std::vector<double> times;
+  PassTimer::GetInstance()->Clear();
+  for (int i = 0; i < config.repeat; ++i) {
+    times.push_back(run());
+  }
+  std::sort(times.begin(), times.end());
+  result.wall_ms = times[times.size() / 2];
+  for (const auto &it : PassTimer::GetInstance()->GetPassTime()) {
+    result.stage_ms[it.first] = it.second / 1000.0 / config.repeat;
+  }
+  result.peak_rss_kb = PeakRssKb();
+  return result;
+}
+
+picojson::value CaseToJson(const CaseResult &result) {
+  picojson::object stages;
+  for (const auto &stage : result.stage_ms) {
+    stages[stage.first] = picojson::value(stage.second);
+  }
+  picojson::object res;
+  res["wall_ms"] = picojson::value(result.wall_ms);
+  res["peak_rss_kb"] = picojson::value(result.peak_rss_kb);
+  res["stage_ms"] = picojson::value(stages);
+  return picojson::value(res);
+}
+
+CaseResult CaseFromJson(const picojson::value &v) {
+  CaseResult result;
+  result.wall_ms = v.get("wall_ms").get<double>();
+  result.peak_rss_kb = v.get("peak_rss_kb").get<int64_t>();
+  for (const auto &stage : v.get("stage_ms").get<picojson::object>()) {
+    result.stage_ms[stage.first] = stage.second.get<double>();
+  }
+  return result;
+}
+
+/*
+ * Runs the case in a child process, which sends its result back through a pipe. ru_maxrss only grows over
+ * the life of a process, and the caches of the compiler live as long, so a case run after others would
+ * report their peak memory and reuse their work. Returns false when the child fails.
+ */
+bool RunCaseInProcess(const std::string &file, const BenchConfig &config, CaseResult *result) {
+  int fds[2];
+  CHECK_EQ(pipe(fds), 0) << "Failed to create a pipe";
+  std::cout.flush();
+  pid_t pid = fork();
+  CHECK_GE(pid, 0) << "Failed to fork";
+  if (pid == 0) {
+    close(fds[0]);
+    std::string out = CaseToJson(RunCase(LoadGraphs(file), config)).serialize();
+    size_t written = 0;
+    while (written < out.size()) {
+      ssize_t n = write(fds[1], out.data() + written, out.size() - written);
+      if (n <= 0) {
+        _exit(1);
+      }
+      written += static_cast<size_t>(n);
+    }
+    close(fds[1]);
+    _exit(0);
+  }
+  close(fds[1]);
+  std::string out;
+  char buf[4096];
+  for (ssize_t n = read(fds[0], buf, sizeof(buf)); n > 0; n = read(fds[0], buf, sizeof(buf))) {
+    out.append(buf, static_cast<size_t>(n));
+  }
+  close(fds[0]);
+  int status = 0;
+  CHECK_EQ(waitpid(pid, &status, 0), pid);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    return false;
+  }
+  picojson::value v;
+  std::string err = picojson::parse(v, out);
+  CHECK(err.empty()) << "Failed to parse the result of " << file << ": " << err;
+  *result = CaseFromJson(v);
+  return true;
+}
+
+picojson::value ToJson(const std::map<std::string, CaseResult> &results) {
+  picojson::object cases;
+  for (const auto &it : results) {
+    cases[it.first] = CaseToJson(it.second);
+  }
+  picojson::object root;
+  root["cases"] = picojson::value(cases);
+  return picojson::value(root);
+}
+
+// Returns the number of regressions against the baseline.
+int CompareBaseline(const std::map<std::string, CaseResult> &results, const BenchConfig &config) {
+  picojson::value baseline = ReadJson(config.baseline);
+  CHECK(baseline.is<picojson::object>() && baseline.get("cases").is<picojson::object>())
+    << "No cases in baseline " << config.baseline;
+  const auto &cases = baseline.get("cases").get<picojson::object>();
+  int regressions = 0;
+  for (const auto &it : results) {
+    auto base = cases.find(it.first);
+    if (base == cases.end() || !base->second.get("wall_ms").is<double>()) {
+      std::cout << it.first << ": not in baseline" << std::endl;
+      continue;
+    }
+    double base_ms = base->second.get("wall_ms").get<double>();
+    double ratio = base_ms > 0 ? it.second.wall_ms / base_ms : 1.0;
+    bool regressed = ratio > 1.0 + config.tolerance;
+    regressions += regressed ? 1 : 0;
+    std::cout << it.first << ": " << std::fixed << std::setprecision(2) << it.second.wall_ms << " ms vs " << base_ms
+              << " ms (x" << ratio << ")" << (regressed ? " REGRESSION" : "") << std::endl;
+  }
+  return regressions;
+}
+
+BenchConfig ParseArgs(int argc, char **argv) {
+  BenchConfig config;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string key = argv[i];
+    std::string value = argv[i + 1];
+    if (key == "--corpus") {
+      config.corpus = value;
+    } else if (key == "--output") {
+      config.output = value;
+    } else if (key == "--baseline") {
+      config.baseline = value;
+    } else if (key == "--warmup") {
+      config.warmup = std::stoi(value);
+    } else if (key == "--repeat") {
+      config.repeat = std::stoi(value);
+    } else if (key == "--tolerance") {
+      config.tolerance = std::stod(value);
+    } else {
+      LOG(FATAL) << "Unknown option " << key;
+    }
+  }
+  CHECK(!config.corpus.empty()) << "Usage: compile_bench --corpus <dir> [--warmup n] [--repeat n] "
+                                   "[--output file] [--baseline file] [--tolerance ratio]";
+  CHECK_GT(config.repeat, 0);
+  CHECK_GE(config.warmup, 0);
+  return config;
+}
+}  // namespace
+}  // namespace akg
+
+int main(int argc, char **argv) {
+  using akg::CaseResult;
+  auto config = akg::ParseArgs(argc, argv);
+  std::map<std::string, CaseResult> results;
+  int failures = 0;
+  for (const auto &file : akg::ListCorpus(config.corpus)) {
+    auto name = file.substr(0, file.find_last_of('.'));
+    CaseResult res;
+    if (!akg::RunCaseInProcess(config.corpus + "/" + file, config, &res)) {
+      std::cout << name << ": FAILED" << std::endl;
+      ++failures;
+      continue;
+    }
+    std::cout << name << ": " << std::fixed << std::setprecision(2) << res.wall_ms << " ms, peak rss "
+              << res.peak_rss_kb << " kB" << std::endl;
+    for (const auto &stage : res.stage_ms) {
+      std::cout << "  " << stage.first << ": " << stage.second << " ms" << std::endl;
+    }
+    results[name] = res;
+  }
+  if (!config.output.empty()) {
+    std::ofstream out(config.output);
+    CHECK(out.is_open()) << "Failed to open " << config.output;
+    out << akg::ToJson(results).serialize(true);
+  }
+  if (!config.baseline.empty() && akg::CompareBaseline(results, config) > 0) {
+    return 1;
+  }
+  return failures > 0 ? 1 : 0;
+}
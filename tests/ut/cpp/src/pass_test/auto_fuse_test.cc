@@ -0,0 +1,98 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <tvm/expr_operator.h>
+#include <tvm/operation.h>
+#include <tvm/schedule.h>
+#include "schedule_pass.h"
+
+namespace akg {
+/*
+ * B(shape) = A(shape) * 2
+ * C(shape[:-1] + [1]) = sum(B, axis=-1, keepdims=True)
+ *
+ * The innermost axis of B is reduced by C, so it forms a reduce group of its own.
+ */
+class AutoFuseTest : public testing::Test {
+ public:
+  AutoFuseTest() = default;
+  ~AutoFuseTest() override = default;
+
+  static air::Tensor Scale(const air::Tensor &a) {
+    return air::compute(
+      a->shape, [&a](const air::Array<air::Var> &i) { return a(i) * air::make_const(a->dtype, 2); }, "B");
+  }
+
+  // reduces B along the given axis, kept with extent 1 in the output
+  static air::Tensor SumKeepDims(const air::Tensor &b, size_t axis) {
+    air::Array<air::Expr> shape = b->shape;
+    shape.Set(axis, air::make_const(air::Int(32), 1));
+    auto k = air::reduce_axis(air::Range(0, b->shape[axis]), "k");
+    return air::compute(
+      shape,
+      [&b, &k, axis](const air::Array<air::Var> &i) {
+        air::Array<air::Expr> args(i.begin(), i.end());
+        args.Set(axis, k->var);
+        return air::sum(b(args), {k});
+      },
+      "C");
+  }
+
+  // the reduce axis of C stays a leaf of its own
+  static size_t LeafAxes(air::Schedule sch, const air::Tensor &t) { return sch[t->op]->leaf_iter_vars.size(); }
+};
+
+// a reduce group on consecutive axes: the planner keeps three segments, as one fused outer axis overflows the grid
+TEST_F(AutoFuseTest, ContiguousGroup) {
+  auto a = air::placeholder({4, 128, 1024, 32}, air::Float(32), "A");
+  auto b = Scale(a);
+  auto c = SumKeepDims(b, 3);
+  auto sch = air::create_schedule({c->op});
+  std::vector<size_t> split_index;
+  schedule::AutoFuse(sch, "", split_index);
+  EXPECT_EQ(split_index, std::vector<size_t>({0, 2, 3, 4}));
+  EXPECT_EQ(LeafAxes(sch, b), 3u);
+  EXPECT_EQ(LeafAxes(sch, c), 4u);
+}
+
+// ops of different ranks cannot share a split, so each op fuses its axes by reduce group
+TEST_F(AutoFuseTest, RankMismatchFallback) {
+  auto a = air::placeholder({8, 16, 32}, air::Float(32), "A");
+  auto b = Scale(a);
+  auto k = air::reduce_axis(air::Range(0, 32), "k");
+  auto c = air::compute(
+    {8, 16}, [&b, &k](const air::Array<air::Var> &i) { return air::sum(b(i[0], i[1], k->var), {k}); }, "C");
+  auto sch = air::create_schedule({c->op});
+  std::vector<size_t> split_index;
+  schedule::AutoFuse(sch, "", split_index);
+  EXPECT_EQ(split_index, std::vector<size_t>({0, 2, 3}));
+  EXPECT_EQ(LeafAxes(sch, b), 2u);
+  EXPECT_EQ(LeafAxes(sch, c), 2u);
+}
+
+// a reduce group split by other axes needs a reorder, which only the per-op grouping does
+TEST_F(AutoFuseTest, NonContiguousFallback) {
+  auto a = air::placeholder({8, 32, 16}, air::Float(32), "A");
+  auto b = Scale(a);
+  auto c = SumKeepDims(b, 1);
+  auto sch = air::create_schedule({c->op});
+  std::vector<size_t> split_index;
+  schedule::AutoFuse(sch, "", split_index);
+  EXPECT_EQ(split_index, std::vector<size_t>({0, 2, 3}));
+  EXPECT_EQ(LeafAxes(sch, b), 2u);
+  EXPECT_EQ(LeafAxes(sch, c), 2u);
+}
+}  // namespace akg
@@ -15,6 +15,7 @@
  */
 #include <gtest/gtest.h>
 #include <tvm/ir.h>
+#include <tvm/ir_visitor.h>
 #include "base/dump_helper.h"
 #include "base/expr_builder.h"
 #include "base/ir_checker.h"
@@ -27,6 +28,7 @@
 #undef private
 #include "codegen/util.h"
 #include "contrib/cce_parm/cceconf.h"
+#include "poly/tiling/tiling_utils.h"
 
 namespace akg {
 /* AutoPolyTest1: test for to_three_address
@@ -121,6 +123,45 @@ TEST_F(AutoPolyTest1, RunPass) {
   EXPECT_EQ(std::get<2>(infos_lhs[0]), 2 * 16 * 1024);
 }
 
+/* The beam search over tile factors keeps every instance of the statements and the local buffers within UB. */
+TEST_F(AutoPolyTest1, TilingSearch) {
+  SetRunMode("cloud");
+  g_attrs_.Set("pragma_tiling_search", UTExprBuilder::IntImm(1, air::Int(1)));
+  // a budget the search cannot run out of, so its result is the one being checked
+  g_attrs_.Set("pragma_tiling_search_time", UTExprBuilder::IntImm(60000));
+  air::Array<air::NodeRef> stmts_out = ir::AutoPoly(stmt_, binds_, "cce", g_attrs_, false, false);
+  ASSERT_EQ(stmts_out.size(), 2);
+  air::NodeRef stmt = stmts_out[0];
+  std::vector<std::tuple<std::string, const air::ir::Provide*, uint64_t>> infos_lhs =
+      UTProvideCheckerForBinary(true).Find(
+          stmt, UTProvideCheckerForBinary::BinaryOpType::kAdd, "b_local_UB", "c_local_UB");
+  ASSERT_EQ(infos_lhs.size(), 1);
+  EXPECT_EQ(std::get<2>(infos_lhs[0]), 32 * 1024);
+  std::vector<std::tuple<std::string, const air::ir::Provide*, uint64_t>> infos_out =
+      UTProvideCheckerForBinary(true).Find(
+          stmt, UTProvideCheckerForBinary::BinaryOpType::kAdd, "out_0_local_UB", "a_local_UB");
+  ASSERT_EQ(infos_out.size(), 1);
+  EXPECT_EQ(std::get<2>(infos_out[0]), 32 * 1024);
+
+  int64_t ub_bytes = 0;
+  air::ir::PostOrderVisit(stmt, [&ub_bytes](const air::NodeRef &node) {
+    auto realize = node.as<air::ir::Realize>();
+    if (realize == nullptr || realize->func->func_name().find("_local_UB") == std::string::npos) {
+      return;
+    }
+    int64_t size = realize->type.bytes();
+    for (const auto &range : realize->bounds) {
+      const int64_t *extent = air::as_const_int(range->extent);
+      ASSERT_NE(extent, nullptr);
+      EXPECT_GT(*extent, 0);
+      size *= *extent;
+    }
+    ub_bytes += size;
+  });
+  EXPECT_GT(ub_bytes, 0);
+  EXPECT_LE(ub_bytes, ir::poly::NpuInfo::GetInstance().GetMemoryLimitInScope(ir::poly::MEM_SCOPE_BUFFER));
+}
+
 /* AutoPolyTest2: test for to_three_address
  * Input pattern:
  * for (i1, 0, 32) {
@@ -0,0 +1,104 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <tvm/ir.h>
+#include <tvm/ir_visitor.h>
+#include <string>
+#include <vector>
+#include "composite/block_fusion.h"
+
+namespace akg {
+class BlockFusionTest : public testing::Test {
+ public:
+  BlockFusionTest() = default;
+  ~BlockFusionTest() override = default;
+
+  // a kernel of one store per thread, launched with the given blocks and threads
+  static air::Stmt MakeKernel(const std::string &buf, int blocks, int threads, bool sync) {
+    using air::ir::AttrStmt;
+    air::Var bx("blockIdx.x");
+    air::Var tx("threadIdx.x");
+    auto block_iv = air::IterVarNode::make(air::Range(0, blocks), bx, air::IterVarType::kThreadIndex, "blockIdx.x");
+    auto thread_iv = air::IterVarNode::make(air::Range(0, threads), tx, air::IterVarType::kThreadIndex, "threadIdx.x");
+    air::Stmt body = air::ir::Store::make(air::Var(buf, air::Handle()), air::make_const(air::Float(32), 1),
+                                          bx * threads + tx, air::const_true());
+    if (sync) {
+      air::Stmt barrier = air::ir::Evaluate::make(
+        air::ir::Call::make(air::Int(32), air::ir::intrinsic::tvm_storage_sync, {air::ir::StringImm::make("shared")},
+                            air::ir::Call::Intrinsic));
+      body = air::ir::Block::make(body, barrier);
+    }
+    body = AttrStmt::make(thread_iv, "thread_extent", threads, body);
+    return AttrStmt::make(block_iv, "thread_extent", blocks, body);
+  }
+
+  // fuses a single block of 1024 threads with many blocks of a warp
+  static air::Stmt Fuse(bool sync) {
+    std::vector<air::Stmt> stmts{MakeKernel("wide", 1, 1024, sync), MakeKernel("narrow", 10000, 32, false)};
+    return ir::BlockFusion(stmts, "cuda");
+  }
+
+  static std::string Plan(const air::Stmt &stmt) {
+    std::string plan;
+    air::ir::PostOrderVisit(stmt, [&plan](const air::NodeRef &node) {
+      auto attr = node.as<air::ir::AttrStmt>();
+      if (attr != nullptr && attr->attr_key == "block_fusion_plan") {
+        plan = attr->value.as<air::ir::StringImm>()->value;
+      }
+    });
+    return plan;
+  }
+
+  static int64_t ThreadExtent(const air::Stmt &stmt) {
+    int64_t extent = 0;
+    air::ir::PostOrderVisit(stmt, [&extent](const air::NodeRef &node) {
+      auto attr = node.as<air::ir::AttrStmt>();
+      if (attr != nullptr && attr->attr_key == "thread_extent" &&
+          attr->node.as<air::IterVarNode>()->var->name_hint == "threadIdx.x") {
+        extent = attr->value.as<air::IntImm>()->value;
+      }
+    });
+    return extent;
+  }
+
+  static bool HasFoldLoop(const air::Stmt &stmt) {
+    bool found = false;
+    air::ir::PostOrderVisit(stmt, [&found](const air::NodeRef &node) {
+      auto loop = node.as<air::ir::For>();
+      found = found || (loop != nullptr && loop->loop_var->name_hint == "tx_iter");
+    });
+    return found;
+  }
+};
+
+TEST_F(BlockFusionTest, FoldWideSegment) {
+  // the narrow blocks dominate the makespan, so the wide segment loops over a narrower block
+  air::Stmt stmt = Fuse(false);
+  EXPECT_EQ(Plan(stmt).compare(0, 7, "retiled"), 0) << Plan(stmt);
+  int64_t extent = ThreadExtent(stmt);
+  EXPECT_GE(extent, 32);
+  EXPECT_LT(extent, 1024);
+  EXPECT_TRUE(HasFoldLoop(stmt));
+}
+
+TEST_F(BlockFusionTest, SyncBlocksFold) {
+  // the threads of the wide segment meet at a barrier and cannot be folded
+  air::Stmt stmt = Fuse(true);
+  EXPECT_EQ(Plan(stmt).compare(0, 5, "fused"), 0) << Plan(stmt);
+  EXPECT_EQ(ThreadExtent(stmt), 1024);
+  EXPECT_FALSE(HasFoldLoop(stmt));
+}
+}  // namespace akg
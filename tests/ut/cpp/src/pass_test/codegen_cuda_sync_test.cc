@@ -0,0 +1,60 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <tvm/ir.h>
+#include <tvm/lowered_func.h>
+#include "codegen/codegen_cuda.h"
+
+namespace akg {
+class CodeGenCudaSyncTest : public testing::Test {
+ public:
+  CodeGenCudaSyncTest() = default;
+  ~CodeGenCudaSyncTest() override = default;
+
+  // the cuda source of a kernel made of one tvm_storage_sync of the given scope
+  static std::string EmitSync(const std::string &scope) {
+    using air::ir::Call;
+    air::Stmt sync = air::ir::Evaluate::make(Call::make(air::Int(32), air::ir::intrinsic::tvm_storage_sync,
+                                                        {air::ir::StringImm::make(scope)}, Call::Intrinsic));
+    auto n = air::make_node<air::LoweredFuncNode>();
+    n->name = "sync_kernel";
+    n->func_type = air::kDeviceFunc;
+    n->is_restricted = false;
+    n->body = sync;
+    air::codegen::CodeGenCUDA cg;
+    cg.Init(false);
+    cg.AddFunction(air::LoweredFunc(n));
+    return cg.Finish();
+  }
+};
+
+TEST_F(CodeGenCudaSyncTest, WarpSync) {
+  std::string code = EmitSync("warp");
+  // warps only run in lock step before Volta, where __syncwarp does not exist
+  auto guard = code.find("#if __CUDA_ARCH__ >= 700");
+  auto sync = code.find("__syncwarp();");
+  ASSERT_NE(guard, std::string::npos);
+  ASSERT_NE(sync, std::string::npos);
+  EXPECT_LT(guard, sync);
+  EXPECT_EQ(code.find("__syncthreads();"), std::string::npos);
+}
+
+TEST_F(CodeGenCudaSyncTest, BlockSync) {
+  std::string code = EmitSync("shared");
+  EXPECT_NE(code.find("__syncthreads();"), std::string::npos);
+  EXPECT_EQ(code.find("__syncwarp();"), std::string::npos);
+}
+}  // namespace akg
@@ -0,0 +1,70 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <cstdio>
+#include <string>
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+#include "common/ir_dump_writer.h"
+
+namespace akg {
+namespace {
+std::string ReadArchive(const std::string &path) {
+  std::string content;
+  char buf[256];
+#ifdef USE_ZLIB
+  gzFile file = gzopen((path + ".gz").c_str(), "rb");
+  if (file == nullptr) return content;
+  int n = 0;
+  while ((n = gzread(file, buf, sizeof(buf))) > 0) content.append(buf, n);
+  gzclose(file);
+#else
+  std::FILE *file = std::fopen(path.c_str(), "rb");
+  if (file == nullptr) return content;
+  size_t n = 0;
+  while ((n = std::fread(buf, 1, sizeof(buf), file)) > 0) content.append(buf, n);
+  std::fclose(file);
+#endif
+  return content;
+}
+}  // namespace
+
+TEST(IrDumpWriterTest, EndKernelWritesTheArchive) {
+  char dir[] = "/tmp/ir_dump_writer_XXXXXX";
+  ASSERT_NE(mkdtemp(dir), nullptr);
+  setenv("MS_AKG_DUMP_IR_ARCHIVE", "text", 1);
+  {
+    common::IrDumpKernelScope dump_scope;
+    common::IrDumpWriter::BeginKernel(dir);
+    ASSERT_TRUE(common::IrDumpWriter::Enabled());
+    common::IrDumpWriter::GetInstance().Push("0_pass.cc", [](std::ostream &os) { os << "ir of the kernel"; });
+  }
+  // the scope has drained the queue and closed the archive
+  EXPECT_FALSE(common::IrDumpWriter::Enabled());
+  std::string archive = std::string(dir) + "/pass_ir.log";
+  EXPECT_EQ(ReadArchive(archive), "==== 0_pass.cc 16\nir of the kernel");
+  unsetenv("MS_AKG_DUMP_IR_ARCHIVE");
+#ifdef USE_ZLIB
+  static_cast<void>(std::remove((archive + ".gz").c_str()));
+#else
+  static_cast<void>(std::remove(archive.c_str()));
+#endif
+  static_cast<void>(rmdir(dir));
+}
+}  // namespace akg
@@ -0,0 +1,81 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <tvm/ir.h>
+#include <tvm/runtime/registry.h>
+#include "codegen/pass_mgr.h"
+
+namespace akg {
+namespace {
+int g_num_runs = 0;
+
+Stmt CountRun(const Stmt &stmt) {
+  ++g_num_runs;
+  return stmt;
+}
+
+Stmt CountSyncRun(const Stmt &stmt, const std::string &scope) { return CountRun(stmt); }
+}  // namespace
+
+// the sub names of these passes are the ones with trigger features
+TVM_REGISTER_GLOBAL("ut.pass_mgr.InjectVirtualThread").set_body_typed(CountRun);
+TVM_REGISTER_GLOBAL("ut.pass_mgr.ThreadSyncStmt").set_body_typed(CountSyncRun);
+TVM_REGISTER_GLOBAL("ut.pass_mgr.Simplify").set_body_typed(CountRun);
+
+class PassMgrTest : public testing::Test {
+ public:
+  PassMgrTest() {
+    Var i("i");
+    Stmt store = Store::make(a_, make_const(Float(32), 1), i, const_true());
+    loop_ = For::make(i, 0, 16, ForType::Serial, DeviceAPI::None, store);
+    g_num_runs = 0;
+  }
+  ~PassMgrTest() override = default;
+
+  Var a_{"A", Handle()};
+  Stmt loop_;
+};
+
+TEST_F(PassMgrTest, SkipWithoutTrigger) {
+  Stmt res = PassMgr("ut.pass_mgr.InjectVirtualThread", loop_);
+  EXPECT_EQ(g_num_runs, 0);
+  EXPECT_TRUE(res.same_as(loop_));
+
+  res = PassMgr("ut.pass_mgr.ThreadSyncStmt", loop_, std::string("shared"));
+  EXPECT_EQ(g_num_runs, 0);
+  EXPECT_TRUE(res.same_as(loop_));
+
+  // passes without trigger features always run
+  res = PassMgr("ut.pass_mgr.Simplify", loop_);
+  EXPECT_EQ(g_num_runs, 1);
+}
+
+TEST_F(PassMgrTest, RunWithTrigger) {
+  IterVar vt = thread_axis(Range(), "vthread");
+  Stmt vthread = AttrStmt::make(vt, air::ir::attr::virtual_thread, make_const(Int(32), 2), loop_);
+  Stmt res = PassMgr("ut.pass_mgr.InjectVirtualThread", vthread);
+  EXPECT_EQ(g_num_runs, 1);
+
+  Stmt shared = Allocate::make(a_, Float(32), {make_const(Int(32), 16)}, const_true(), loop_);
+  shared = AttrStmt::make(a_, air::ir::attr::storage_scope, StringImm::make("shared"), shared);
+  res = PassMgr("ut.pass_mgr.ThreadSyncStmt", shared, std::string("shared"));
+  EXPECT_EQ(g_num_runs, 2);
+
+  // global barriers depend on global buffers, which every kernel has
+  res = PassMgr("ut.pass_mgr.ThreadSyncStmt", loop_, std::string("global"));
+  EXPECT_EQ(g_num_runs, 3);
+}
+}  // namespace akg
@@ -0,0 +1,89 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <tvm/ir.h>
+#include "pass/rewrite_simplify_cce.h"
+
+namespace akg {
+using ir::Simplify_cce;
+using ir::SimplifyCCEScope;
+
+class SimplifyCCEScopeTest : public testing::Test {
+ public:
+  SimplifyCCEScopeTest() { vrange_.Set(x_, Range::make_by_min_extent(0, 16)); }
+  ~SimplifyCCEScopeTest() override = default;
+
+  // (x * 4 + 3) / 4 with x in [0, 16), built anew on every call
+  Expr Query() const { return floordiv(x_ * 4 + 3, 4); }
+
+  Var x_{"x"};
+  Map<Var, Range> vrange_;
+};
+
+TEST_F(SimplifyCCEScopeTest, HitsWithinOneCompilation) {
+  EXPECT_EQ(SimplifyCCEScope::Current(), nullptr);
+  SimplifyCCEScope scope;
+  EXPECT_EQ(SimplifyCCEScope::Current(), &scope);
+  Expr first = Simplify_cce(Query(), vrange_);
+  EXPECT_TRUE(Equal(first, x_));
+  EXPECT_EQ(scope.Misses(), 1u);
+  EXPECT_EQ(scope.Hits(), 0u);
+
+  // a structurally equal query under the same bindings reuses the result
+  Expr second = Simplify_cce(Query(), vrange_);
+  EXPECT_TRUE(second.same_as(first));
+  EXPECT_EQ(scope.Hits(), 1u);
+
+  // other bindings are another query
+  Map<Var, Range> wider;
+  wider.Set(x_, Range::make_by_min_extent(0, 32));
+  EXPECT_TRUE(Equal(Simplify_cce(Query(), wider), x_));
+  EXPECT_EQ(scope.Misses(), 2u);
+
+  // another variable of the same name never shares a result
+  Var y("x");
+  Map<Var, Range> y_range;
+  y_range.Set(y, Range::make_by_min_extent(0, 16));
+  EXPECT_TRUE(Equal(Simplify_cce(floordiv(y * 4 + 3, 4), y_range), y));
+  EXPECT_EQ(scope.Misses(), 3u);
+  EXPECT_EQ(scope.Hits(), 1u);
+}
+
+TEST_F(SimplifyCCEScopeTest, IsolatedBetweenCompilations) {
+  {
+    SimplifyCCEScope first_kernel;
+    Simplify_cce(Query(), vrange_);
+    Simplify_cce(Query(), vrange_);
+    EXPECT_EQ(first_kernel.Hits(), 1u);
+  }
+  EXPECT_EQ(SimplifyCCEScope::Current(), nullptr);
+  {
+    // the memo of the previous compilation is gone with its scope
+    SimplifyCCEScope second_kernel;
+    Simplify_cce(Query(), vrange_);
+    EXPECT_EQ(second_kernel.Hits(), 0u);
+    EXPECT_EQ(second_kernel.Misses(), 1u);
+    {
+      SimplifyCCEScope nested;
+      EXPECT_EQ(SimplifyCCEScope::Current(), &nested);
+      Simplify_cce(Query(), vrange_);
+      EXPECT_EQ(nested.Misses(), 1u);
+    }
+    EXPECT_EQ(SimplifyCCEScope::Current(), &second_kernel);
+    EXPECT_EQ(second_kernel.Misses(), 1u);
+  }
+}
+}  // namespace akg
@@ -0,0 +1,137 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <tvm/ir.h>
+#include <tvm/ir_pass.h>
+#include <tvm/buffer.h>
+#define private public
+#define protected public
+#include "composite/stitch_fusion.cc"
+#undef protected
+#undef private
+
+namespace akg {
+constexpr int kSize = 256;
+
+/*
+ * ir0: X[i] = 1
+ * ir1: // attr [X_shared] storage_scope = "shared"
+ *      allocate X_shared[float32 * 256]
+ *      X_shared[i] = X[i]
+ *      Y[i] = X_shared[i]
+ *
+ * X is a reuse entry promoted inside ir1, so X_shared lives in the slot of X in the pool.
+ */
+class StitchBufferPlanTest : public testing::Test {
+ public:
+  StitchBufferPlanTest() {
+    Var i("i");
+    Stmt ir0 = For::make(i, 0, kSize, ForType::Serial, DeviceAPI::None,
+                         Store::make(x_, make_const(Float(32), 1), i, const_true()));
+    Stmt copy = Store::make(x_shared_, Load::make(Float(32), x_, i, const_true()), i, const_true());
+    Stmt use = Store::make(y_, Load::make(Float(32), x_shared_, i, const_true()), i, const_true());
+    Stmt body = For::make(i, 0, kSize, ForType::Serial, DeviceAPI::None, Block::make(copy, use));
+    body = Allocate::make(x_shared_, Float(32), {make_const(Int(32), kSize)}, const_true(), body);
+    Stmt ir1 = AttrStmt::make(x_shared_, air::ir::attr::storage_scope, StringImm::make(SHARED), body);
+    irs_ = {ir0, ir1};
+
+    reuse_map_.Set("output_0", {StringImm::make("REUSE"), make_const(Int(64), kSize)});
+    outputs2args_["output_0"] = air::decl_buffer({make_const(Int(32), kSize)}, Float(32), "X");
+  }
+  ~StitchBufferPlanTest() override = default;
+
+  static int CountAllocate(const Stmt &s) {
+    int count = 0;
+    PostOrderVisit(s, [&count](const NodeRef &node) {
+      if (node.as<Allocate>()) ++count;
+    });
+    return count;
+  }
+
+  Var x_{"X", Handle()};
+  Var x_shared_{"X_shared", Handle()};
+  Var y_{"Y", Handle()};
+  std::vector<Stmt> irs_;
+  Map<std::string, Array<NodeRef>> reuse_map_;
+  std::unordered_map<std::string, NodeRef> outputs2args_;
+};
+
+TEST_F(StitchBufferPlanTest, InOpCopyTakesThePoolSlot) {
+  StitchBufAlloc buf_manager(irs_, {}, reuse_map_, {}, outputs2args_);
+  buf_manager.BufferAllocReuse();
+
+  ASSERT_TRUE(buf_manager.stitch_buffer_map.count(STITCH_SHARED_POOL));
+  EXPECT_EQ(buf_manager.stitch_buffer_map[STITCH_SHARED_POOL].alloc_size, static_cast<uint64_t>(kSize));
+  ASSERT_TRUE(buf_manager.stitch_buffer_map.count("X_shared"));
+  EXPECT_EQ(buf_manager.stitch_buffer_map["X_shared"].buf_name, STITCH_SHARED_POOL);
+  EXPECT_EQ(buf_manager.stitch_buffer_map["X_shared"].offset, buf_manager.stitch_buffer_map["X"].offset);
+  // the shared memory of X is counted once, by the pool
+  EXPECT_EQ(buf_manager.allocated_share_size_, static_cast<uint64_t>(kSize * 4));
+
+  StitchAttrInfo store_attr;
+  store_attr.type_array = {StitchOpType::Elem, StitchOpType::Elem};
+  StitchMutate mutate(buf_manager.stitch_buffer_map, buf_manager.buf_within_op_map, store_attr, {});
+  Stmt res0 = mutate.Run(irs_[0]);
+  mutate.phase = 1;
+  Stmt res1 = mutate.Run(irs_[1]);
+  EXPECT_EQ(CountAllocate(res1), 0);
+  PostOrderVisit(res1, [](const NodeRef &node) {
+    if (auto store = node.as<Store>()) {
+      if (store->buffer_var->name_hint != "Y") {
+        EXPECT_EQ(store->buffer_var->name_hint, STITCH_SHARED_POOL);
+      }
+    }
+    if (auto attr = node.as<AttrStmt>()) {
+      EXPECT_NE(attr->attr_key, air::ir::attr::storage_scope);
+    }
+  });
+}
+
+/*
+ * ir0: for (i) P[i] = 1
+ *      for (i) Q[i] = 2
+ *
+ * P and Q are used by different loops of one ir, with no barrier in between, so they do not share bytes.
+ * Once they are used by different irs, the barrier at the end of ir0 lets Q take the bytes of P.
+ */
+TEST(StitchLivenessTest, BuffersOfOneIrDoNotShare) {
+  Var i("i");
+  Var p("P", Handle());
+  Var q("Q", Handle());
+  Stmt write_p = For::make(i, 0, kSize, ForType::Serial, DeviceAPI::None,
+                           Store::make(p, make_const(Float(32), 1), i, const_true()));
+  Stmt write_q = For::make(i, 0, kSize, ForType::Serial, DeviceAPI::None,
+                           Store::make(q, make_const(Float(32), 2), i, const_true()));
+  auto make_intervals = []() {
+    std::vector<StitchBufferInterval> intervals(2);
+    intervals[0].name = "P";
+    intervals[0].size = kSize;
+    intervals[1].name = "Q";
+    intervals[1].size = kSize;
+    return intervals;
+  };
+
+  auto same_ir = make_intervals();
+  StitchBufferLiveness({Block::make(write_p, write_q)}, same_ir);
+  EXPECT_EQ(AssignStitchBufferOffsets(same_ir, 8), static_cast<uint64_t>(2 * kSize));
+  EXPECT_NE(same_ir[0].offset, same_ir[1].offset);
+
+  auto two_irs = make_intervals();
+  StitchBufferLiveness({write_p, write_q}, two_irs);
+  EXPECT_EQ(AssignStitchBufferOffsets(two_irs, 8), static_cast<uint64_t>(kSize));
+  EXPECT_EQ(two_irs[0].offset, two_irs[1].offset);
+}
+}  // namespace akg
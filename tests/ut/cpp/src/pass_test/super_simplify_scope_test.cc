@@ -0,0 +1,84 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <tvm/ir.h>
+#include "pass/zero_elimination.h"
+
+namespace akg {
+using ir::CanProve;
+using ir::SuperSimplify;
+using ir::SuperSimplifyScope;
+
+class SuperSimplifyScopeTest : public testing::Test {
+ public:
+  SuperSimplifyScopeTest() { vranges_.Set(x_, Range::make_by_min_extent(0, 16)); }
+  ~SuperSimplifyScopeTest() override = default;
+
+  // (x * 4 + 3) / 4 with x in [0, 16), built anew on every call
+  Expr Query() const { return floordiv(x_ * 4 + 3, 4); }
+
+  Var x_{"x"};
+  Map<Var, Range> vranges_;
+};
+
+TEST_F(SuperSimplifyScopeTest, HitsWithinOneCompilation) {
+  EXPECT_EQ(SuperSimplifyScope::Current(), nullptr);
+  {
+    SuperSimplifyScope scope;
+    EXPECT_EQ(SuperSimplifyScope::Current(), &scope);
+    Expr first = SuperSimplify(Query(), vranges_);
+    EXPECT_TRUE(Equal(first, x_));
+    EXPECT_EQ(scope.Misses(), 1u);
+
+    // a structurally equal query under the same ranges reuses the result
+    Expr second = SuperSimplify(Query(), vranges_);
+    EXPECT_TRUE(second.same_as(first));
+    EXPECT_EQ(scope.Hits(), 1u);
+
+    // constants never reach the memo
+    SuperSimplify(make_const(Int(32), 1), vranges_);
+    EXPECT_EQ(scope.Hits() + scope.Misses(), 2u);
+  }
+  EXPECT_EQ(SuperSimplifyScope::Current(), nullptr);
+  {
+    // the memo of the previous compilation is gone with its scope
+    SuperSimplifyScope scope;
+    SuperSimplify(Query(), vranges_);
+    EXPECT_EQ(scope.Hits(), 0u);
+    EXPECT_EQ(scope.Misses(), 1u);
+  }
+}
+
+TEST_F(SuperSimplifyScopeTest, SurelyUnprovableSkipsSimplify) {
+  SuperSimplifyScope scope;
+  // x in [0, 16) is false at x = 15, so the bounds reject it without simplifying
+  EXPECT_FALSE(CanProve(x_ >= 16, vranges_));
+  EXPECT_FALSE(CanProve(x_ == 16, vranges_));
+  EXPECT_FALSE(CanProve(x_ < 0, vranges_));
+  EXPECT_EQ(scope.Misses(), 0u);
+
+  // conditions the bounds cannot reject go to SuperSimplify
+  EXPECT_TRUE(CanProve(x_ < 16, vranges_));
+  EXPECT_FALSE(CanProve(x_ < 8, vranges_));
+  EXPECT_EQ(scope.Misses(), 2u);
+
+  // an empty range makes every condition vacuously true, so the bounds do not reject it
+  Map<Var, Range> empty;
+  empty.Set(x_, Range::make_by_min_extent(0, 0));
+  CanProve(x_ >= 16, empty);
+  EXPECT_EQ(scope.Misses(), 3u);
+}
+}  // namespace akg
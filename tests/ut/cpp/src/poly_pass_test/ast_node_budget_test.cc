@@ -0,0 +1,81 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "poly/scop.h"
+
+namespace akg {
+using ir::poly::CountAstNodes;
+using ir::poly::FitAstNodeBudget;
+using ir::poly::ScopInfo;
+
+/*
+ * for (i, 0, 64)   // unrolled
+ *   S_0(i)
+ *
+ * The unrolled loop copies the statement 64 times, the atomic one has a single copy.
+ */
+class AstNodeBudgetTest : public testing::Test {
+ public:
+  AstNodeBudgetTest() : test_ctx_(isl_ctx_alloc()) {}
+  ~AstNodeBudgetTest() override { isl_ctx_free(test_ctx_); }
+
+  // the number of ast nodes of the unrolled loop under the given budget
+  size_t FitUnrolledLoop(int budget, bool tensor_core) {
+    isl::ctx ctx(test_ctx_);
+    isl::schedule sch(ctx, "{ domain: \"{ S_0[i] : 0 <= i < 64 }\", child: { schedule: \"[{ S_0[i] -> [(i)] }]\" } }");
+    sch = sch.get_root().child(0).as<isl::schedule_node_band>().member_set_ast_loop_unroll(0).schedule();
+    ScopInfo scop_info(ctx);
+    scop_info.user_config_.SetTarget("cuda");
+    scop_info.user_config_.SetAstNodeBudget(budget);
+    scop_info.user_config_.SetEnableMatmul(tensor_core);
+    scop_info.user_config_.SetEnableTensorCore(tensor_core);
+    auto builder = isl::ast_build(ctx);
+    auto build_ast = [&builder](const isl::schedule &schedule) -> isl::ast_node { return builder.node_from(schedule); };
+    auto ast_node = build_ast(sch);
+    unrolled_nodes_ = CountAstNodes(ast_node);
+    return CountAstNodes(FitAstNodeBudget(scop_info, sch, ast_node, build_ast));
+  }
+
+ protected:
+  size_t unrolled_nodes_{0};
+
+ private:
+  isl_ctx *test_ctx_;
+};
+
+TEST_F(AstNodeBudgetTest, DegradeUnrolledBand) {
+  size_t num_nodes = FitUnrolledLoop(16, false);
+  EXPECT_GT(unrolled_nodes_, 64u);
+  EXPECT_LE(num_nodes, 16u);
+}
+
+TEST_F(AstNodeBudgetTest, WithinBudget) {
+  size_t num_nodes = FitUnrolledLoop(1000, false);
+  EXPECT_EQ(num_nodes, unrolled_nodes_);
+}
+
+TEST_F(AstNodeBudgetTest, NoBudget) {
+  size_t num_nodes = FitUnrolledLoop(0, false);
+  EXPECT_EQ(num_nodes, unrolled_nodes_);
+}
+
+TEST_F(AstNodeBudgetTest, TensorCoreExempt) {
+  // the tensor core emitter matches the loops of the warp tiles, which stay as scheduled
+  size_t num_nodes = FitUnrolledLoop(16, true);
+  EXPECT_EQ(num_nodes, unrolled_nodes_);
+}
+}  // namespace akg
@@ -0,0 +1,59 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include "gtest/gtest.h"
+#include "poly/schedule_pass/computed_schedule_cache.h"
+
+namespace akg {
+using ir::poly::ComputedScheduleCache;
+using ir::poly::ComputedScheduleCacheScope;
+
+constexpr size_t kMaxSchedules = 16;
+
+TEST(TestComputedScheduleCache, ScopeOfPrefix) {
+  EXPECT_EQ(ComputedScheduleCache::Current(), nullptr);
+  ComputedScheduleCache outer;
+  ComputedScheduleCache inner;
+  {
+    ComputedScheduleCacheScope outer_scope(&outer);
+    EXPECT_EQ(ComputedScheduleCache::Current(), &outer);
+    {
+      ComputedScheduleCacheScope inner_scope(&inner);
+      EXPECT_EQ(ComputedScheduleCache::Current(), &inner);
+    }
+    EXPECT_EQ(ComputedScheduleCache::Current(), &outer);
+  }
+  // no schedule outlives the prefix that computed it
+  EXPECT_EQ(ComputedScheduleCache::Current(), nullptr);
+}
+
+TEST(TestComputedScheduleCache, FindAndEvict) {
+  ComputedScheduleCache cache;
+  std::string sch;
+  EXPECT_FALSE(cache.Find("key_0", &sch));
+  for (size_t i = 0; i <= kMaxSchedules; ++i) {
+    cache.Insert("key_" + std::to_string(i), "sch_" + std::to_string(i));
+  }
+  EXPECT_EQ(cache.Size(), kMaxSchedules);
+  // the oldest schedule is evicted first
+  EXPECT_FALSE(cache.Find("key_0", &sch));
+  ASSERT_TRUE(cache.Find("key_1", &sch));
+  EXPECT_EQ(sch, "sch_1");
+  ASSERT_TRUE(cache.Find("key_16", &sch));
+  EXPECT_EQ(sch, "sch_16");
+}
+}  // namespace akg
@@ -0,0 +1,68 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "poly/dma_inject.h"
+
+namespace akg {
+using ir::poly::TensorFootprintClusterCache;
+
+TEST(TestFootprintClusterCache, HitOnSameAccesses) {
+  auto test_ctx = isl_ctx_alloc();
+  {
+    isl::ctx ctx(test_ctx);
+    isl::union_map outer_schedule(ctx, "{ S_0[i] -> [floor(i / 16)] : 0 <= i < 64 }");
+    isl::union_map other_schedule(ctx, "{ S_0[i] -> [floor(i / 32)] : 0 <= i < 64 }");
+    isl::union_map reads(ctx, "{ [S_0[i] -> __poly_ref_1[]] -> A[i] : 0 <= i < 64 }");
+    isl::union_map writes(ctx, "{ [S_0[i] -> __poly_ref_0[]] -> B[i] : 0 <= i < 64 }");
+    isl::union_map copyin = reads;
+    isl::union_map fake_copyin(ctx, "{ }");
+    isl::id tensor_a(ctx, "A");
+
+    TensorFootprintClusterCache cache;
+    auto cluster = cache.HoistBufferFootprintCluster(outer_schedule, tensor_a, reads, copyin, writes, fake_copyin);
+    ASSERT_NE(cluster, nullptr);
+    EXPECT_EQ(cache.Misses(), 1u);
+    EXPECT_EQ(cache.Hits(), 0u);
+
+    // a later promotion of the same tensor under the same prefix reuses the cluster
+    auto cached = cache.HoistBufferFootprintCluster(outer_schedule, tensor_a, reads, copyin, writes, fake_copyin);
+    EXPECT_EQ(cached, cluster);
+    EXPECT_EQ(cache.Hits(), 1u);
+    EXPECT_EQ(cache.Size(), 1u);
+
+    // another promotion depth is another footprint
+    auto other = cache.HoistBufferFootprintCluster(other_schedule, tensor_a, reads, copyin, writes, fake_copyin);
+    ASSERT_NE(other, nullptr);
+    EXPECT_NE(other, cluster);
+    EXPECT_EQ(cache.Misses(), 2u);
+
+    // a tensor that is not accessed is cached as nullptr
+    isl::id tensor_c(ctx, "C");
+    EXPECT_EQ(cache.HoistBufferFootprintCluster(outer_schedule, tensor_c, reads, copyin, writes, fake_copyin), nullptr);
+    EXPECT_EQ(cache.HoistBufferFootprintCluster(outer_schedule, tensor_c, reads, copyin, writes, fake_copyin), nullptr);
+    EXPECT_EQ(cache.Hits(), 2u);
+    EXPECT_EQ(cache.Size(), 3u);
+
+    cache.Clear();
+    EXPECT_EQ(cache.Size(), 0u);
+    EXPECT_EQ(cache.Hits(), 0u);
+    cache.HoistBufferFootprintCluster(outer_schedule, tensor_a, reads, copyin, writes, fake_copyin);
+    EXPECT_EQ(cache.Misses(), 1u);
+  }
+  isl_ctx_free(test_ctx);
+}
+}  // namespace akg
@@ -0,0 +1,54 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "poly/tiling/tiling_utils.h"
+
+namespace akg {
+
+// the default target is v100: 80 sm, 32 blocks, 2048 threads, 64K registers and 96KB shared memory per sm
+TEST(TestOccupancyCalculator, TestCaseFullOccupancy) {
+  ir::poly::OccupancyCalculator calculator;
+  auto info = calculator.Estimate(256, 32, 0);
+  EXPECT_EQ(info.resident_blocks, 8);
+  EXPECT_EQ(info.active_warps, 64);
+  EXPECT_DOUBLE_EQ(info.occupancy, 1.0);
+}
+
+TEST(TestOccupancyCalculator, TestCaseRegisterLimited) {
+  ir::poly::OccupancyCalculator calculator;
+  auto info = calculator.Estimate(256, 128, 0);
+  EXPECT_EQ(info.resident_blocks, 2);
+  EXPECT_EQ(info.limiter, "registers");
+  EXPECT_DOUBLE_EQ(info.occupancy, 0.25);
+}
+
+TEST(TestOccupancyCalculator, TestCaseSharedMemoryLimited) {
+  ir::poly::OccupancyCalculator calculator;
+  auto info = calculator.Estimate(128, 32, 48 * 1024);
+  EXPECT_EQ(info.resident_blocks, 2);
+  EXPECT_EQ(info.limiter, "shared memory");
+  EXPECT_DOUBLE_EQ(info.occupancy, 0.125);
+}
+
+TEST(TestOccupancyCalculator, TestCaseRegsPerThread) {
+  EXPECT_EQ(ir::poly::OccupancyCalculator::EstimateRegsPerThread(0),
+            ir::poly::OccupancyCalculator::BASE_REGS_PER_THREAD);
+  EXPECT_EQ(ir::poly::OccupancyCalculator::EstimateRegsPerThread(1024),
+            ir::poly::OccupancyCalculator::MAX_REGS_PER_THREAD);
+}
+
+}  // namespace akg
@@ -0,0 +1,92 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "poly/schedule_pass_gpu/mapping_outer_band.h"
+#include "poly/scop_info.h"
+#include "poly/pass_info.h"
+
+namespace akg {
+using ir::poly::MappingOuterBand;
+using ir::poly::PassInfo;
+using ir::poly::ScopInfo;
+using ir::poly::SyncCandidate;
+using ir::poly::SyncLevel;
+
+/*
+ * for (i, 0, 64)      // threadIdx.x, warps of 32 threads
+ *   S_0: A[i] = ...
+ * for (i, 0, 64)
+ *   S_1: B[i] = A[f(i)]
+ *
+ * Every instance of S_0 is ordered before every instance of S_1, as the dependences forced between liveouts
+ * do. Only the ones where S_1 reads what S_0 writes need a sync.
+ */
+class ThreadSyncLevelTest : public testing::Test {
+ public:
+  ThreadSyncLevelTest() : test_ctx_(isl_ctx_alloc()) {}
+  ~ThreadSyncLevelTest() override { isl_ctx_free(test_ctx_); }
+
+  // the level of the sync from S_0 to S_1 when S_1 reads A[index]
+  SyncLevel LevelOfRead(const std::string &index) {
+    isl::ctx ctx(test_ctx_);
+    isl::schedule sch(ctx,
+                      "{ domain: \"{ S_0[i] : 0 <= i < 64; S_1[i] : 0 <= i < 64 }\", child: { sequence: ["
+                      "{ filter: \"{ S_0[i] }\", child: { schedule: \"[{ S_0[i] -> [(i)] }]\" } }, "
+                      "{ filter: \"{ S_1[i] }\", child: { schedule: \"[{ S_1[i] -> [(i)] }]\" } }] } }");
+    ScopInfo scop_info(ctx);
+    scop_info.analysis_result_.RecordWrites(isl::union_map(
+      ctx, "{ [S_0[i] -> __poly_ref_0[]] -> A[i] : 0 <= i < 64; [S_1[i] -> __poly_ref_2[]] -> B[i] : 0 <= i < 64 }"));
+    scop_info.analysis_result_.RecordReads(
+      isl::union_map(ctx, "{ [S_1[i] -> __poly_ref_1[]] -> A[" + index + "] : 0 <= i < 64 }"));
+    scop_info.analysis_result_.RecordContextParams(isl::set(ctx, "{ : }"));
+    PassInfo pass_info;
+    pass_info.dependences_ = isl::union_map(ctx, "{ S_0[i] -> S_1[j] : 0 <= i < 64 and 0 <= j < 64 }");
+
+    isl::multi_union_pw_aff domain_to_thread(ctx, "[{ S_0[i] -> [(i)]; S_1[i] -> [(i)] }]");
+    isl::multi_union_pw_aff domain_to_warp(ctx, "[{ S_0[i] -> [(floor((i)/32))]; S_1[i] -> [(floor((i)/32))] }]");
+    auto seq_node = sch.get_root().child(0);
+    SyncCandidate *head = MappingOuterBand(pass_info, scop_info).InitSyncLinkedList(seq_node, domain_to_thread,
+                                                                                     domain_to_warp);
+    SyncLevel level = SyncLevel::BLOCK;
+    for (const auto &s : head->sync) {
+      if (s.first->idx == 1) {
+        level = s.second.level;
+      }
+    }
+    // the candidates form a ring, which is freed from the cut after the head
+    auto next = head->next.release();
+    delete next;
+    return level;
+  }
+
+ private:
+  isl_ctx *test_ctx_;
+};
+
+TEST_F(ThreadSyncLevelTest, SameThreadNeedsNoSync) {
+  // the forced dependences alone would ask for a block sync
+  EXPECT_EQ(LevelOfRead("i"), SyncLevel::EMPTY);
+}
+
+TEST_F(ThreadSyncLevelTest, SameWarpNeedsWarpSync) {
+  EXPECT_EQ(LevelOfRead("2 * floor(i / 2)"), SyncLevel::WARP);
+}
+
+TEST_F(ThreadSyncLevelTest, OtherWarpNeedsBlockSync) {
+  EXPECT_EQ(LevelOfRead("63 - i"), SyncLevel::BLOCK);
+}
+}  // namespace akg
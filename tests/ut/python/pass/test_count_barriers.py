@@ -0,0 +1,69 @@
+# Copyright 2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import akg.tvm
+
+
+def sync(ib, scope):
+    ib.emit(akg.tvm.call_intrin("int32", "tvm_storage_sync", scope))
+
+
+def build():
+    '''
+     A_shared[tx] = A[tx]
+     sync shared
+     for (i, 0, 4)
+       B_local[i] = A_shared[(tx + i) % 128]
+       sync warp
+     B[tx] = B_local[0]
+    '''
+    ib = akg.tvm.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    B = ib.pointer("float32", name="B")
+    tx = akg.tvm.thread_axis("threadIdx.x")
+    ib.scope_attr(tx, "thread_extent", 128)
+    a_shared = ib.allocate("float32", 128, name="A_shared", scope="shared")
+    b_local = ib.allocate("float32", 4, name="B_local", scope="local")
+    a_shared[tx.var] = A[tx.var]
+    sync(ib, "shared")
+    with ib.for_range(0, 4, name="i") as i:
+        b_local[i] = a_shared[(tx.var + i) % 128]
+        sync(ib, "warp")
+    B[tx.var] = b_local[0]
+    return ib.get()
+
+
+def test_count_by_scope():
+    '''Barriers are counted where they are in the IR, a warp barrier in a loop is counted once.'''
+    counts = akg.tvm.ir_pass.CountBarriers(build())
+    assert counts["shared"].value == 1, counts
+    assert counts["warp"].value == 1, counts
+    assert counts["global"].value == 0, counts
+
+
+def test_no_barrier():
+    '''A kernel without barriers reports zero for every scope, so the counts of two kernels can be compared.'''
+    ib = akg.tvm.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    tx = akg.tvm.thread_axis("threadIdx.x")
+    ib.scope_attr(tx, "thread_extent", 32)
+    A[tx.var] = A[tx.var] + 1.0
+    counts = akg.tvm.ir_pass.CountBarriers(ib.get())
+    assert sorted(k for k, _ in counts.items()) == ["global", "shared", "warp"], counts
+    assert all(v.value == 0 for _, v in counts.items()), counts
+
+
+if __name__ == "__main__":
+    test_count_by_scope()
+    test_no_barrier()
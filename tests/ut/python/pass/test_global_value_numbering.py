@@ -0,0 +1,94 @@
+# Copyright 2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import akg.tvm
+
+
+def collect(stmt, node_type):
+    nodes = []
+
+    def visit(n):
+        if isinstance(n, node_type):
+            nodes.append(n)
+
+    akg.tvm.ir_pass.PostOrderVisit(stmt, visit)
+    return nodes
+
+
+def has_load(expr):
+    return len(collect(expr, akg.tvm.expr.Load)) > 0
+
+
+def test_gvn_across_store():
+    '''
+     for (i, 0, 8)
+       B[tx * 8 + i * 2 + 1] = A[tx * 8 + i * 2 + 1] + 1
+
+     ==>
+
+     let gvn_1 = tx * 8
+     for (i, 0, 8)
+       let gvn_0 = gvn_1 + i * 2 + 1
+       B[gvn_0] = A[gvn_0] + 1
+    '''
+    ib = akg.tvm.ir_builder.create()
+    A = ib.pointer("int32", name="A")
+    B = ib.pointer("int32", name="B")
+    tx = akg.tvm.thread_axis("threadIdx.x")
+    ib.scope_attr(tx, "thread_extent", 32)
+    with ib.for_range(0, 8, name="i") as i:
+        idx = tx.var * 8 + i * 2 + 1
+        B[idx] = A[idx] + 1
+    stmt = akg.tvm.ir_pass.GlobalValueNumbering(ib.get())
+
+    lets = collect(stmt, akg.tvm.stmt.LetStmt)
+    assert len(lets) == 2, "expect the index and its loop invariant part bound, got:\n%s" % stmt
+    store = collect(stmt, akg.tvm.stmt.Store)[0]
+    load = collect(stmt, akg.tvm.expr.Load)[0]
+    assert isinstance(store.index, akg.tvm.expr.Var)
+    assert isinstance(load.index, akg.tvm.expr.Var)
+    assert store.index.same_as(load.index), "the store and the load should share one index:\n%s" % stmt
+    loop = collect(stmt, akg.tvm.stmt.For)[0]
+    outer_lets = [l for l in lets if not any(l.same_as(x) for x in collect(loop, akg.tvm.stmt.LetStmt))]
+    assert len(outer_lets) == 1, "tx * 8 should be hoisted out of the loop:\n%s" % stmt
+
+
+def test_gvn_keep_load():
+    '''
+     B[tx * 8 + i] = A[tx] * 3 + 1
+     B[tx * 8 + i + 256] = A[tx] * 3 + 1
+
+     A[tx] * 3 + 1 reads memory, which may be written in between, so it is never numbered.
+    '''
+    ib = akg.tvm.ir_builder.create()
+    A = ib.pointer("int32", name="A")
+    B = ib.pointer("int32", name="B")
+    n = akg.tvm.var("n")
+    tx = akg.tvm.thread_axis("threadIdx.x")
+    ib.scope_attr(tx, "thread_extent", 32)
+    with ib.for_range(0, 8, name="i") as i:
+        B[tx.var * 8 + i] = A[tx.var] * 3 + 1
+        B[tx.var * 8 + i + 256] = A[tx.var] * 3 + 1
+        B[i * 2 + tx.var // n] = 0
+    stmt = akg.tvm.ir_pass.GlobalValueNumbering(ib.get())
+
+    for let in collect(stmt, akg.tvm.stmt.LetStmt):
+        assert not has_load(let.value), "a load is bound by %s" % let.var
+        assert not collect(let.value, akg.tvm.expr.FloorDiv), "a division by n is bound by %s" % let.var
+    assert len(collect(stmt, akg.tvm.expr.Load)) == 2, "the loads should stay in place:\n%s" % stmt
+
+
+if __name__ == "__main__":
+    test_gvn_across_store()
+    test_gvn_keep_load()
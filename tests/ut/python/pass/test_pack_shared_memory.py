@@ -0,0 +1,103 @@
+# Copyright 2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import akg.tvm
+
+
+def collect(stmt, node_type):
+    nodes = []
+
+    def visit(n):
+        if isinstance(n, node_type):
+            nodes.append(n)
+
+    akg.tvm.ir_pass.PostOrderVisit(stmt, visit)
+    return nodes
+
+
+def build(n, live_together):
+    '''
+     A_shared[i] = A[i]
+     C[i] = A_shared[i]
+     B_shared[i] = B[i]
+     C[i] = C[i] + B_shared[i]
+
+     When live_together is set, A_shared is read again at the end.
+    '''
+    ib = akg.tvm.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    B = ib.pointer("float32", name="B")
+    C = ib.pointer("float32", name="C")
+    bx = akg.tvm.thread_axis("blockIdx.x")
+    ib.scope_attr(bx, "thread_extent", 1)
+    a_shared = ib.allocate("float32", n, name="A_shared", scope="shared")
+    b_shared = ib.allocate("float32", n, name="B_shared", scope="shared")
+    with ib.for_range(0, n, name="i") as i:
+        a_shared[i] = A[i]
+    with ib.for_range(0, n, name="i") as i:
+        C[i] = a_shared[i]
+    with ib.for_range(0, n, name="i") as i:
+        b_shared[i] = B[i]
+    with ib.for_range(0, n, name="i") as i:
+        C[i] = C[i] + b_shared[i]
+    if live_together:
+        with ib.for_range(0, n, name="i") as i:
+            C[i] = C[i] + a_shared[i]
+    return ib.get()
+
+
+def is_shared_sync(stmt):
+    return isinstance(stmt, akg.tvm.stmt.Evaluate) and isinstance(stmt.value, akg.tvm.expr.Call) and \
+        stmt.value.name == "tvm_storage_sync"
+
+
+def test_disjoint_buffers():
+    '''A_shared is dead before B_shared is written, so both take the same bytes of the arena.'''
+    stmt = akg.tvm.ir_pass.PackSharedMemory(build(1024, False))
+    allocs = collect(stmt, akg.tvm.stmt.Allocate)
+    assert len(allocs) == 1 and allocs[0].buffer_var.name == "shared_arena", "expect one arena:\n%s" % stmt
+    arena_bytes = allocs[0].extents[0].value * 16
+    assert arena_bytes == 1024 * 4, "expect an arena of 4096 bytes:\n%s" % stmt
+    syncs = [s for s in collect(stmt, akg.tvm.stmt.Evaluate) if is_shared_sync(s)]
+    assert len(syncs) == 1, "expect a barrier before B_shared reuses the bytes of A_shared:\n%s" % stmt
+
+
+def test_overlapped_buffers():
+    '''A_shared is still live when B_shared is written, so nothing is packed.'''
+    stmt = build(1024, True)
+    res = akg.tvm.ir_pass.PackSharedMemory(stmt)
+    assert len(collect(res, akg.tvm.stmt.Allocate)) == 2, "the buffers should be kept:\n%s" % res
+
+
+def test_unpacked_over_limit():
+    '''Live buffers of 64KB are not packed, and their kernel is left to the checks of the codegen.'''
+    stmt = build(8192, True)
+    res = akg.tvm.ir_pass.PackSharedMemory(stmt)
+    assert res.same_as(stmt), "a kernel that is not packed is changed:\n%s" % res
+
+
+def test_arena_over_limit():
+    '''A packed arena of 64KB does not fit the shared memory of a block.'''
+    try:
+        akg.tvm.ir_pass.PackSharedMemory(build(16384, False))
+    except akg.tvm.TVMError:
+        return
+    assert False, "expect a check of the shared memory of the kernel"
+
+
+if __name__ == "__main__":
+    test_disjoint_buffers()
+    test_overlapped_buffers()
+    test_unpacked_over_limit()
+    test_arena_over_limit()
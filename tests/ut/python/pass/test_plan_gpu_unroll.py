@@ -0,0 +1,133 @@
+# Copyright 2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import akg.tvm
+
+
+def collect(stmt, node_type):
+    nodes = []
+
+    def visit(n):
+        if isinstance(n, node_type):
+            nodes.append(n)
+
+    akg.tvm.ir_pass.PostOrderVisit(stmt, visit)
+    return nodes
+
+
+def build(extent=16):
+    '''
+     for (i, 0, extent)
+       C[tx * extent + i] = A[tx * extent + i] * B[tx * extent + i] + C[tx * extent + i]
+    '''
+    ib = akg.tvm.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    B = ib.pointer("float32", name="B")
+    C = ib.pointer("float32", name="C")
+    tx = akg.tvm.thread_axis("threadIdx.x")
+    ib.scope_attr(tx, "thread_extent", 128)
+    with ib.for_range(0, extent, name="i") as i:
+        idx = tx.var * extent + i
+        C[idx] = A[idx] * B[idx] + C[idx]
+    return ib.get()
+
+
+def build_local(extent):
+    '''
+     for (i, 0, extent)
+       acc_local[i] = A[tx * extent + i] * B[tx * extent + i]
+    '''
+    ib = akg.tvm.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    B = ib.pointer("float32", name="B")
+    tx = akg.tvm.thread_axis("threadIdx.x")
+    ib.scope_attr(tx, "thread_extent", 128)
+    acc = ib.allocate("float32", extent, name="acc_local", scope="local")
+    with ib.for_range(0, extent, name="i") as i:
+        idx = tx.var * extent + i
+        acc[i] = A[idx] * B[idx]
+    return ib.get()
+
+
+def build_nest(extent):
+    '''
+     for (j, 0, 2)
+       for (i, 0, extent)
+         C[(tx * 2 + j) * extent + i] = A[(tx * 2 + j) * extent + i] * B[(tx * 2 + j) * extent + i]
+    '''
+    ib = akg.tvm.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    B = ib.pointer("float32", name="B")
+    C = ib.pointer("float32", name="C")
+    tx = akg.tvm.thread_axis("threadIdx.x")
+    ib.scope_attr(tx, "thread_extent", 128)
+    with ib.for_range(0, 2, name="j") as j:
+        with ib.for_range(0, extent, name="i") as i:
+            idx = (tx.var * 2 + j) * extent + i
+            C[idx] = A[idx] * B[idx]
+    return ib.get()
+
+
+def unroll_pragmas(stmt):
+    return [a for a in collect(stmt, akg.tvm.stmt.AttrStmt) if a.attr_key == "pragma_unroll"]
+
+
+def test_full_unroll():
+    '''A loop whose copies fit the register cap is unrolled fully.'''
+    res = akg.tvm.ir_pass.PlanGpuUnroll(build(), 255)
+    pragmas = unroll_pragmas(res)
+    assert len(pragmas) == 1 and pragmas[0].value.value == 16, "expect a full unroll:\n%s" % res
+
+
+def test_over_register_cap():
+    '''A loop that fits no factor is left to the compiler instead of being kept rolled.'''
+    stmt = build()
+    res = akg.tvm.ir_pass.PlanGpuUnroll(stmt, 17)
+    assert not unroll_pragmas(res), "the loop should be left unannotated:\n%s" % res
+    loops = collect(res, akg.tvm.stmt.For)
+    assert len(loops) == 1 and loops[0].for_type == collect(stmt, akg.tvm.stmt.For)[0].for_type, res
+
+
+def test_partial_unroll():
+    '''A loop too long to copy fully is unrolled by a factor that divides it.'''
+    res = akg.tvm.ir_pass.PlanGpuUnroll(build(128), 255)
+    pragmas = unroll_pragmas(res)
+    assert len(pragmas) == 1 and pragmas[0].value.value == 8, "expect a partial unroll by 8:\n%s" % res
+    assert collect(res, akg.tvm.stmt.For)[0].for_type == akg.tvm.stmt.For.Serial, res
+
+
+def test_local_index_no_partial_unroll():
+    '''A local buffer indexed by the loop var stays in registers only when the loop is unrolled fully.'''
+    res = akg.tvm.ir_pass.PlanGpuUnroll(build_local(128), 255)
+    assert not unroll_pragmas(res), "a partial unroll would spill the local buffer:\n%s" % res
+    res = akg.tvm.ir_pass.PlanGpuUnroll(build_local(16), 255)
+    pragmas = unroll_pragmas(res)
+    assert len(pragmas) == 1 and pragmas[0].value.value == 16, "expect a full unroll:\n%s" % res
+
+
+def test_partial_unroll_keeps_outer_loop():
+    '''UnrollLoop counts a partially unrolled loop as rolled, so its enclosing loop is not unrolled.'''
+    res = akg.tvm.ir_pass.PlanGpuUnroll(build_nest(128), 255)
+    assert len(unroll_pragmas(res)) == 1, res
+    res = akg.tvm.ir_pass.UnrollLoop(res, 64, 8, 0, False)
+    loops = collect(res, akg.tvm.stmt.For)
+    assert len(loops) == 2 and all(l.for_type == akg.tvm.stmt.For.Serial for l in loops), res
+
+
+if __name__ == "__main__":
+    test_full_unroll()
+    test_over_register_cap()
+    test_partial_unroll()
+    test_local_index_no_partial_unroll()
+    test_partial_unroll_keeps_outer_loop()
@@ -0,0 +1,77 @@
+# Copyright 2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import akg
+import akg.tvm
+
+
+def forward(shape):
+    '''y = exp(x) * exp(x) + sigmoid(exp(x)), exp(x) being read by the gradient several times'''
+    x = akg.tvm.placeholder(shape, "float32", name="x")
+    t = akg.tvm.compute(shape, lambda *i: akg.tvm.exp(x(*i)), name="t")
+    y = akg.tvm.compute(shape, lambda *i: t(*i) * t(*i) + akg.tvm.sigmoid(t(*i)), name="y")
+    return x, y
+
+
+def plan(budget, tensor_optimize=0):
+    x, y = forward((64, 64))
+    ad_attrs = {"remat_memory_budget": budget, "tensor_optimize": tensor_optimize}
+    res = akg.differentiate(y, [x], ad_attrs=ad_attrs)
+    for key in ["remat_kept", "remat_recomputed", "remat_kept_bytes", "remat_keep_all_bytes", "remat_recompute_cost"]:
+        assert key in res.attrs, "no %s in the plan" % key
+    return res
+
+
+def ops_of(tensors):
+    ops = []
+
+    def visit(t):
+        if any(t.op.same_as(op) for op in ops):
+            return
+        ops.append(t.op)
+        for inp in t.op.input_tensors:
+            visit(inp)
+
+    for t in tensors:
+        visit(t)
+    return ops
+
+
+def test_budget_over_int32():
+    '''A budget above 2^31 bytes keeps every intermediate.'''
+    res = plan(1 << 40)
+    assert len(res.attrs["remat_recomputed"]) == 0
+    assert res.attrs["remat_kept_bytes"].value == res.attrs["remat_keep_all_bytes"].value
+    assert res.attrs["remat_recompute_cost"].value == 0
+
+
+def test_tiny_budget():
+    '''A budget of one byte recomputes every intermediate that can be recomputed.'''
+    res = plan(1)
+    assert len(res.attrs["remat_kept"]) == 0
+    assert res.attrs["remat_kept_bytes"].value <= res.attrs["remat_keep_all_bytes"].value
+
+
+def test_isolated_tensors_are_planned():
+    '''The copies isolated by tensor_optimize are dropped when the budget recomputes their tensors.'''
+    res = plan(1, tensor_optimize=1)
+    assert len(res.attrs["remat_kept"]) == 0
+    isolated = [op.name for op in ops_of(res.result) if op.name.endswith("_no_inline")]
+    assert not isolated, "isolated copies are left: %s" % isolated
+
+
+if __name__ == "__main__":
+    test_budget_over_int32()
+    test_tiny_budget()
+    test_isolated_tensors_are_planned()
@@ -0,0 +1,85 @@
+# Copyright 2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import json
+import akg.tvm
+
+
+def tensor(name, shape):
+    return {"data_type": "float32", "format": "DefaultFormat", "shape": shape, "tensor_name": name}
+
+
+def composite_json(shape):
+    '''output_0 = input_0 + input_1'''
+    op = {
+        "attr": None,
+        "impl_path": "",
+        "input_desc": [[dict(tensor("input_0", shape), name="input_0")],
+                       [dict(tensor("input_1", shape), name="input_1")]],
+        "name": "Add",
+        "output_desc": [dict(tensor("output_0", shape), name="output")],
+    }
+    desc = {
+        "composite": True,
+        "composite_graph": "1",
+        "id": 1,
+        "input_desc": [[tensor("input_0", shape)], [tensor("input_1", shape)]],
+        "op": "Fused_Add_shape_bucket",
+        "op_desc": [op],
+        "output_desc": [tensor("output_0", shape)],
+        "platform": "AKG",
+        "process": "cuda",
+    }
+    return json.dumps(desc)
+
+
+def test_lower_buckets():
+    '''Every bucket is lowered on its own, under the name of its upper bound.'''
+    lower_buckets = akg.tvm.get_global_func("composite_lower_buckets")
+    res = lower_buckets(composite_json([8, "seq_len", 1024]), {"shape_buckets": [512, 128, 512]})
+    names = sorted(res.keys())
+    assert names == ["Fused_Add_shape_bucket_b128", "Fused_Add_shape_bucket_b512"], "unexpected buckets: %s" % names
+    for name in names:
+        assert res[name] is not None, "%s is not lowered" % name
+
+
+def test_static_shape():
+    '''A graph without a named dim has nothing to bucket.'''
+    lower_buckets = akg.tvm.get_global_func("composite_lower_buckets")
+    try:
+        lower_buckets(composite_json([8, 128, 1024]), {"shape_buckets": [128]})
+    except akg.tvm.TVMError:
+        return
+    assert False, "expect a check of the named dim"
+
+
+def test_select_bucket():
+    '''An extent takes the smallest bucket whose upper bound holds it.'''
+    select = akg.tvm.get_global_func("select_shape_bucket")
+    bounds = [128, 512]
+    assert select(bounds, 1) == 0
+    assert select(bounds, 128) == 0
+    assert select(bounds, 129) == 1
+    assert select(bounds, 512) == 1
+    try:
+        select(bounds, 513)
+    except akg.tvm.TVMError:
+        return
+    assert False, "expect a check of the largest bucket"
+
+
+if __name__ == "__main__":
+    test_lower_buckets()
+    test_static_shape()
+    test_select_bucket()
@@ -0,0 +1,82 @@
+# Copyright 2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import akg.tvm
+
+
+def collect(stmt, node_type):
+    nodes = []
+
+    def visit(n):
+        if isinstance(n, node_type):
+            nodes.append(n)
+
+    akg.tvm.ir_pass.PostOrderVisit(stmt, visit)
+    return nodes
+
+
+def build(for_type="serial"):
+    '''
+     // attr [blockIdx.x] thread_extent = 4
+     for (k, 0, 8)
+       mma_sync(...)
+     for (i, 0, 256)
+       C[blockIdx.x * 256 + i] = C_shared[i]
+    '''
+    c = akg.tvm.placeholder((4, 256), "float32", name="C")
+    c_buf = akg.tvm.decl_buffer(c.shape, c.dtype, name="C")
+    ib = akg.tvm.ir_builder.create()
+    C = ib.buffer_ptr(c_buf)
+    bx = akg.tvm.thread_axis("blockIdx.x")
+    ib.scope_attr(bx, "thread_extent", 4)
+    c_shared = ib.allocate("float32", 256, name="C_shared", scope="shared")
+    with ib.for_range(0, 8, name="k"):
+        ib.emit(akg.tvm.call_intrin("handle", "tvm_mma_sync"))
+    with ib.for_range(0, 256, name="i", for_type=for_type) as i:
+        C[bx.var * 256 + i] = c_shared[i]
+    return ib.get(), {c: c_buf}
+
+
+def thread_tags(stmt):
+    return [a.node.thread_tag for a in collect(stmt, akg.tvm.stmt.AttrStmt) if a.attr_key == "thread_extent"]
+
+
+def test_split():
+    '''C is zeroed by a kernel of its own before the blocks on blockIdx.z add their partial sums.'''
+    stmt, binds = build()
+    res = akg.tvm.ir_pass.SplitKGemm(stmt, binds, 2)
+    assert isinstance(res, akg.tvm.stmt.Block), "expect a clean kernel before the GEMM:\n%s" % res
+    clean = res.first
+    assert isinstance(clean, akg.tvm.stmt.AttrStmt) and "blockIdx.z" not in thread_tags(clean), \
+        "the clean kernel should run before the GEMM kernel:\n%s" % res
+    zeros = [s for s in collect(clean, akg.tvm.stmt.Store) if s.buffer_var.name == "C"]
+    assert len(zeros) == 1 and zeros[0].value.value == 0, "expect C to be zeroed:\n%s" % res
+    assert "blockIdx.z" in thread_tags(res.rest), "expect K to be split on blockIdx.z:\n%s" % res
+    adds = [c for c in collect(res.rest, akg.tvm.expr.Call) if c.name == "atomicAdd"]
+    assert len(adds) == 1, "expect the stores of C to be atomic:\n%s" % res
+    k_loops = [f for f in collect(res.rest, akg.tvm.stmt.For) if f.loop_var.name.startswith("k")]
+    assert len(k_loops) == 1 and k_loops[0].extent.value == 4, "expect 4 K steps per block:\n%s" % res
+
+
+def test_vectorized_store():
+    '''atomicAdd has no vector form, so a vectorized store of C keeps the kernel unsplit.'''
+    stmt, binds = build("vectorize")
+    res = akg.tvm.ir_pass.SplitKGemm(stmt, binds, 2)
+    assert "blockIdx.z" not in thread_tags(res), "a vectorized store of C is split:\n%s" % res
+    assert not [c for c in collect(res, akg.tvm.expr.Call) if c.name == "atomicAdd"], res
+
+
+if __name__ == "__main__":
+    test_split()
+    test_vectorized_store()
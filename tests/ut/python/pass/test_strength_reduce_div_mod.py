@@ -0,0 +1,107 @@
+# Copyright 2021 Huawei Technologies Co., Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import akg.tvm
+
+
+def collect(stmt, node_type):
+    nodes = []
+
+    def visit(n):
+        if isinstance(n, node_type):
+            nodes.append(n)
+
+    akg.tvm.ir_pass.PostOrderVisit(stmt, visit)
+    return nodes
+
+
+def uses_var(expr, var):
+    return any(v.same_as(var) for v in collect(expr, akg.tvm.expr.Var))
+
+
+def divisions_of(stmt, var):
+    divs = collect(stmt, akg.tvm.expr.FloorDiv) + collect(stmt, akg.tvm.expr.FloorMod)
+    return [d for d in divs if uses_var(d.a, var)]
+
+
+def build(divisor):
+    ib = akg.tvm.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    B = ib.pointer("float32", name="B")
+    tx = akg.tvm.thread_axis("threadIdx.x")
+    ib.scope_attr(tx, "thread_extent", 32)
+    with ib.for_range(0, 16, name="i") as i:
+        idx = tx.var * 4 + i * 3
+        B[tx.var * 16 + i] = A[idx // divisor] + A[idx % divisor]
+    return ib.get(), i
+
+
+def test_const_divisor():
+    '''
+     for (i, 0, 16)
+       B[tx * 16 + i] = A[(tx * 4 + i * 3) / 7] + A[(tx * 4 + i * 3) % 7]
+
+     ==>
+
+     quo = (tx * 4) / 7, rem = (tx * 4) % 7
+     for (i, 0, 16)
+       B[tx * 16 + i] = A[quo] + A[rem]
+       quo = quo + (rem + 3 >= 7 ? 1 : 0)
+       rem = rem + 3 >= 7 ? rem + 3 - 7 : rem + 3
+    '''
+    stmt, i = build(7)
+    stmt = akg.tvm.ir_pass.StrengthReduceDivMod(stmt)
+    loop = collect(stmt, akg.tvm.stmt.For)[0]
+    assert not divisions_of(loop.body, loop.loop_var), "divisions by 7 are left in the loop:\n%s" % stmt
+    assert len(collect(stmt, akg.tvm.stmt.Allocate)) == 2, "expect a quotient and a remainder:\n%s" % stmt
+
+
+def test_runtime_divisor():
+    '''A divisor known at runtime guards the reduced loop with n > 0, the original loop being the fallback.'''
+    n = akg.tvm.var("n")
+    stmt, i = build(n)
+    stmt = akg.tvm.ir_pass.StrengthReduceDivMod(stmt)
+    branches = collect(stmt, akg.tvm.stmt.IfThenElse)
+    assert len(branches) == 1 and branches[0].else_case is not None, "expect a check of n:\n%s" % stmt
+    loop = collect(branches[0].then_case, akg.tvm.stmt.For)[0]
+    assert not divisions_of(loop.body, loop.loop_var), "divisions by n are left in the loop:\n%s" % stmt
+
+
+def test_power_of_two_divisor():
+    '''Divisions by powers of two are left to the shift rewrites.'''
+    stmt, i = build(8)
+    res = akg.tvm.ir_pass.StrengthReduceDivMod(stmt)
+    assert not collect(res, akg.tvm.stmt.Allocate), "a division by 8 is reduced:\n%s" % res
+
+
+def test_unroll_planned_loop():
+    '''A loop planned for unrolling keeps its divisions, which fold once the loop is unrolled.'''
+    A = akg.tvm.var("A", "handle")
+    B = akg.tvm.var("B", "handle")
+    tx = akg.tvm.thread_axis("threadIdx.x")
+    i = akg.tvm.var("i")
+    idx = tx.var * 4 + i * 3
+    value = akg.tvm.make.Load("float32", A, idx // 7) + akg.tvm.make.Load("float32", A, idx % 7)
+    loop = akg.tvm.make.For(i, 0, 16, 0, 0, akg.tvm.make.Store(B, value, tx.var * 16 + i))
+    stmt = akg.tvm.make.AttrStmt(tx, "thread_extent", 32, akg.tvm.make.AttrStmt(i, "pragma_unroll", 4, loop))
+    res = akg.tvm.ir_pass.StrengthReduceDivMod(stmt)
+    assert not collect(res, akg.tvm.stmt.Allocate), "a loop planned for unrolling carries counters:\n%s" % res
+    assert isinstance(collect(res, akg.tvm.stmt.AttrStmt)[0].body, akg.tvm.stmt.For), "the pragma is lost:\n%s" % res
+
+
+if __name__ == "__main__":
+    test_const_divisor()
+    test_runtime_divisor()
+    test_power_of_two_divisor()
+    test_unroll_planned_loop()
@@ -23,6 +23,14 @@ casefiles=(
 "${CURRPATH}/pass/test_promote_if.py"
 "${CURRPATH}/pass/test_sink_if.py"
 "${CURRPATH}/pass/test_copy_propagation.py"
+"${CURRPATH}/pass/test_global_value_numbering.py"
+"${CURRPATH}/pass/test_strength_reduce_div_mod.py"
+"${CURRPATH}/pass/test_pack_shared_memory.py"
+"${CURRPATH}/pass/test_remat_plan.py"
+"${CURRPATH}/pass/test_split_k_gemm.py"
+"${CURRPATH}/pass/test_count_barriers.py"
+"${CURRPATH}/pass/test_plan_gpu_unroll.py"
+"${CURRPATH}/pass/test_shape_bucket.py"
 )
 
 for case in ${casefiles[@]}
@@ -1653,6 +1653,11 @@ constexpr const char* tvm_store_matrix_sync = "tvm_store_matrix_sync";
  *                           fragment_c[index_c], fragment_a[index_a],
  *                           fragment_b[index_b]);
  *  }
+ *
+ *  The third operand may also be a scalar, or the address of a vector
+ *  broadcast over the tile (op_name "add_row_vector", "mul_col_vector", ...).
+ *  Unary epilogues drop it: akg_fragment_elem(fragment_c, index_c,
+ *  fragment_a, index_a, "tanh").
  */
 constexpr const char* akg_fragment_elem = "akg_fragment_elem";
 
@@ -199,8 +199,12 @@ void CodeGenCUDA::VisitStmt_(const ir::For* op) {
   if (op->for_type == ir::ForType::Unrolled) {
     PrintIndent();
     stream << "#pragma unroll\n";
+  } else if (unroll_factor > 0 && op->for_type == ir::ForType::Serial) {
+    PrintIndent();
+    stream << "#pragma unroll " << unroll_factor << "\n";
   }
-  else if (op->for_type == ir::ForType::Swizzled) {
+  unroll_factor = 0;
+  if (op->for_type == ir::ForType::Swizzled) {
     // remove this loop
     PrintStmt(op->body);
     return;
@@ -379,7 +383,11 @@ void CodeGenCUDA::PrintVecElemStore(
 void CodeGenCUDA::PrintStorageSync(const Call* op) {
   const std::string& sync = op->args[0].as<StringImm>()->value;
   if (sync == "warp") {
-    // DO nothing.
+    // warps only run in lock step before Volta
+    this->stream << "#if __CUDA_ARCH__ >= 700\n";
+    this->PrintIndent();
+    this->stream << "__syncwarp();\n";
+    this->stream << "#endif\n";
   } else if (sync == "shared") {
     this->PrintIndent();
     this->stream << "__syncthreads();\n";
@@ -568,7 +576,21 @@ void CodeGenCUDA::VisitExpr_(const Call *op, std::ostream& os) {
         this->PrintExpr(op->args[i * 2 + 1], os);
         os << "]" << ((i < 1) ? ", " : "");
       }
-      os << ", " << op->args[4] << ")";
+      if (op->args[4].type().is_handle()) {
+        // vector broadcast over the fragment, the operand is the address of its first element in the tile
+        os << ", ";
+        this->PrintExpr(op->args[4], os);
+        os << ")";
+      } else {
+        os << ", " << op->args[4] << ")";
+      }
+    } else if (op->args.size() == 5) {
+      for (int i = 0; i < 2; ++i) {
+        this->PrintExpr(op->args[i * 2], os);
+        os << "[";
+        this->PrintExpr(op->args[i * 2 + 1], os);
+        os << "]" << ((i < 1) ? ", " : ")");
+      }
     }
   } else if ((op->call_type == Call::Extern) || (op->call_type == Call::PureExtern)) {
     if (op->name == "&") {
@@ -615,6 +637,40 @@ void CodeGenCUDA::VisitExpr_(const Call *op, std::ostream& os) {
       os << ")";
       return;
     }
+    if (op->name == AKG_DETERMINISTIC_RETURN) {
+      // args: dtype, op type, value, output address, op, element id, part id, number of parts, number of elements
+      CHECK_EQ(op->args.size(), 9U);
+      auto num_parts = op->args[7].as<IntImm>();
+      auto num_elems = op->args[8].as<IntImm>();
+      CHECK(num_parts != nullptr && num_elems != nullptr);
+      Type t = op->args[0].type();
+      // The workspace lives in module scope, before the fp16 definitions, so it is declared as raw bytes.
+      // The arrival counters start at zero when the module is loaded and wrap back to zero on the last block.
+      // Launches of the kernel share both, so they must not overlap, which is why the mode is opt-in.
+      std::string partials = GetUniqueName("akg_red_partials");
+      std::string arrived = GetUniqueName("akg_red_arrived");
+      decl_stream << "__device__ __align__(16) char " << partials << "["
+                  << num_parts->value * num_elems->value * t.bytes() << "];\n";
+      decl_stream << "__device__ unsigned int " << arrived << "[" << num_elems->value << "];\n";
+      os << op->name << "<";
+      this->PrintType(t, os);
+      os << ",";
+      CHECK(op->args[1].as<StringImm>());
+      os << op->args[1].as<StringImm>()->value << ">(";
+      for (size_t i = 2; i < 5; i++) {
+        this->PrintExpr(op->args[i], os);
+        os << ", ";
+      }
+      os << "(";
+      this->PrintType(t, os);
+      os << "*)" << partials << ", " << arrived;
+      for (size_t i = 5; i < 8; i++) {
+        os << ", ";
+        this->PrintExpr(op->args[i], os);
+      }
+      os << ")";
+      return;
+    }
     if (op->name == AKG_KAHAN) {
       CHECK_GE(op->args.size(), 1);
       os << op->name << "<";
@@ -787,6 +843,9 @@ void CodeGenCUDA::VisitStmt_(const AttrStmt* op) {
   } else if (op->attr_key == "no_init_value") {
     // mark next let statement to be a simple, empty declaration
     no_init_value = true;
+  } else if (op->attr_key == "pragma_unroll" && op->body.as<For>()) {
+    // mark next loop to be unrolled by the planned factor
+    unroll_factor = op->value.as<IntImm>()->value;
   }
   CodeGenC::VisitStmt_(op);
 }
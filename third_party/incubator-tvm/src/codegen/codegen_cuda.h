@@ -68,6 +68,7 @@ namespace codegen {
 constexpr auto REDUCE_LIB_TYPE = "reduceLibType";
 constexpr auto AKG_REDUCE = "akg_reduce::AkgReduce";
 constexpr auto AKG_ATOMIC_RETURN = "akg_reduce::AkgAtomicReturn";
+constexpr auto AKG_DETERMINISTIC_RETURN = "akg_reduce::AkgDeterministicReturn";
 constexpr auto AKG_KAHAN = "akg_reduce::AkgKahanAccumulation";
 constexpr auto PARIS_REDUCE = "paris_reduce::ParisReduce";
 constexpr auto PARIS_ATOMIC_RETURN = "paris_reduce::ParisReturn";
@@ -153,6 +154,8 @@ class CodeGenCUDA final : public CodeGenC {
   int current_index;
   // do not set value to next LetStmt if true
   bool no_init_value{false};
+  // unroll factor of next serial loop, 0 if not planned
+  int64_t unroll_factor{0};
   // ignore next allocate stmt if true (trick to bypass some tests)
 //  bool ignore_next_allocate{false};
 
@@ -65,6 +65,24 @@ class LoopUnroller : public IRMutator {
     } else if (op->attr_key == "no_unroll") {
       no_unroll_ = true;
       return IRMutator::Mutate_(op, stmt);
+    } else if (op->attr_key == "pragma_unroll") {
+      const For* loop = op->body.as<For>();
+      int factor = 0;
+      if (loop == nullptr || loop->for_type == ForType::Unrolled ||
+          !arith::GetConstInt(op->value, &factor)) {
+        return IRMutator::Mutate_(op, stmt);
+      }
+      // a partial unroll is already planned: the loop stays rolled for the enclosing loops,
+      // which see its body copied factor times
+      Stmt body = this->Mutate(loop->body);
+      step_count_ *= factor;
+      normal_loop_depth_ += 1;
+      if (body.same_as(loop->body)) {
+        return stmt;
+      }
+      Stmt new_loop = For::make(loop->loop_var, loop->min, loop->extent, loop->for_type,
+                                loop->device_api, body);
+      return AttrStmt::make(op->node, op->attr_key, op->value, new_loop);
     } else if (op->attr_key == "pragma_auto_unroll_max_step") {
       int value = 0;
       CHECK(arith::GetConstInt(op->value, &value));